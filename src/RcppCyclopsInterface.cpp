@@ -121,6 +121,15 @@ void cyclopsSetWeights(SEXP inRcppCcdInterface,
     using namespace bsccs;
     XPtr<RcppCcdInterface> interface(inRcppCcdInterface);
 
+    const ModelData& data = interface->getModelData();
+    if (!data.getInputRows().empty() &&
+            data.getNumberOfInputRows() == static_cast<size_t>(weights.size())) {
+        std::vector<double> modelWeights(data.getNumberOfRows());
+        data.toModelRows(&weights[0], modelWeights.data());
+        interface->getCcd().setWeights(modelWeights.data());
+        return;
+    }
+
     interface->getCcd().setWeights(&weights[0]);
 }
 
@@ -130,6 +139,14 @@ double cyclopsGetPredictiveLogLikelihood(SEXP inRcppCcdInterface,
     using namespace bsccs;
     XPtr<RcppCcdInterface> interface(inRcppCcdInterface);
 
+    const ModelData& data = interface->getModelData();
+    if (!data.getInputRows().empty() &&
+            data.getNumberOfInputRows() == static_cast<size_t>(weights.size())) {
+        std::vector<double> modelWeights(data.getNumberOfRows());
+        data.toModelRows(&weights[0], modelWeights.data());
+        return interface->getCcd().getPredictiveLogLikelihood(modelWeights.data());
+    }
+
     return interface->getCcd().getPredictiveLogLikelihood(&weights[0]);
 }
 
@@ -406,6 +423,9 @@ List cyclopsInitializeModel(SEXP inModelData, const std::string& modelType, bool
 	using namespace bsccs;
 
 	XPtr<RcppModelData> rcppModelData(inModelData);
+	if (rcppModelData->getAppendSession()) {
+		rcppModelData->endAppendSession();
+	}
 	XPtr<RcppCcdInterface> interface(
 		new RcppCcdInterface(*rcppModelData));
 
@@ -555,6 +575,14 @@ bsccs::ModelType RcppCcdInterface::parseModelType(const std::string& modelName)
  	return modelType;
 }
 
+std::string RcppCcdInterface::getModelTypeName(bsccs::ModelType modelType) {
+	auto model = modelTypeNames.find(modelType);
+	if (model == end(modelTypeNames)) {
+		handleError("Invalid model type.");
+	}
+	return model->second;
+}
+
 void RcppCcdInterface::setNoiseLevel(bsccs::NoiseLevels noiseLevel) {
     using namespace bsccs;
     ccd->setNoiseLevel(noiseLevel);
@@ -793,15 +821,17 @@ void RcppCcdInterface::predictModelImpl(CyclicCoordinateDescent *ccd, ModelData
 //     OutputHelper::RcppOutputHelper test(result);
 //     predictor.writeStream(test);
 
-    NumericVector predictions(ccd->getPredictionSize());
-    //std::vector<double> predictions(ccd->getPredictionSize());
-    ccd->getPredictiveEstimates(&predictions[0], NULL);
+    std::vector<double> modelPredictions(ccd->getPredictionSize());
+    ccd->getPredictiveEstimates(modelPredictions.data(), NULL);
+
+    // Rows sorted or merged at finalization are returned as the caller's rows
+    NumericVector predictions(modelData->getNumberOfInputRows());
+    modelData->toInputRows(modelPredictions.data(), &predictions[0]);
 
-    if (modelData->getHasRowLabels()) {
-        size_t preds = ccd->getPredictionSize();
-        CharacterVector labels(preds);
-        for (size_t i = 0; i < preds; ++i) {
-            labels[i] = modelData->getRowLabel(i);
+    if (modelData->getHasInputRowLabels()) {
+        CharacterVector labels(predictions.size());
+        for (int i = 0; i < predictions.size(); ++i) {
+            labels[i] = modelData->getInputRowLabel(i);
         }
         predictions.names() = labels;
     }
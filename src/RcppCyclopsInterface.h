@@ -91,6 +91,7 @@ public:
     static void appendRList(Rcpp::List& list, const Rcpp::List& append);
 
     static ModelType parseModelType(const std::string& modelName);
+    static std::string getModelTypeName(ModelType modelType);
     static priors::PriorType parsePriorType(const std::string& priorName);
     static ConvergenceType parseConvergenceType(const std::string& convergenceName);
     static NoiseLevels parseNoiseLevel(const std::string& noiseName);
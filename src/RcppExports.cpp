@@ -512,6 +512,17 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// cyclopsGetNumberOfStorageAliases
+int cyclopsGetNumberOfStorageAliases(Environment x);
+RcppExport SEXP Cyclops_cyclopsGetNumberOfStorageAliases(SEXP xSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Environment >::type x(xSEXP);
+    rcpp_result_gen = Rcpp::wrap(cyclopsGetNumberOfStorageAliases(x));
+    return rcpp_result_gen;
+END_RCPP
+}
 // cyclopsGetMeanOffset
 double cyclopsGetMeanOffset(Environment x);
 RcppExport SEXP Cyclops_cyclopsGetMeanOffset(SEXP xSEXP) {
@@ -524,8 +535,8 @@ BEGIN_RCPP
 END_RCPP
 }
 // cyclopsFinalizeData
-void cyclopsFinalizeData(Environment x, bool addIntercept, SEXP sexpOffsetCovariate, bool offsetAlreadyOnLogScale, bool sortCovariates, SEXP sexpCovariatesDense, bool magicFlag);
-RcppExport SEXP Cyclops_cyclopsFinalizeData(SEXP xSEXP, SEXP addInterceptSEXP, SEXP sexpOffsetCovariateSEXP, SEXP offsetAlreadyOnLogScaleSEXP, SEXP sortCovariatesSEXP, SEXP sexpCovariatesDenseSEXP, SEXP magicFlagSEXP) {
+void cyclopsFinalizeData(Environment x, bool addIntercept, SEXP sexpOffsetCovariate, bool offsetAlreadyOnLogScale, bool sortCovariates, SEXP sexpCovariatesDense, bool magicFlag, bool compressIndicators, bool selectFormats, bool sortRows, bool compressRows, bool calibrateFormats);
+RcppExport SEXP Cyclops_cyclopsFinalizeData(SEXP xSEXP, SEXP addInterceptSEXP, SEXP sexpOffsetCovariateSEXP, SEXP offsetAlreadyOnLogScaleSEXP, SEXP sortCovariatesSEXP, SEXP sexpCovariatesDenseSEXP, SEXP magicFlagSEXP, SEXP compressIndicatorsSEXP, SEXP selectFormatsSEXP, SEXP sortRowsSEXP, SEXP compressRowsSEXP, SEXP calibrateFormatsSEXP) {
 BEGIN_RCPP
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Environment >::type x(xSEXP);
@@ -535,34 +546,39 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< bool >::type sortCovariates(sortCovariatesSEXP);
     Rcpp::traits::input_parameter< SEXP >::type sexpCovariatesDense(sexpCovariatesDenseSEXP);
     Rcpp::traits::input_parameter< bool >::type magicFlag(magicFlagSEXP);
-    cyclopsFinalizeData(x, addIntercept, sexpOffsetCovariate, offsetAlreadyOnLogScale, sortCovariates, sexpCovariatesDense, magicFlag);
+    Rcpp::traits::input_parameter< bool >::type compressIndicators(compressIndicatorsSEXP);
+    Rcpp::traits::input_parameter< bool >::type selectFormats(selectFormatsSEXP);
+    Rcpp::traits::input_parameter< bool >::type sortRows(sortRowsSEXP);
+    Rcpp::traits::input_parameter< bool >::type compressRows(compressRowsSEXP);
+    Rcpp::traits::input_parameter< bool >::type calibrateFormats(calibrateFormatsSEXP);
+    cyclopsFinalizeData(x, addIntercept, sexpOffsetCovariate, offsetAlreadyOnLogScale, sortCovariates, sexpCovariatesDense, magicFlag, compressIndicators, selectFormats, sortRows, compressRows, calibrateFormats);
     return R_NilValue;
 END_RCPP
 }
 // cyclopsLoadDataY
-void cyclopsLoadDataY(Environment x, const std::vector<int64_t>& stratumId, const std::vector<int64_t>& rowId, const std::vector<double>& y, const std::vector<double>& time);
+void cyclopsLoadDataY(Environment x, SEXP stratumId, SEXP rowId, SEXP y, SEXP time);
 RcppExport SEXP Cyclops_cyclopsLoadDataY(SEXP xSEXP, SEXP stratumIdSEXP, SEXP rowIdSEXP, SEXP ySEXP, SEXP timeSEXP) {
 BEGIN_RCPP
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Environment >::type x(xSEXP);
-    Rcpp::traits::input_parameter< const std::vector<int64_t>& >::type stratumId(stratumIdSEXP);
-    Rcpp::traits::input_parameter< const std::vector<int64_t>& >::type rowId(rowIdSEXP);
-    Rcpp::traits::input_parameter< const std::vector<double>& >::type y(ySEXP);
-    Rcpp::traits::input_parameter< const std::vector<double>& >::type time(timeSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type stratumId(stratumIdSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type rowId(rowIdSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type y(ySEXP);
+    Rcpp::traits::input_parameter< SEXP >::type time(timeSEXP);
     cyclopsLoadDataY(x, stratumId, rowId, y, time);
     return R_NilValue;
 END_RCPP
 }
 // cyclopsLoadDataMultipleX
-int cyclopsLoadDataMultipleX(Environment x, const std::vector<int64_t>& covariateId, const std::vector<int64_t>& rowId, const std::vector<double>& covariateValue, const bool checkCovariateIds, const bool checkCovariateBounds, const bool append, const bool forceSparse);
+int cyclopsLoadDataMultipleX(Environment x, SEXP covariateId, SEXP rowId, SEXP covariateValue, const bool checkCovariateIds, const bool checkCovariateBounds, const bool append, const bool forceSparse);
 RcppExport SEXP Cyclops_cyclopsLoadDataMultipleX(SEXP xSEXP, SEXP covariateIdSEXP, SEXP rowIdSEXP, SEXP covariateValueSEXP, SEXP checkCovariateIdsSEXP, SEXP checkCovariateBoundsSEXP, SEXP appendSEXP, SEXP forceSparseSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Environment >::type x(xSEXP);
-    Rcpp::traits::input_parameter< const std::vector<int64_t>& >::type covariateId(covariateIdSEXP);
-    Rcpp::traits::input_parameter< const std::vector<int64_t>& >::type rowId(rowIdSEXP);
-    Rcpp::traits::input_parameter< const std::vector<double>& >::type covariateValue(covariateValueSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type covariateId(covariateIdSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type rowId(rowIdSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type covariateValue(covariateValueSEXP);
     Rcpp::traits::input_parameter< const bool >::type checkCovariateIds(checkCovariateIdsSEXP);
     Rcpp::traits::input_parameter< const bool >::type checkCovariateBounds(checkCovariateBoundsSEXP);
     Rcpp::traits::input_parameter< const bool >::type append(appendSEXP);
@@ -572,15 +588,15 @@ BEGIN_RCPP
 END_RCPP
 }
 // cyclopsLoadDataX
-int cyclopsLoadDataX(Environment x, const int64_t covariateId, const std::vector<int64_t>& rowId, const std::vector<double>& covariateValue, const bool replace, const bool append, const bool forceSparse);
+int cyclopsLoadDataX(Environment x, const int64_t covariateId, SEXP rowId, SEXP covariateValue, const bool replace, const bool append, const bool forceSparse);
 RcppExport SEXP Cyclops_cyclopsLoadDataX(SEXP xSEXP, SEXP covariateIdSEXP, SEXP rowIdSEXP, SEXP covariateValueSEXP, SEXP replaceSEXP, SEXP appendSEXP, SEXP forceSparseSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Environment >::type x(xSEXP);
     Rcpp::traits::input_parameter< const int64_t >::type covariateId(covariateIdSEXP);
-    Rcpp::traits::input_parameter< const std::vector<int64_t>& >::type rowId(rowIdSEXP);
-    Rcpp::traits::input_parameter< const std::vector<double>& >::type covariateValue(covariateValueSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type rowId(rowIdSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type covariateValue(covariateValueSEXP);
     Rcpp::traits::input_parameter< const bool >::type replace(replaceSEXP);
     Rcpp::traits::input_parameter< const bool >::type append(appendSEXP);
     Rcpp::traits::input_parameter< const bool >::type forceSparse(forceSparseSEXP);
@@ -589,23 +605,45 @@ BEGIN_RCPP
 END_RCPP
 }
 // cyclopsAppendSqlData
-int cyclopsAppendSqlData(Environment x, const std::vector<int64_t>& oStratumId, const std::vector<int64_t>& oRowId, const std::vector<double>& oY, const std::vector<double>& oTime, const std::vector<int64_t>& cRowId, const std::vector<int64_t>& cCovariateId, const std::vector<double>& cCovariateValue);
+int cyclopsAppendSqlData(Environment x, SEXP oStratumId, SEXP oRowId, SEXP oY, SEXP oTime, SEXP cRowId, SEXP cCovariateId, SEXP cCovariateValue);
 RcppExport SEXP Cyclops_cyclopsAppendSqlData(SEXP xSEXP, SEXP oStratumIdSEXP, SEXP oRowIdSEXP, SEXP oYSEXP, SEXP oTimeSEXP, SEXP cRowIdSEXP, SEXP cCovariateIdSEXP, SEXP cCovariateValueSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Environment >::type x(xSEXP);
-    Rcpp::traits::input_parameter< const std::vector<int64_t>& >::type oStratumId(oStratumIdSEXP);
-    Rcpp::traits::input_parameter< const std::vector<int64_t>& >::type oRowId(oRowIdSEXP);
-    Rcpp::traits::input_parameter< const std::vector<double>& >::type oY(oYSEXP);
-    Rcpp::traits::input_parameter< const std::vector<double>& >::type oTime(oTimeSEXP);
-    Rcpp::traits::input_parameter< const std::vector<int64_t>& >::type cRowId(cRowIdSEXP);
-    Rcpp::traits::input_parameter< const std::vector<int64_t>& >::type cCovariateId(cCovariateIdSEXP);
-    Rcpp::traits::input_parameter< const std::vector<double>& >::type cCovariateValue(cCovariateValueSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type oStratumId(oStratumIdSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type oRowId(oRowIdSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type oY(oYSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type oTime(oTimeSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type cRowId(cRowIdSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type cCovariateId(cCovariateIdSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type cCovariateValue(cCovariateValueSEXP);
     rcpp_result_gen = Rcpp::wrap(cyclopsAppendSqlData(x, oStratumId, oRowId, oY, oTime, cRowId, cCovariateId, cCovariateValue));
     return rcpp_result_gen;
 END_RCPP
 }
+// cyclopsBeginAppend
+void cyclopsBeginAppend(Environment x, int maxQueuedBatches);
+RcppExport SEXP Cyclops_cyclopsBeginAppend(SEXP xSEXP, SEXP maxQueuedBatchesSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Environment >::type x(xSEXP);
+    Rcpp::traits::input_parameter< int >::type maxQueuedBatches(maxQueuedBatchesSEXP);
+    cyclopsBeginAppend(x, maxQueuedBatches);
+    return R_NilValue;
+END_RCPP
+}
+// cyclopsEndAppend
+int cyclopsEndAppend(Environment x);
+RcppExport SEXP Cyclops_cyclopsEndAppend(SEXP xSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Environment >::type x(xSEXP);
+    rcpp_result_gen = Rcpp::wrap(cyclopsEndAppend(x));
+    return rcpp_result_gen;
+END_RCPP
+}
 // cyclopsGetInterceptLabel
 SEXP cyclopsGetInterceptLabel(Environment x);
 RcppExport SEXP Cyclops_cyclopsGetInterceptLabel(SEXP xSEXP) {
@@ -618,14 +656,53 @@ BEGIN_RCPP
 END_RCPP
 }
 // cyclopsReadFileData
-List cyclopsReadFileData(const std::string& fileName, const std::string& modelTypeName);
-RcppExport SEXP Cyclops_cyclopsReadFileData(SEXP fileNameSEXP, SEXP modelTypeNameSEXP) {
+List cyclopsReadFileData(const std::string& fileName, const std::string& modelTypeName, int compressedBlockSize, bool chunkedParsing, int threads);
+RcppExport SEXP Cyclops_cyclopsReadFileData(SEXP fileNameSEXP, SEXP modelTypeNameSEXP, SEXP compressedBlockSizeSEXP, SEXP chunkedParsingSEXP, SEXP threadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< const std::string& >::type fileName(fileNameSEXP);
     Rcpp::traits::input_parameter< const std::string& >::type modelTypeName(modelTypeNameSEXP);
-    rcpp_result_gen = Rcpp::wrap(cyclopsReadFileData(fileName, modelTypeName));
+    Rcpp::traits::input_parameter< int >::type compressedBlockSize(compressedBlockSizeSEXP);
+    Rcpp::traits::input_parameter< bool >::type chunkedParsing(chunkedParsingSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(cyclopsReadFileData(fileName, modelTypeName, compressedBlockSize, chunkedParsing, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// cyclopsSaveData
+void cyclopsSaveData(Environment x, const std::string& fileName, SEXP coefficientNames);
+RcppExport SEXP Cyclops_cyclopsSaveData(SEXP xSEXP, SEXP fileNameSEXP, SEXP coefficientNamesSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Environment >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type fileName(fileNameSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type coefficientNames(coefficientNamesSEXP);
+    cyclopsSaveData(x, fileName, coefficientNames);
+    return R_NilValue;
+END_RCPP
+}
+// cyclopsLoadData
+List cyclopsLoadData(const std::string& fileName, const std::string& noiseLevel, double residentBudget);
+RcppExport SEXP Cyclops_cyclopsLoadData(SEXP fileNameSEXP, SEXP noiseLevelSEXP, SEXP residentBudgetSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type fileName(fileNameSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type noiseLevel(noiseLevelSEXP);
+    Rcpp::traits::input_parameter< double >::type residentBudget(residentBudgetSEXP);
+    rcpp_result_gen = Rcpp::wrap(cyclopsLoadData(fileName, noiseLevel, residentBudget));
+    return rcpp_result_gen;
+END_RCPP
+}
+// cyclopsGetPagerStatistics
+SEXP cyclopsGetPagerStatistics(Environment x);
+RcppExport SEXP Cyclops_cyclopsGetPagerStatistics(SEXP xSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Environment >::type x(xSEXP);
+    rcpp_result_gen = Rcpp::wrap(cyclopsGetPagerStatistics(x));
     return rcpp_result_gen;
 END_RCPP
 }
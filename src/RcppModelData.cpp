@@ -10,6 +10,10 @@
 #include "Timer.h"
 #include "RcppCyclopsInterface.h"
 #include "io/NewGenericInputReader.h"
+#include "io/ModelDataFile.h"
+#include "io/AppendSession.h"
+#include "FormatCostModel.h"
+#include "ColumnPager.h"
 #include "RcppProgressLogger.h"
 
 using namespace Rcpp;
@@ -44,7 +48,8 @@ struct InnerProduct {
     }
 };
 
-XPtr<bsccs::ModelData> parseEnvironmentForPtr(const Environment& x) {
+// Unless queuing, first waits for batches appended in the background
+XPtr<bsccs::ModelData> parseEnvironmentForPtr(const Environment& x, bool queuing = false) {
 	if (!x.inherits("cyclopsData")) {
 		stop("Input must be a cyclopsData object");
 	}
@@ -58,6 +63,9 @@ XPtr<bsccs::ModelData> parseEnvironmentForPtr(const Environment& x) {
 	if (!ptr) {
 		stop("cyclopsData object is uninitialized");
 	}
+	if (!queuing && ptr->getAppendSession()) {
+		ptr->endAppendSession();
+	}
 	return ptr;
 }
 
@@ -75,9 +83,33 @@ XPtr<bsccs::RcppModelData> parseEnvironmentForRcppPtr(const Environment& x) {
 	if (!ptr) {
 		stop("cyclopsData object is uninitialized");
 	}
+	if (ptr->getAppendSession()) {
+		ptr->endAppendSession();
+	}
 	return ptr;
 }
 
+// Type and storage of an R vector, read in place; integer64 (bit64) doubles hold the bits of
+// 64-bit integers.  NULL is empty.
+bsccs::InputColumn inputColumnOf(SEXP sexp) {
+	using namespace bsccs;
+	const size_t length = Rf_xlength(sexp);
+	switch (TYPEOF(sexp)) {
+		case NILSXP :
+			return InputColumn();
+		case REALSXP :
+			return InputColumn(Rf_inherits(sexp, "integer64") ? InputColumn::INT64 : InputColumn::REAL64,
+				REAL(sexp), length);
+		case INTSXP :
+			return InputColumn(InputColumn::INT32, INTEGER(sexp), length);
+		case LGLSXP :
+			return InputColumn(InputColumn::INT32, LOGICAL(sexp), length);
+		default :
+			stop("Columns must be integer, numeric or integer64 vectors");
+	}
+	return InputColumn();
+}
+
 //' @title Print row identifiers
 //'
 //' @description
@@ -128,7 +160,7 @@ bool isRcppPtrNull(SEXP x) {
 // [[Rcpp::export("getNumberOfStrata")]]
 int cyclopsGetNumberOfStrata(Environment object) {
 	XPtr<bsccs::ModelData> data = parseEnvironmentForPtr(object);
-	return static_cast<int>(data->getNumberOfPatients());
+	return data->getNumberOfInputPatients();
 }
 
 //' @title Get covariate identifiers
@@ -221,7 +253,7 @@ void cyclopsPrintMatrixMarket(Environment object, const std::string& file) {
 // [[Rcpp::export("getNumberOfRows")]]
 int cyclopsGetNumberOfRows(Environment object) {
 	XPtr<bsccs::ModelData> data = parseEnvironmentForPtr(object);
-	return static_cast<int>(data->getNumberOfRows());
+	return static_cast<int>(data->getNumberOfInputRows());
 }
 
 //' @title Get total number of outcome types
@@ -243,16 +275,22 @@ std::vector<double> cyclopsUnivariableCorrelation(Environment x,
                                                   const std::vector<long>& covariateLabel) {
     XPtr<bsccs::RcppModelData> data = parseEnvironmentForRcppPtr(x);
 
-    const double Ey1 = data->reduce(-1, FirstPower()) / data->getNumberOfRows();
-    const double Ey2 = data->reduce(-1, SecondPower()) / data->getNumberOfRows();
+    // Merged self-controlled rows sum their members' outcomes, which then have no row-wise moments
+    if (data->getHasSummedRows()) {
+        stop("Univariable correlations are not available after compressRows merged rows within strata");
+    }
+    const double nRows = data->getNumberOfInputRows();
+
+    const double Ey1 = data->reduce(-1, FirstPower()) / nRows;
+    const double Ey2 = data->reduce(-1, SecondPower()) / nRows;
     const double Vy = Ey2 - Ey1 * Ey1;
 
     std::vector<double> result;
 
-    auto oneVariable = [&data, &result, Ey1, Vy](const size_t index) {
-        const double Ex1 = data->reduce(index, FirstPower()) / data->getNumberOfRows();
-        const double Ex2 = data->reduce(index, SecondPower()) / data->getNumberOfRows();
-        const double Exy = data->innerProductWithOutcome(index, InnerProduct()) / data->getNumberOfRows();
+    auto oneVariable = [&data, &result, Ey1, Vy, nRows](const size_t index) {
+        const double Ex1 = data->reduce(index, FirstPower()) / nRows;
+        const double Ex2 = data->reduce(index, SecondPower()) / nRows;
+        const double Exy = data->innerProductWithOutcome(index, InnerProduct()) / nRows;
 
         const double Vx = Ex2 - Ex1 * Ex1;
         const double cov = Exy - Ex1 * Ey1;
@@ -390,13 +428,25 @@ bool cyclopsGetHasOffset(Environment x) {
     return data->getHasOffsetCovariate();
 }
 
+// [[Rcpp::export(".cyclopsGetNumberOfStorageAliases")]]
+int cyclopsGetNumberOfStorageAliases(Environment x) {
+    using namespace bsccs;
+    XPtr<ModelData> data = parseEnvironmentForPtr(x);
+    return static_cast<int>(data->getNumberOfStorageAliases());
+}
+
 // [[Rcpp::export(".cyclopsGetMeanOffset")]]
 double cyclopsGetMeanOffset(Environment x) {
     using namespace bsccs;
     XPtr<RcppModelData> data = parseEnvironmentForRcppPtr(x);
-    return (data->getHasOffsetCovariate()) ?
-        data->sum(-1, 1) / data->getNumberOfRows() :
-        0.0;
+    if (!data->getHasOffsetCovariate()) {
+        return 0.0;
+    }
+    // Merged self-controlled rows hold the log of their members' summed times
+    if (data->getHasSummedRows()) {
+        return NA_REAL;
+    }
+    return data->sum(-1, 1) / data->getNumberOfInputRows();
 }
 
 // [[Rcpp::export(".cyclopsFinalizeData")]]
@@ -407,7 +457,12 @@ void cyclopsFinalizeData(
         bool offsetAlreadyOnLogScale,
         bool sortCovariates,
         SEXP sexpCovariatesDense,
-        bool magicFlag = false) {
+        bool magicFlag = false,
+        bool compressIndicators = false,
+        bool selectFormats = false,
+        bool sortRows = false,
+        bool compressRows = false,
+        bool calibrateFormats = false) {
     using namespace bsccs;
     XPtr<ModelData> data = parseEnvironmentForPtr(x);
 
@@ -415,6 +470,19 @@ void cyclopsFinalizeData(
         ::Rf_error("OHDSI data object is already finalized");
     }
 
+    if (sortRows) {
+        data->sortRows();
+    } else if (!data->getHasSortedStrata()) {
+        ::Rf_error("All columns must be sorted first by stratumId (if supplied) and then by rowId, or finalized with sortRows = TRUE");
+    }
+
+    if (compressRows) {
+        // Time used as the offset (-1) is summed with the rows; a named covariate could not be
+        const bool hasOffsetColumn = !Rf_isNull(sexpOffsetCovariate) &&
+            as<IdType>(sexpOffsetCovariate) != -1;
+        data->compressRows(hasOffsetColumn);
+    }
+
     if (addIntercept) {
         if (data->getHasInterceptCovariate()) {
             ::Rf_error("OHDSI data object already has an intercept");
@@ -460,36 +528,55 @@ void cyclopsFinalizeData(
         });
     }
 
+    std::vector<size_t> denseColumns;
     if (!Rf_isNull(sexpCovariatesDense)) {
         // TODO handle dense conversion
         ProfileVector covariates = as<ProfileVector>(sexpCovariatesDense);
         for (auto it = covariates.begin(); it != covariates.end(); ++it) {
         	IdType index = data->getColumnIndex(*it);
         	data->getColumn(index).convertColumnToDense(data->getNumberOfRows());
+        	denseColumns.push_back(index);
         }
     }
 
+    if (selectFormats) {
+        data->optimizeColumnFormats(denseColumns, compressIndicators ?
+            FormatCostModel::CompactMemoryWeight : FormatCostModel::DefaultMemoryWeight,
+            calibrateFormats);
+    } else {
+        data->encodeIndicatorColumns(compressIndicators);
+    }
+
+    data->shareIdenticalColumns();
+
+    data->packColumns();
     data->setIsFinalized(true);
 }
 
 
 // [[Rcpp::export(".loadCyclopsDataY")]]
 void cyclopsLoadDataY(Environment x,
-        const std::vector<int64_t>& stratumId,
-        const std::vector<int64_t>& rowId,
-        const std::vector<double>& y,
-        const std::vector<double>& time) {
+        SEXP stratumId,
+        SEXP rowId,
+        SEXP y,
+        SEXP time) {
 
     using namespace bsccs;
     XPtr<ModelData> data = parseEnvironmentForPtr(x);
-    data->loadY(stratumId, rowId, y, time);
+
+    std::vector<IdType> stratumBuffer, rowBuffer;
+    std::vector<double> yBuffer, timeBuffer;
+    data->loadY(inputColumnOf(stratumId).viewIds(stratumBuffer),
+                inputColumnOf(rowId).viewIds(rowBuffer),
+                inputColumnOf(y).viewReals(yBuffer),
+                inputColumnOf(time).viewReals(timeBuffer));
 }
 
 // [[Rcpp::export(".loadCyclopsDataMultipleX")]]
 int cyclopsLoadDataMultipleX(Environment x,
-		const std::vector<int64_t>& covariateId,
-		const std::vector<int64_t>& rowId,
-		const std::vector<double>& covariateValue,
+		SEXP covariateId,
+		SEXP rowId,
+		SEXP covariateValue,
 		const bool checkCovariateIds,
 		const bool checkCovariateBounds,
 		const bool append,
@@ -498,15 +585,19 @@ int cyclopsLoadDataMultipleX(Environment x,
 	using namespace bsccs;
 	XPtr<ModelData> data = parseEnvironmentForPtr(x);
 
-	return data->loadMultipleX(covariateId, rowId, covariateValue, checkCovariateIds,
-                            checkCovariateBounds, append, forceSparse);
+	std::vector<IdType> covariateBuffer, rowBuffer;
+	std::vector<double> valueBuffer;
+	return data->loadMultipleX(inputColumnOf(covariateId).viewIds(covariateBuffer),
+                            inputColumnOf(rowId).viewIds(rowBuffer),
+                            inputColumnOf(covariateValue).viewReals(valueBuffer),
+                            checkCovariateIds, checkCovariateBounds, append, forceSparse);
 }
 
 // [[Rcpp::export(".loadCyclopsDataX")]]
 int cyclopsLoadDataX(Environment x,
         const int64_t covariateId,
-        const std::vector<int64_t>& rowId,
-        const std::vector<double>& covariateValue,
+        SEXP rowId,
+        SEXP covariateValue,
         const bool replace,
         const bool append,
         const bool forceSparse) {
@@ -517,29 +608,98 @@ int cyclopsLoadDataX(Environment x,
     // rowId.size() == 0 -> dense
     // covariateValue.size() == 0 -> indicator
 
-    return data->loadX(covariateId, rowId, covariateValue, replace, append, forceSparse);
+    std::vector<IdType> rowBuffer;
+    std::vector<double> valueBuffer;
+    return data->loadX(covariateId, inputColumnOf(rowId).viewIds(rowBuffer),
+                       inputColumnOf(covariateValue).viewReals(valueBuffer),
+                       replace, append, forceSparse);
 }
 
-// NOTE:  IdType does not get exported into RcppExports, so hard-coded here
-// TODO Could use SEXP signature and cast in function
+// Batches appended in the background are read there, so are kept alive and copied before any
+// change in R
+void queueAppend(bsccs::ModelData& data,
+        const std::vector<SEXP>& inputs) {
+
+    using namespace bsccs;
+    AppendSession::Batch batch;
+    batch.oStratumId = inputColumnOf(inputs[0]);
+    batch.oRowId = inputColumnOf(inputs[1]);
+    batch.oY = inputColumnOf(inputs[2]);
+    batch.oTime = inputColumnOf(inputs[3]);
+    batch.cRowId = inputColumnOf(inputs[4]);
+    batch.cCovariateId = inputColumnOf(inputs[5]);
+    batch.cCovariateValue = inputColumnOf(inputs[6]);
+
+    SEXP columns = PROTECT(Rf_allocVector(VECSXP, inputs.size()));
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (!Rf_isNull(inputs[i])) {
+#ifdef MARK_NOT_MUTABLE
+            MARK_NOT_MUTABLE(inputs[i]);
+#else
+            SET_NAMED(inputs[i], 2);
+#endif
+        }
+        SET_VECTOR_ELT(columns, i, inputs[i]);
+    }
+    R_PreserveObject(columns);
+    UNPROTECT(1);
+    batch.owner = bsccs::shared_ptr<void>(static_cast<void*>(columns), [](void* kept) {
+        R_ReleaseObject(static_cast<SEXP>(kept));
+    });
+
+    if (!data.getAppendSession()->enqueue(std::move(batch))) {
+        data.endAppendSession(); // Reports the failure
+    }
+}
+
+// NOTE:  Vectors are taken as SEXP and read in place where their storage allows (see inputColumnOf)
 
 // [[Rcpp::export(".appendSqlCyclopsData")]]
 int cyclopsAppendSqlData(Environment x,
-        const std::vector<int64_t>& oStratumId,
-        const std::vector<int64_t>& oRowId,
-        const std::vector<double>& oY,
-        const std::vector<double>& oTime,
-        const std::vector<int64_t>& cRowId,
-        const std::vector<int64_t>& cCovariateId,
-        const std::vector<double>& cCovariateValue) {
+        SEXP oStratumId,
+        SEXP oRowId,
+        SEXP oY,
+        SEXP oTime,
+        SEXP cRowId,
+        SEXP cCovariateId,
+        SEXP cCovariateValue) {
         // o -> outcome, c -> covariates
 
     using namespace bsccs;
-    XPtr<ModelData> data = parseEnvironmentForPtr(x);
-    size_t count = data->append(oStratumId, oRowId, oY, oTime, cRowId, cCovariateId, cCovariateValue);
+    XPtr<ModelData> data = parseEnvironmentForPtr(x, true);
+
+    if (data->getAppendSession()) {
+        queueAppend(*data, { oStratumId, oRowId, oY, oTime, cRowId, cCovariateId, cCovariateValue });
+        return static_cast<int>(Rf_xlength(oStratumId));
+    }
+
+    std::vector<IdType> oStratumBuffer, oRowBuffer, cRowBuffer, cCovariateBuffer;
+    std::vector<double> oYBuffer, oTimeBuffer, cValueBuffer;
+    size_t count = data->append(
+        inputColumnOf(oStratumId).viewIds(oStratumBuffer),
+        inputColumnOf(oRowId).viewIds(oRowBuffer),
+        inputColumnOf(oY).viewReals(oYBuffer),
+        inputColumnOf(oTime).viewReals(oTimeBuffer),
+        inputColumnOf(cRowId).viewIds(cRowBuffer),
+        inputColumnOf(cCovariateId).viewIds(cCovariateBuffer),
+        inputColumnOf(cCovariateValue).viewReals(cValueBuffer));
     return static_cast<int>(count);
 }
 
+// [[Rcpp::export(".cyclopsBeginAppend")]]
+void cyclopsBeginAppend(Environment x, int maxQueuedBatches) {
+    using namespace bsccs;
+    XPtr<ModelData> data = parseEnvironmentForPtr(x);
+    data->beginAppendSession(static_cast<size_t>(std::max(1, maxQueuedBatches)));
+}
+
+// [[Rcpp::export(".cyclopsEndAppend")]]
+int cyclopsEndAppend(Environment x) {
+    using namespace bsccs;
+    XPtr<ModelData> data = parseEnvironmentForPtr(x, true);
+    return static_cast<int>(data->endAppendSession());
+}
+
 
 // [[Rcpp::export(".cyclopsGetInterceptLabel")]]
 SEXP cyclopsGetInterceptLabel(Environment x) {
@@ -554,14 +714,20 @@ SEXP cyclopsGetInterceptLabel(Environment x) {
 }
 
 // [[Rcpp::export(".cyclopsReadData")]]
-List cyclopsReadFileData(const std::string& fileName, const std::string& modelTypeName) {
+List cyclopsReadFileData(const std::string& fileName, const std::string& modelTypeName,
+		int compressedBlockSize = 0, bool chunkedParsing = true, int threads = -1) {
 
 		using namespace bsccs;
 		Timer timer;
     ModelType modelType = RcppCcdInterface::parseModelType(modelTypeName);
-    InputReader* reader = new NewGenericInputReader(modelType,
+    NewGenericInputReader* reader = new NewGenericInputReader(modelType,
     	bsccs::make_shared<loggers::RcppProgressLogger>(true), // make silent
     	bsccs::make_shared<loggers::RcppErrorHandler>());
+		if (compressedBlockSize > 0) {
+			reader->setCompressedBlockSize(compressedBlockSize);
+		}
+		reader->setChunkedParsing(chunkedParsing);
+		reader->setThreads(threads);
 		reader->readFile(fileName.c_str()); // TODO Check for error
 
     XPtr<ModelData> ptr(reader->getModelData());
@@ -582,6 +748,69 @@ List cyclopsReadFileData(const std::string& fileName, const std::string& modelTy
     return list;
 }
 
+// [[Rcpp::export(".cyclopsSaveData")]]
+void cyclopsSaveData(Environment x, const std::string& fileName, SEXP coefficientNames) {
+    using namespace bsccs;
+    XPtr<ModelData> data = parseEnvironmentForPtr(x);
+
+    if (!data->getIsFinalized()) {
+        ::Rf_error("OHDSI data object must be finalized before saving");
+    }
+
+    std::vector<std::string> names;
+    if (!Rf_isNull(coefficientNames)) {
+        names = as<std::vector<std::string> >(coefficientNames);
+    }
+    ModelDataFile::write(*data, fileName, names);
+}
+
+// [[Rcpp::export(".cyclopsLoadData")]]
+List cyclopsLoadData(const std::string& fileName, const std::string& noiseLevel,
+        double residentBudget = 0.0) {
+    using namespace bsccs;
+    Timer timer;
+
+    NoiseLevels noise = RcppCcdInterface::parseNoiseLevel(noiseLevel);
+    bool silent = (noise == SILENT);
+
+    auto error = bsccs::make_shared<loggers::RcppErrorHandler>();
+    ModelDataFile file(fileName, error);
+
+    RcppModelData* ptr = new RcppModelData(file.getModelType(),
+        bsccs::make_shared<loggers::RcppProgressLogger>(silent), error);
+    XPtr<RcppModelData> modelData(ptr);
+    file.read(*ptr);
+    if (residentBudget > 0.0) {
+        ptr->setResidentBudget(static_cast<size_t>(residentBudget));
+    }
+
+    const std::vector<std::string>& names = file.getCoefficientNames();
+
+    double time = timer();
+    List list = List::create(
+            Rcpp::Named("cyclopsDataPtr") = modelData,
+            Rcpp::Named("modelType") = RcppCcdInterface::getModelTypeName(file.getModelType()),
+            Rcpp::Named("timeLoad") = time,
+            Rcpp::Named("coefficientNames") = names.empty() ? R_NilValue : Rcpp::wrap(names)
+    );
+    return list;
+}
+
+// [[Rcpp::export(".cyclopsGetPagerStatistics")]]
+SEXP cyclopsGetPagerStatistics(Environment x) {
+    using namespace bsccs;
+    XPtr<ModelData> data = parseEnvironmentForPtr(x);
+    const ColumnPager* pager = data->getPager();
+    if (!pager) {
+        return R_NilValue; // Loaded without a resident budget
+    }
+    return List::create(
+            Rcpp::Named("residentBytes") = static_cast<double>(pager->getResidentBytes()),
+            Rcpp::Named("prefetches") = static_cast<double>(pager->getNumberOfPrefetches()),
+            Rcpp::Named("evictions") = static_cast<double>(pager->getNumberOfEvictions())
+    );
+}
+
 // [[Rcpp::export(".cyclopsModelData")]]
 List cyclopsModelData(SEXP pid, SEXP y, SEXP z, SEXP offs, SEXP dx, SEXP sx, SEXP ix,
     const std::string& modelTypeName,
@@ -832,13 +1061,34 @@ void RcppModelData::sumByGroup(std::vector<double>& out, const IdType covariate,
 
 void RcppModelData::sumByGroup(std::vector<double>& out, const IdType covariate, int power) {
     size_t covariateIndex = getColumnIndex(covariate);
-    out.resize(nPatients);
+    const IntVector& inputRows = getInputRows();
+    if (inputRows.empty()) {
+        out.resize(nPatients);
+        if (power == 0) {
+            reduceByGroup(out, covariateIndex, pid, ZeroPower(), RealVector());
+        } else if (power == 1) {
+            reduceByGroup(out, covariateIndex, pid, FirstPower(), RealVector());
+        } else {
+            reduceByGroup(out, covariateIndex, pid, SecondPower(), RealVector());
+        }
+        return;
+    }
+
+    // Rows merged by compressRows() may span strata, so each of the caller's rows adds to its own
+    std::vector<double> byRow(getNumberOfRows(), 0.0);
+    std::vector<int> rows(getNumberOfRows());
+    std::iota(rows.begin(), rows.end(), 0);
     if (power == 0) {
-    	reduceByGroup(out, covariateIndex, pid, ZeroPower());
+        reduceByGroup(byRow, covariateIndex, rows, ZeroPower(), RealVector());
     } else if (power == 1) {
-  		reduceByGroup(out, covariateIndex, pid, FirstPower());
+        reduceByGroup(byRow, covariateIndex, rows, FirstPower(), RealVector());
     } else {
-    	reduceByGroup(out, covariateIndex, pid, SecondPower());
+        reduceByGroup(byRow, covariateIndex, rows, SecondPower(), RealVector());
+    }
+    const std::vector<int> strata = getInputPidVectorSTL();
+    out.assign(getNumberOfInputPatients(), 0.0);
+    for (size_t i = 0; i < inputRows.size(); ++i) {
+        out[strata[i]] += byRow[inputRows[i]];
     }
 }
 
@@ -74,22 +74,32 @@ public:
 
 	template <typename F>
 	double reduce(const long index, F func) {
+		const RealVector weights = getRowMembers();
 		if (index < 0) { // reduce outcome
-			return reduceOutcomeImpl(func);
+			return reduceOutcomeImpl(func, weights);
 		}
 	    double sum = 0.0;
 		switch (getFormatType(index)) {
 			case INDICATOR :
-				sum = reduceImpl<IndicatorIterator>(index, func);
+				switch (getColumn(index).getIndexEncoding()) {
+					case VARINT_INDICES :
+						sum = reduceImpl<CompressedIndicatorIterator>(index, func, weights);
+						break;
+					case BITMAP_INDICES :
+						sum = reduceImpl<BitmapIndicatorIterator>(index, func, weights);
+						break;
+					default :
+						sum = reduceImpl<IndicatorIterator>(index, func, weights);
+				}
 				break;
 			case SPARSE :
-				sum = reduceImpl<SparseIterator>(index, func);
+				sum = reduceImpl<SparseIterator>(index, func, weights);
 				break;
 			case DENSE :
-				sum = reduceImpl<DenseIterator>(index, func);
+				sum = reduceImpl<DenseIterator>(index, func, weights);
 				break;
 			case INTERCEPT :
-				sum = reduceImpl<InterceptIterator>(index, func);
+				sum = reduceImpl<InterceptIterator>(index, func, weights);
 				break;
 		}
 	    return sum;
@@ -97,19 +107,29 @@ public:
 
 	template <typename F>
 	double innerProductWithOutcome(const size_t index, F func) {
+	    const RealVector weights = getRowMembers();
 	    double sum = 0.0;
 	    switch (getFormatType(index)) {
 	    case INDICATOR :
-	        sum = innerProductWithOutcomeImpl<IndicatorIterator>(index, func);
+	        switch (getColumn(index).getIndexEncoding()) {
+	            case VARINT_INDICES :
+	                sum = innerProductWithOutcomeImpl<CompressedIndicatorIterator>(index, func, weights);
+	                break;
+	            case BITMAP_INDICES :
+	                sum = innerProductWithOutcomeImpl<BitmapIndicatorIterator>(index, func, weights);
+	                break;
+	            default :
+	                sum = innerProductWithOutcomeImpl<IndicatorIterator>(index, func, weights);
+	        }
 	        break;
 	    case SPARSE :
-	        sum = innerProductWithOutcomeImpl<SparseIterator>(index, func);
+	        sum = innerProductWithOutcomeImpl<SparseIterator>(index, func, weights);
 	        break;
 	    case DENSE :
-	        sum = innerProductWithOutcomeImpl<DenseIterator>(index, func);
+	        sum = innerProductWithOutcomeImpl<DenseIterator>(index, func, weights);
 	        break;
 	    case INTERCEPT :
-	        sum = innerProductWithOutcomeImpl<InterceptIterator>(index, func);
+	        sum = innerProductWithOutcomeImpl<InterceptIterator>(index, func, weights);
 	        break;
 	    }
 	    return sum;
@@ -122,18 +142,28 @@ public:
 	        stream << "Grouping by non-indicators is not yet supported.";
 	        error->throwError(stream);
 	    }
+	    const RealVector weights = getRowMembers();
 		switch (getFormatType(reductionIndex)) {
 			case INDICATOR :
-                reduceByGroupImpl<IndicatorIterator>(out, reductionIndex, groupByIndex, func);
+				switch (getColumn(reductionIndex).getIndexEncoding()) {
+					case VARINT_INDICES :
+						reduceByGroupImpl<CompressedIndicatorIterator>(out, reductionIndex, groupByIndex, func, weights);
+						break;
+					case BITMAP_INDICES :
+						reduceByGroupImpl<BitmapIndicatorIterator>(out, reductionIndex, groupByIndex, func, weights);
+						break;
+					default :
+						reduceByGroupImpl<IndicatorIterator>(out, reductionIndex, groupByIndex, func, weights);
+				}
 				break;
 			case SPARSE :
-				reduceByGroupImpl<SparseIterator>(out, reductionIndex, groupByIndex, func);
+				reduceByGroupImpl<SparseIterator>(out, reductionIndex, groupByIndex, func, weights);
 				break;
 			case DENSE :
-				reduceByGroupImpl<DenseIterator>(out, reductionIndex, groupByIndex, func);
+				reduceByGroupImpl<DenseIterator>(out, reductionIndex, groupByIndex, func, weights);
 				break;
 			case INTERCEPT :
-			    reduceByGroupImpl<InterceptIterator>(out, reductionIndex, groupByIndex, func);
+			    reduceByGroupImpl<InterceptIterator>(out, reductionIndex, groupByIndex, func, weights);
 				break;
 		}
 	}
@@ -141,44 +171,61 @@ public:
 protected:
 
 	template <typename T, typename F>
-	void reduceByGroup(T& out, const size_t reductionIndex, const std::vector<int>& groups, F func) {
+	void reduceByGroup(T& out, const size_t reductionIndex, const std::vector<int>& groups, F func,
+			const RealVector& weights) {
 		switch (getFormatType(reductionIndex)) {
 			case INDICATOR :
-				reduceByGroupImpl<IndicatorIterator>(out, reductionIndex, groups, func);
+				switch (getColumn(reductionIndex).getIndexEncoding()) {
+					case VARINT_INDICES :
+						reduceByGroupImpl<CompressedIndicatorIterator>(out, reductionIndex, groups, func, weights);
+						break;
+					case BITMAP_INDICES :
+						reduceByGroupImpl<BitmapIndicatorIterator>(out, reductionIndex, groups, func, weights);
+						break;
+					default :
+						reduceByGroupImpl<IndicatorIterator>(out, reductionIndex, groups, func, weights);
+				}
 				break;
 			case SPARSE :
-				reduceByGroupImpl<SparseIterator>(out, reductionIndex, groups, func);
+				reduceByGroupImpl<SparseIterator>(out, reductionIndex, groups, func, weights);
 				break;
 			case DENSE :
-				reduceByGroupImpl<DenseIterator>(out, reductionIndex, groups, func);
+				reduceByGroupImpl<DenseIterator>(out, reductionIndex, groups, func, weights);
 				break;
 			case INTERCEPT :
-				reduceByGroupImpl<InterceptIterator>(out, reductionIndex, groups, func);
+				reduceByGroupImpl<InterceptIterator>(out, reductionIndex, groups, func, weights);
 				break;
 
 		}
 	}
 
 	template <typename IteratorType, typename T, typename F>
-	void reduceByGroupImpl(T& out, const size_t reductionIndex, const size_t groupByIndex, F func) {
+	void reduceByGroupImpl(T& out, const size_t reductionIndex, const size_t groupByIndex, F func,
+			const RealVector& weights) {
 	    IteratorType reduceIt(*this, reductionIndex);
 	    IndicatorIterator groupByIt(*this, groupByIndex);
 
 	    GroupByIterator<IteratorType> it(reduceIt, groupByIt);
 	    for (; it; ++it) {
-	        out[it.group()] += func(it.value()); // TODO compute reduction in registers
+	        out[it.group()] += weight(weights, it.index()) * func(it.value()); // TODO compute reduction in registers
 	    }
 	}
 
 	template <typename IteratorType, typename T, typename F>
-	void reduceByGroupImpl(T& out, const size_t reductionIndex, const std::vector<int>& groups, F func) {
+	void reduceByGroupImpl(T& out, const size_t reductionIndex, const std::vector<int>& groups, F func,
+			const RealVector& weights) {
 	    IteratorType it(*this, reductionIndex);
 
 	    for (; it; ++it) {
-	        out[groups[it.index()]] += func(it.value()); // TODO compute reduction in registers
+	        out[groups[it.index()]] += weight(weights, it.index()) * func(it.value()); // TODO compute reduction in registers
 	    }
 	}
 
+	// Rows merged by compressRows() count once per member
+	static double weight(const RealVector& weights, const size_t row) {
+		return weights.empty() ? 1.0 : weights[row];
+	}
+
 	template <typename IteratorType, typename F>
 	void transformImpl(const size_t index, F func) {
 	    IteratorType it(*this, index);
@@ -188,30 +235,30 @@ protected:
 	}
 
 	template <typename F>
-	double reduceOutcomeImpl(F func) {
+	double reduceOutcomeImpl(F func, const RealVector& weights) {
 		double sum = 0.0;
-		for(auto it = std::begin(y); it != std::end(y); ++it) {
-			sum += func(*it);
+		for (size_t i = 0; i < y.size(); ++i) {
+			sum += weight(weights, i) * func(y[i]);
 		}
 		return sum;
 	}
 
 	template <typename IteratorType, typename F>
-	double reduceImpl(const size_t index, F func) {
+	double reduceImpl(const size_t index, F func, const RealVector& weights) {
 	    double sum = 0.0;
 	    IteratorType it(*this, index);
 	    for (; it; ++it) {
-	        sum += func(it.value());
+	        sum += weight(weights, it.index()) * func(it.value());
 	    }
 	    return sum;
 	}
 
 	template <typename IteratorType, typename F>
-	double innerProductWithOutcomeImpl(const size_t index, F func) {
+	double innerProductWithOutcomeImpl(const size_t index, F func, const RealVector& weights) {
 		double sum = 0.0;
 		IteratorType it(*this, index);
 		for (; it; ++it) {
-			sum += func(y[it.index()], it.value());
+			sum += weight(weights, it.index()) * func(y[it.index()], it.value());
 		}
 		return sum;
 	}
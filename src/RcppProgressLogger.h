@@ -42,7 +42,7 @@ public:
     
     void yield() { 
     	if (!concurrent) {
-	        R_CheckUserInterrupt();
+	        Rcpp::checkUserInterrupt(); // Throws, so destructors run
 	    }
     }
     
@@ -56,6 +56,7 @@
 
 // #include "tclap/CmdLine.h"
 #include "utils/RZeroIn.h"
+#include "utils/NewtonZeroIn.h"
 
 //#include <R.h>
 
@@ -229,15 +230,37 @@ struct OptimizationProfile {
 	OptimizationProfile(CyclicCoordinateDescent& _ccd, CCDArguments& _arguments, int _index, double _max,
 			double _threshold = 1.920729, bool _includePenalty = false) :
 			ccd(_ccd), arguments(_arguments), index(_index), max(_max), threshold(_threshold),
-			nEvals(0), includePenalty(_includePenalty) {
+			nEvals(0), includePenalty(_includePenalty), derivative(NAN),
+			hasDerivative(getHasDerivative()), start(nullptr), startX(NAN), lastX(NAN) {
 	}
 
 	int getEvaluations() {
 		return nEvals;
 	}
 
+	// Warm-start each evaluation from the mode or from the last evaluated point, whichever is
+	// closer.  The last point is the CCD's own state, so no copies are kept and only the
+	// coordinates that moved are set back to the mode.
+	void setStartingPoint(double x, const std::vector<double>& beta) {
+		startX = x;
+		start = &beta;
+	}
+
 	double objective(double x) {
 		++nEvals;
+		if (start != nullptr) {
+			if (nEvals == 1) {
+				ccd.setBeta(*start); // State left by other bounds is unknown
+			} else if (std::abs(startX - x) < std::abs(lastX - x)) {
+				for (int j = 0; j < ccd.getBetaSize(); ++j) {
+					const double value = (*start)[j];
+					if (j != index && ccd.getBeta(j) != value) {
+						ccd.setBeta(j, value);
+					}
+				}
+			}
+			lastX = x;
+		}
 		ccd.setBeta(index, x);
 		ccd.setFixedBeta(index, true);
 		ccd.update(arguments.modeFinding);
@@ -246,6 +269,7 @@ struct OptimizationProfile {
 		if (includePenalty) {
 			y += ccd.getLogPrior();
 		}
+		derivative = hasDerivative ? ccd.getLogLikelihoodGradient(index) : NAN;
 		return y;
 	}
 
@@ -253,11 +277,38 @@ struct OptimizationProfile {
 		return threshold;
 	}
 
+	// Derivative of objective() at the last evaluated point
+	bool getDerivative(double& value) {
+		value = derivative;
+		return !std::isnan(derivative);
+	}
+
+	// Envelope theorem: d/dx of the profile is the gradient in coordinate 'index' of what
+	// the other coordinates maximize.  They maximize the penalized log-likelihood, so the
+	// log-likelihood gradient is exact only if 'index' carries no penalty (includePenalty) or
+	// no other free coordinate does (!includePenalty); otherwise only bisection is valid.
+	bool getHasDerivative() {
+		if (includePenalty) {
+			return !ccd.getIsRegularized(index);
+		}
+		for (int j = 0; j < ccd.getBetaSize(); ++j) {
+			if (j != index && ccd.getIsRegularized(j) && !ccd.getFixedBeta(j)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
 	int index;
 	double max;
 	double threshold;
 	int nEvals;
 	bool includePenalty;
+	double derivative;
+	bool hasDerivative;
+	const std::vector<double>* start;
+	double startX;
+	double lastX;
 };
 
 double CcdInterface::profileModel(CyclicCoordinateDescent *ccd, ModelData *modelData,
@@ -309,9 +360,17 @@ double CcdInterface::profileModel(CyclicCoordinateDescent *ccd, ModelData *model
 		}
 	}
 
+	// Seed each search with the Wald half-width from the curvature at the mode
+	std::vector<double> seeds(indices.size());
+	for (size_t id = 0; id < indices.size(); ++id) {
+		const double hessian = ccd->getHessianDiagonal(indices[id]);
+		seeds[id] = (hessian > 0.0) ? std::sqrt(2.0 * threshold / hessian) : NAN;
+	}
+
 	// Parallelize across columns and lower/upper bound
 	int nThreads = (inThreads == -1) ?
 	    bsccs::thread::hardware_concurrency() : inThreads;
+	nThreads = std::max(1, std::min(nThreads, static_cast<int>(bounds.size())));
 
 	std::ostringstream stream2;
 	stream2 << "Using " << nThreads << " thread(s)";
@@ -331,7 +390,7 @@ double CcdInterface::profileModel(CyclicCoordinateDescent *ccd, ModelData *model
 	std::vector<int> upperCnts(indices.size());
 
 	auto getBound = [this,
-	            &x0s,
+	            &x0s, &seeds,
 	            &indices, &lowerPts, &upperPts,
                 &lowerCnts, &upperCnts, includePenalty, mode, threshold
             ](const BoundType bound, CyclicCoordinateDescent* ccd) {
@@ -343,16 +402,12 @@ double CcdInterface::profileModel(CyclicCoordinateDescent *ccd, ModelData *model
 
 	    // Bound edge
 	    OptimizationProfile eval(*ccd, arguments, index, mode, threshold, includePenalty);
-	    RZeroIn<OptimizationProfile> zeroIn(eval, 1E-3);
+	    eval.setStartingPoint(x0, x0s); // Each bound starts from the mode, not the last global state
+	    NewtonZeroIn<OptimizationProfile> zeroIn(eval, 1E-3);
 
 	    double obj0 = eval.getMaximum();
 
-	    //		std::cout << "BEGIN UP bracket" << std::endl;
-	    RZeroIn<OptimizationProfile>::Coordinate bracket =
-	        zeroIn.bracketSignChange(x0, obj0, direction);
-	     //		std::cout << "END UP bracket " << bracket.first << " " << bracket.second << std::endl;
-
-	    double pt = std::isnan(bracket.second) ? NAN : zeroIn.getRoot(x0, bracket.first, obj0, bracket.second);
+	    double pt = zeroIn.getRoot(x0, obj0, direction, seeds[id]);
 
 	    if (direction == 1.0) {
 	        upperPts[id] = pt;
@@ -386,9 +441,11 @@ double CcdInterface::profileModel(CyclicCoordinateDescent *ccd, ModelData *model
         };
 
         // Run all tasks in parallel
+        ccd->setUsePager(false); // Concurrent fits cannot share the pager
         ccd->getProgressLogger().setConcurrent(true);
         ccd->getErrorHandler().setConcurrent(true);
         scheduler.execute(oneTask);
+        ccd->setUsePager(true);
         ccd->getProgressLogger().setConcurrent(false);
         ccd->getErrorHandler().setConcurrent(false);
         ccd->getProgressLogger().flush();
@@ -430,9 +487,7 @@ double CcdInterface::profileModel(CyclicCoordinateDescent *ccd, ModelData *model
 		// Reset to mode
 		if (indices.size() > 0) {
 		    // Reset
-		    for (int j = 0; j < J; ++j) {
-		        ccd->setBeta(j, x0s[j]);
-		    }
+		    ccd->setBeta(x0s);
 		    // DEBUG, TODO Remove?
 // 		    double testMode = ccd->getLogLikelihood();
 // 		    std::ostringstream stream;
@@ -571,6 +626,9 @@ double CcdInterface::fitModel(CyclicCoordinateDescent *ccd) {
 		logger->writeLine(stream);
 	}
 
+	ccd->setThreads((arguments.threads == -1) ?
+		bsccs::thread::hardware_concurrency() : arguments.threads);
+
 	struct timeval time1, time2;
 	gettimeofday(&time1, NULL);
 
@@ -610,8 +668,12 @@ double CcdInterface::runBoostrap(
 	auto selectorType = getDefaultSelectorTypeOrOverride(
 		arguments.crossValidation.selectorType, modelData->getModelType());
 
-	BootstrapSelector selector(arguments.replicates, modelData->getPidVectorSTL(),
+	BootstrapSelector selector(arguments.replicates, modelData->getInputPidVectorSTL(),
 			selectorType, arguments.seed, logger, error);
+	if (!modelData->getInputRows().empty()) { // Replicates draw the caller's rows
+		selector.setInputRows(modelData->getInputRows(), modelData->getNumberOfRows(),
+				modelData->getHasSummedRows());
+	}
 	BootstrapDriver driver(arguments.replicates, modelData, logger, error);
 
 	driver.drive(*ccd, selector, arguments);
@@ -645,8 +707,12 @@ double CcdInterface::runCrossValidation(CyclicCoordinateDescent *ccd, ModelData
 	auto selectorType = getDefaultSelectorTypeOrOverride(
 		arguments.crossValidation.selectorType, modelData->getModelType());
 
-	CrossValidationSelector selector(arguments.crossValidation.fold, modelData->getPidVectorSTL(),
+	CrossValidationSelector selector(arguments.crossValidation.fold, modelData->getInputPidVectorSTL(),
 			selectorType, arguments.seed, logger, error); // TODO ERROR HERE!  NOT ALL MODELS ARE SUBJECT
+	if (!modelData->getInputRows().empty()) { // Folds split the caller's rows
+		selector.setInputRows(modelData->getInputRows(), modelData->getNumberOfRows(),
+				modelData->getHasSummedRows());
+	}
 
 	AbstractCrossValidationDriver* driver;
 	if (arguments.crossValidation.useAutoSearchCV) {
@@ -0,0 +1,209 @@
+/*
+ * ColumnPager.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: msuchard
+ */
+
+#ifndef COLUMNPAGER_H_
+#define COLUMNPAGER_H_
+
+#include <vector>
+#include <list>
+#include <cstddef>
+
+#include "CompressedDataMatrix.h"
+#include "io/MappedFile.h"
+
+namespace bsccs {
+
+/**
+ * Bounds the resident memory of file-backed columns (see ModelDataFile) during coordinate
+ * descent.  Each sweep visits the non-fixed columns in index order; the pager asks the kernel to
+ * read the next few ahead, keeps visited columns in least-recently-used order and pages the
+ * oldest back out once their total exceeds the budget.  Fixed columns, e.g. those outside the
+ * active set of the KKT swindle, are paged out at the start of each sweep.  The mapping is
+ * read-only, so paging out just drops clean pages that are re-read from the file on the next
+ * access, with or without swap.  The column being read and the prefetch window stay resident even
+ * if they alone exceed the budget.  The pager follows a single fit and is not thread-safe;
+ * concurrent fits on the same data (e.g. threaded cross-validation) run without it.
+ */
+class ColumnPager {
+public:
+
+	static const size_t DefaultPrefetchDepth = 4;
+
+	ColumnPager(const CompressedDataMatrix& matrix, size_t budget,
+			size_t prefetchDepth = DefaultPrefetchDepth) :
+		matrix(matrix), budget(budget), prefetchDepth(prefetchDepth), residentBytes(0),
+		nPrefetches(0), nEvictions(0) { }
+
+	size_t getBudget() const { return budget; }
+
+	size_t getResidentBytes() const { return residentBytes; }
+
+	size_t getNumberOfPrefetches() const { return nPrefetches; }
+
+	size_t getNumberOfEvictions() const { return nEvictions; }
+
+	// Starts a sweep over all columns j with !fixed[j]
+	void beginSweep(const std::vector<bool>& fixed) {
+		refresh();
+
+		order.clear();
+		rank.assign(extents.size(), -1);
+		for (size_t j = 0; j < extents.size(); ++j) {
+			const size_t owner = owners[j];
+			if (!fixed[j] && extents[owner].bytes > 0 && rank[owner] < 0) {
+				rank[owner] = order.size();
+				order.push_back(owner);
+			}
+		}
+
+		for (size_t j = 0; j < extents.size(); ++j) {
+			if (resident[j] && rank[j] < 0) {
+				evict(j); // Cold
+			}
+		}
+
+		for (size_t k = 0; k < prefetchDepth && k < order.size(); ++k) {
+			prefetch(order[k]);
+		}
+	}
+
+	// Column j is about to be read
+	void visit(size_t j) {
+		if (j >= extents.size()) {
+			return; // Added after the last refresh
+		}
+		const size_t owner = owners[j];
+		if (extents[owner].bytes == 0) {
+			return;
+		}
+		makeResident(owner);
+
+		const int k = rank[owner];
+		if (k >= 0 && prefetchDepth > 0) {
+			prefetch(order[(k + prefetchDepth) % order.size()]); // Wraps to warm the next sweep
+		}
+		enforceBudget(owner);
+	}
+
+private:
+
+	struct Extent {
+		const void* indices;
+		size_t indexBytes;
+		const void* values;
+		size_t valueBytes;
+		size_t bytes;
+
+		bool operator==(const Extent& rhs) const {
+			return indices == rhs.indices && indexBytes == rhs.indexBytes &&
+				values == rhs.values && valueBytes == rhs.valueBytes;
+		}
+	};
+
+	// Columns may have been converted, unpacked, shared or reordered since the last sweep
+	void refresh() {
+		const size_t nColumns = matrix.getNumberOfColumns();
+		bool changed = (nColumns != extents.size());
+		if (resident.size() > nColumns) {
+			for (size_t j = nColumns; j < resident.size(); ++j) {
+				forget(j);
+			}
+		}
+		extents.resize(nColumns);
+		resident.resize(nColumns, false);
+		positions.resize(nColumns);
+
+		for (size_t j = 0; j < nColumns; ++j) {
+			Extent extent = { nullptr, 0, nullptr, 0, 0 };
+			const CompressedDataColumn& column = matrix.getColumn(j);
+			if (column.getIsFileBacked()) {
+				const IntView indices = column.getColumnsView();
+				const RealView values = column.getDataView();
+				extent.indices = indices.data();
+				extent.indexBytes = indices.size() * sizeof(int);
+				extent.values = values.data();
+				extent.valueBytes = values.size() * sizeof(real);
+				extent.bytes = extent.indexBytes + extent.valueBytes;
+			}
+			if (!(extent == extents[j])) {
+				forget(j);
+				extents[j] = extent;
+				changed = true;
+			}
+		}
+
+		// Sharing storage moves a column's extent, so aliases only need finding after a change
+		if (changed) {
+			const std::vector<int> aliases = matrix.findStorageAliases();
+			owners.assign(aliases.begin(), aliases.end());
+		}
+	}
+
+	void prefetch(size_t j) {
+		if (!resident[j]) {
+			const Extent& extent = extents[j];
+			MappedFile::advise(extent.indices, extent.indexBytes, MappedFile::WILL_NEED);
+			MappedFile::advise(extent.values, extent.valueBytes, MappedFile::WILL_NEED);
+			++nPrefetches;
+		}
+		makeResident(j);
+	}
+
+	void makeResident(size_t j) {
+		if (resident[j]) {
+			lru.splice(lru.begin(), lru, positions[j]);
+		} else {
+			lru.push_front(j);
+			positions[j] = lru.begin();
+			resident[j] = true;
+			residentBytes += extents[j].bytes;
+		}
+	}
+
+	void enforceBudget(size_t current) {
+		while (residentBytes > budget && !lru.empty() && lru.back() != current) {
+			evict(lru.back());
+		}
+	}
+
+	void evict(size_t j) {
+		const Extent& extent = extents[j];
+		MappedFile::advise(extent.indices, extent.indexBytes, MappedFile::PAGE_OUT);
+		MappedFile::advise(extent.values, extent.valueBytes, MappedFile::PAGE_OUT);
+		++nEvictions;
+		forget(j);
+	}
+
+	void forget(size_t j) {
+		if (resident[j]) {
+			lru.erase(positions[j]);
+			resident[j] = false;
+			residentBytes -= extents[j].bytes;
+		}
+	}
+
+	const CompressedDataMatrix& matrix;
+	size_t budget;
+	size_t prefetchDepth;
+
+	std::vector<Extent> extents;
+	std::vector<size_t> owners; // Column whose storage each column shares
+	std::vector<bool> resident;
+	std::vector<std::list<size_t>::iterator> positions;
+	std::list<size_t> lru; // Most recent first
+	size_t residentBytes;
+
+	std::vector<size_t> order; // Visit order of the current sweep
+	std::vector<int> rank;
+
+	size_t nPrefetches;
+	size_t nEvictions;
+};
+
+} // namespace
+
+#endif /* COLUMNPAGER_H_ */
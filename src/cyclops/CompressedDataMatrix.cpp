@@ -11,12 +11,17 @@
 #include <numeric>
 #include <vector>
 #include <stdexcept>
+#include <unordered_map>
+#include <functional>
 
 #include "CompressedDataMatrix.h"
+#include "FormatCostModel.h"
+#include "ColumnPager.h"
 
 namespace bsccs {
 
-CompressedDataMatrix::CompressedDataMatrix() : nRows(0), nCols(0), nEntries(0) {
+CompressedDataMatrix::CompressedDataMatrix() : nRows(0), nCols(0), nEntries(0),
+		indexedColumns(0), labelChanges(0), indexedLabelChanges(0) {
 	// Do nothing
 }
 
@@ -43,24 +48,24 @@ real CompressedDataMatrix::sumColumn(int column) {
 	return sum;
 }
 
-struct DrugIDComparator {
-	IdType id;
-	DrugIDComparator(IdType i) : id(i) { }
-	bool operator()(const CompressedDataColumn::Ptr& column) {
-		return column->getNumericalLabel() == id;
-	}
-};
-
 int CompressedDataMatrix::getColumnIndexByName(IdType name) const {
+	std::lock_guard<mutex> lock(idIndexGuard);
 
-	DrugIDComparator cmp(name);
-	auto found = std::find_if(
-			allColumns.begin(), allColumns.end(), cmp);
-	if (found != allColumns.end()) {
-		return std::distance(allColumns.begin(), found);
-	} else {
-		return -1;
+	if (labelChanges != indexedLabelChanges || indexedColumns > allColumns.size()) {
+		invalidateIdIndex();
+	}
+	indexedLabelChanges = labelChanges;
+
+	if (indexedColumns < allColumns.size()) { // Add columns pushed back since the last lookup
+		idIndex.reserve(allColumns.size());
+		for (; indexedColumns < allColumns.size(); ++indexedColumns) {
+			CompressedDataColumn& column = *allColumns[indexedColumns];
+			idIndex.insert(column.getNumericalLabel(), indexedColumns);
+			column.indexed = true;
+		}
 	}
+
+	return idIndex.find(name);
 }
 
 // void CompressedDataMatrix::printColumn(int column) {
@@ -122,16 +127,16 @@ int* CompressedDataMatrix::getCompressedColumnVector(int column) const {
 	return allColumns[column]->getColumns();
 }
 
-std::vector<int>& CompressedDataMatrix::getCompressedColumnVectorSTL(int column) const {
-	return allColumns[column]->getColumnsVector();
+IntView CompressedDataMatrix::getCompressedColumnVectorSTL(int column) const {
+	return allColumns[column]->getColumnsView();
 }
 
 real* CompressedDataMatrix::getDataVector(int column) const {
 	return allColumns[column]->getData();
 }
 
-std::vector<real>& CompressedDataMatrix::getDataVectorSTL(int column) const {
-	return allColumns[column]->getDataVector();
+RealView CompressedDataMatrix::getDataVectorSTL(int column) const {
+	return allColumns[column]->getDataView();
 }
 
 
@@ -142,20 +147,20 @@ FormatType CompressedDataMatrix::getFormatType(int column) const {
 void CompressedDataColumn::fill(RealVector& values, int nRows) {
 	values.resize(nRows);
 	if (formatType == DENSE) {
-			values.assign(data->begin(), data->end());
+			const RealView view = getDataView();
+			values.assign(view.begin(), view.end());
 		} else {
 			bool isSparse = formatType == SPARSE;
 			values.assign(nRows, 0.0);
-			int* indicators = getColumns();
-			size_t n = getNumberOfEntries();
-			for (size_t i = 0; i < n; ++i) {
-				const int k = indicators[i];
+			size_t i = 0;
+			forEachIndex([this, &values, &i, isSparse](int k) {
 				if (isSparse) {
-					values[k] = data->at(i);
+					values[k] = getData()[i];
 				} else {
 					values[k] = 1.0;
 				}
-			}
+				++i;
+			});
 		}
 }
 
@@ -193,15 +198,16 @@ CompressedDataMatrix* CompressedDataMatrix::transpose() {
 	for (size_t i = 0; i < matTranspose->nRows; i++) {
 		FormatType thisFormatType = this->allColumns[i]->getFormatType();
 		if (thisFormatType == INDICATOR || thisFormatType == SPARSE) {
-			int rows = this->getNumberOfEntries(i);
-			for (int j = 0; j < rows; j++) {
+			int j = 0;
+			this->allColumns[i]->forEachIndex([this, matTranspose, thisFormatType, i, &j](int row) {
 				if (thisFormatType == SPARSE)
-					matTranspose->allColumns[this->getCompressedColumnVector(i)[j]]->add_data(
+					matTranspose->allColumns[row]->add_data(
 							i, this->getDataVector(i)[j]);
 				else
-					matTranspose->allColumns[this->getCompressedColumnVector(i)[j]]->add_data(
+					matTranspose->allColumns[row]->add_data(
 							i, 1.0);
-			}
+				++j;
+			});
 		} else {
 			for (size_t j = 0; j < nRows; j++) {
 				matTranspose->getColumn(j).add_data(i,
@@ -230,15 +236,11 @@ void CompressedDataMatrix::getDataRow(int row, real* x) const {
 			x[j] = this->getDataVector(j)[row];
 		else{
 			x[j] = 0.0;
-			int* col = this->getCompressedColumnVector(j);
-			for(size_t i = 0; i < this->allColumns[j]->getNumberOfEntries(); i++){
-				if(col[i] == row){
+			this->allColumns[j]->forEachIndex([row, x, j](int index) {
+				if (index == row) {
 					x[j] = 1.0;
-					break;
 				}
-				else if(col[i] > row)
-					break;
-			}
+			});
 		}
 	}
 }
@@ -266,7 +268,8 @@ real CompressedDataColumn::squaredSumColumn(size_t n) const {
 	} else if (formatType == INTERCEPT) {
 	    return static_cast<real>(n);
 	} else {
-		return std::inner_product( data->begin(), data->end(), data->begin(), static_cast<real>(0.0));
+		const RealView view = getDataView();
+		return std::inner_product(view.begin(), view.end(), view.begin(), static_cast<real>(0.0));
 	}
 }
 
@@ -274,6 +277,9 @@ void CompressedDataColumn::convertColumnToSparse(void) {
 	if (formatType == SPARSE) {
 		return;
 	}
+	detach();
+	unpack();
+	decodeIndices();
 	if (formatType == DENSE) {
 // 		fprintf(stderr, "Format not yet support.\n");
 // 		exit(-1);
@@ -294,6 +300,9 @@ void CompressedDataColumn::convertColumnToDense(int nRows) {
 	if (formatType == DENSE) {
 		return;
 	}
+	detach();
+	unpack();
+	decodeIndices();
 
 //	real_vector* oldData = data;
     RealVectorPtr oldData = data;
@@ -324,6 +333,9 @@ void CompressedDataColumn::convertColumnToDense(int nRows) {
 
 // TODO Fix massive copying
 void CompressedDataColumn::addToColumnVector(IntVector addEntries){
+	detach();
+	unpack();
+	decodeIndices();
 	int lastit = 0;
 
 	for(int i = 0; i < (int)addEntries.size(); i++)
@@ -340,6 +352,9 @@ void CompressedDataColumn::addToColumnVector(IntVector addEntries){
 }
 
 void CompressedDataColumn::removeFromColumnVector(IntVector removeEntries){
+	detach();
+	unpack();
+	decodeIndices();
 	int lastit = 0;
 	IntVector::iterator it1 = removeEntries.begin();
 	IntVector::iterator it2 = columns->begin();
@@ -364,17 +379,508 @@ void CompressedDataColumn::printMatrixMarketFormat(std::ostream& stream, const i
             stream << (row + 1) << " " << (columnNumber + 1) << " " << value << "\n";
         }
     } else if (formatType == SPARSE || formatType == INDICATOR) {
-        const auto columns = getColumnsVector();
-
-        for (int i = 0; i < columns.size(); ++i) {
+        int i = 0;
+        forEachIndex([this, &stream, &i, columnNumber](int row) {
             double value = (formatType == SPARSE) ? getDataVector()[i] : 1.0;
-            stream << (columns[i] + 1) << " " << (columnNumber + 1) <<  " " << value << "\n";
-        }
+            stream << (row + 1) << " " << (columnNumber + 1) <<  " " << value << "\n";
+            ++i;
+        });
     } else {
         throw new std::invalid_argument("Unknon type");
     }
 }
 
+void CompressedDataColumn::pack(ColumnArenaPtr columnArena) {
+	if (arena) {
+		return;
+	}
+
+	packedHasColumns = static_cast<bool>(columns);
+	packedHasData = static_cast<bool>(data);
+
+	packedColumnsLength = packedHasColumns ? columns->size() : 0;
+	packedDataLength = packedHasData ? data->size() : 0;
+
+	if (columnArena->indices.size() + packedColumnsLength > columnArena->indices.capacity() ||
+			columnArena->values.size() + packedDataLength > columnArena->values.capacity()) {
+		throw new std::length_error("Insufficient arena capacity");
+	}
+
+	packedColumns = columnArena->indices.data() + columnArena->indices.size();
+	packedData = columnArena->values.data() + columnArena->values.size();
+
+	if (packedHasColumns) {
+		columnArena->indices.insert(columnArena->indices.end(), columns->begin(), columns->end());
+	}
+	if (packedHasData) {
+		columnArena->values.insert(columnArena->values.end(), data->begin(), data->end());
+	}
+
+	columns.reset();
+	data.reset();
+	arena = columnArena;
+}
+
+void CompressedDataColumn::unpack() {
+	if (!arena) {
+		return;
+	}
+
+	if (packedHasColumns) {
+		columns = make_shared<IntVector>(packedColumns, packedColumns + packedColumnsLength);
+	}
+	if (packedHasData) {
+		data = make_shared<RealVector>(packedData, packedData + packedDataLength);
+	}
+
+	arena.reset();
+	packedColumns = nullptr;
+	packedData = nullptr;
+	packedColumnsLength = packedDataLength = 0;
+}
+
+void CompressedDataColumn::attach(ColumnArenaPtr columnArena, int* indices, size_t nIndices,
+		real* values, size_t nValues) {
+	columns.reset();
+	data.reset();
+	encoded.reset();
+
+	packedHasColumns = (indices != nullptr);
+	packedHasData = (values != nullptr);
+	packedColumns = indices;
+	packedData = values;
+	packedColumnsLength = packedHasColumns ? nIndices : 0;
+	packedDataLength = packedHasData ? nValues : 0;
+	arena = columnArena;
+}
+
+bool CompressedDataColumn::encodeIndices(IndexEncoding encoding) {
+	if (formatType != INDICATOR) {
+		return false;
+	}
+	if (encoding == getIndexEncoding()) {
+		return true;
+	}
+	decodeIndices();
+	if (encoding != PLAIN_INDICES) {
+		unpack();
+		encoded = make_shared<EncodedColumn>(encoding, columns->begin(), columns->end());
+		columns.reset();
+	}
+	return true;
+}
+
+void CompressedDataColumn::decodeIndices() {
+	if (!encoded) {
+		return;
+	}
+	unpack();
+	columns = make_shared<IntVector>(encoded->decode());
+	encoded.reset();
+}
+
+void CompressedDataColumn::getNonZeros(IntVector& rows, RealVector& values, size_t nRows) const {
+	rows.clear();
+	values.clear();
+	if (formatType == DENSE) {
+		const RealView view = getDataView();
+		for (size_t i = 0; i < view.size(); ++i) {
+			if (view[i] != static_cast<real>(0)) {
+				rows.push_back(i);
+				values.push_back(view[i]);
+			}
+		}
+	} else if (formatType == SPARSE) {
+		const IntView indices = getColumnsView();
+		const RealView view = getDataView();
+		for (size_t i = 0; i < indices.size(); ++i) {
+			if (view[i] != static_cast<real>(0)) {
+				rows.push_back(indices[i]);
+				values.push_back(view[i]);
+			}
+		}
+	} else if (formatType == INDICATOR) {
+		rows.reserve(getNumberOfEntries());
+		forEachIndex([&rows](int row) {
+			rows.push_back(row);
+		});
+		values.assign(rows.size(), static_cast<real>(1));
+	} else if (formatType == INTERCEPT) {
+		rows.resize(nRows);
+		std::iota(rows.begin(), rows.end(), 0);
+		values.assign(nRows, static_cast<real>(1));
+	} else {
+		throw new std::invalid_argument("Unknown type");
+	}
+}
+
+void CompressedDataColumn::convertColumn(FormatType newType, size_t nRows) {
+	if (newType == formatType) {
+		return;
+	}
+
+	IntVectorPtr rows = make_shared<IntVector>();
+	RealVectorPtr values = make_shared<RealVector>();
+	getNonZeros(*rows, *values, nRows);
+
+	detach();
+	unpack();
+	encoded.reset();
+
+	if (newType == DENSE) {
+		data = make_shared<RealVector>(nRows, static_cast<real>(0));
+		for (size_t i = 0; i < rows->size(); ++i) {
+			(*data)[(*rows)[i]] = (*values)[i];
+		}
+		columns = NULL;
+	} else if (newType == SPARSE) {
+		columns = rows;
+		data = values;
+	} else if (newType == INDICATOR) {
+		columns = rows;
+		data = NULL;
+	} else if (newType == INTERCEPT) {
+		columns = NULL;
+		data = NULL;
+	} else {
+		throw new std::invalid_argument("Unknown type");
+	}
+	formatType = newType;
+}
+
+void CompressedDataColumn::permuteRows(const IntVector& order, const IntVector& position) {
+	if (formatType == INTERCEPT) {
+		return;
+	}
+	detach();
+	unpack();
+	decodeIndices();
+
+	if (formatType == DENSE) {
+		RealVector& values = *data;
+		values.resize(order.size(), static_cast<real>(0)); // Trailing zeros may be implicit
+		RealVector permuted(order.size());
+		for (size_t i = 0; i < order.size(); ++i) {
+			permuted[i] = values[order[i]];
+		}
+		values.swap(permuted);
+		return;
+	}
+
+	IntVector& rows = *columns;
+	if (formatType == INDICATOR) {
+		for (auto& row : rows) {
+			row = position[row];
+		}
+		std::sort(rows.begin(), rows.end());
+		return;
+	}
+
+	RealVector& values = *data;
+	std::vector<std::pair<int,real> > entries(rows.size());
+	for (size_t k = 0; k < rows.size(); ++k) {
+		entries[k] = std::make_pair(position[rows[k]], values[k]);
+	}
+	std::sort(entries.begin(), entries.end(), [](const std::pair<int,real>& lhs,
+			const std::pair<int,real>& rhs) {
+		return lhs.first < rhs.first;
+	});
+	for (size_t k = 0; k < rows.size(); ++k) {
+		rows[k] = entries[k].first;
+		values[k] = entries[k].second;
+	}
+}
+
+void CompressedDataColumn::selectRows(const IntVector& kept, const IntVector& position) {
+	if (formatType == INTERCEPT) {
+		return;
+	}
+	detach();
+	unpack();
+	decodeIndices();
+
+	if (formatType == DENSE) {
+		RealVector& values = *data;
+		values.resize(position.size(), static_cast<real>(0)); // Trailing zeros may be implicit
+		for (size_t k = 0; k < kept.size(); ++k) {
+			values[k] = values[kept[k]]; // kept[k] >= k
+		}
+		values.resize(kept.size());
+		return;
+	}
+
+	IntVector& rows = *columns;
+	const bool hasValues = formatType == SPARSE;
+	size_t nKept = 0;
+	for (size_t k = 0; k < rows.size(); ++k) {
+		const int row = rows[k];
+		if (kept[position[row]] == row) {
+			rows[nKept] = position[row];
+			if (hasValues) {
+				(*data)[nKept] = (*data)[k];
+			}
+			++nKept;
+		}
+	}
+	rows.resize(nKept);
+	if (hasValues) {
+		data->resize(nKept);
+	}
+}
+
+void CompressedDataColumn::shareStorage(CompressedDataColumn& other) {
+	columns = other.columns;
+	data = other.data;
+	encoded = other.encoded;
+	arena = other.arena;
+	packedColumns = other.packedColumns;
+	packedData = other.packedData;
+	packedColumnsLength = other.packedColumnsLength;
+	packedDataLength = other.packedDataLength;
+	packedHasColumns = other.packedHasColumns;
+	packedHasData = other.packedHasData;
+	sharedPtrs = other.sharedPtrs = true;
+}
+
+void CompressedDataColumn::detach() {
+	if (!sharedPtrs) {
+		return;
+	}
+	if (arena) {
+		unpack(); // Copies out of the arena
+	} else {
+		if (columns) {
+			columns = make_shared<IntVector>(*columns);
+		}
+		if (data) {
+			data = make_shared<RealVector>(*data);
+		}
+	}
+	// Encoded indices are never modified in place, only replaced
+	sharedPtrs = false;
+}
+
+const void* CompressedDataColumn::getStorageKey() const {
+	if (!sharedPtrs) {
+		return nullptr;
+	}
+	if (encoded) {
+		return encoded.get();
+	}
+	if (arena) {
+		return packedHasColumns ? static_cast<const void*>(packedColumns) :
+			static_cast<const void*>(packedData);
+	}
+	return columns ? static_cast<const void*>(columns.get()) :
+		static_cast<const void*>(data.get());
+}
+
+bool CompressedDataColumn::hasSameContents(const CompressedDataColumn& other) const {
+	if (formatType != other.formatType || getIndexEncoding() != other.getIndexEncoding()) {
+		return false;
+	}
+	if (encoded && !(*encoded == *other.encoded)) {
+		return false;
+	}
+	if (!encoded && (formatType == SPARSE || formatType == INDICATOR)) {
+		const IntView lhs = getColumnsView();
+		const IntView rhs = other.getColumnsView();
+		if (lhs.size() != rhs.size() || !std::equal(lhs.begin(), lhs.end(), rhs.begin())) {
+			return false;
+		}
+	}
+	if (formatType == SPARSE || formatType == DENSE) {
+		const RealView lhs = getDataView();
+		const RealView rhs = other.getDataView();
+		if (lhs.size() != rhs.size() || !std::equal(lhs.begin(), lhs.end(), rhs.begin())) {
+			return false;
+		}
+	}
+	return true;
+}
+
+size_t CompressedDataColumn::hashContents() const {
+	size_t seed = static_cast<size_t>(formatType) * 31 + getIndexEncoding();
+	if (encoded) {
+		seed = seed * 31 + encoded->hash();
+	} else if (formatType == SPARSE || formatType == INDICATOR) {
+		for (auto index : getColumnsView()) {
+			seed = seed * 31 + static_cast<size_t>(index);
+		}
+	}
+	if (formatType == SPARSE || formatType == DENSE) {
+		const std::hash<real> hasher;
+		for (auto value : getDataView()) {
+			seed = seed * 31 + hasher(value);
+		}
+	}
+	return seed;
+}
+
+size_t CompressedDataColumn::getStorageBytes() const {
+	size_t nIndices, nValues;
+	getStorageSize(nIndices, nValues);
+	return nIndices * sizeof(int) + nValues * sizeof(real) + getEncodedStorageSize();
+}
+
+const double CompressedDataMatrix::DefaultBitmapDensity = 0.1;
+
+size_t CompressedDataMatrix::encodeIndicatorColumns(bool compress, double bitmapDensity) {
+	size_t saved = 0;
+	if (!compress) {
+		return saved;
+	}
+	for (auto& column : allColumns) {
+		if (column->getFormatType() == INDICATOR && column->getIndexEncoding() == PLAIN_INDICES) {
+			const size_t n = column->getNumberOfEntries();
+			column->encodeIndices((nRows > 0 && n >= bitmapDensity * nRows) ?
+				BITMAP_INDICES : VARINT_INDICES);
+			const size_t bytes = n * sizeof(int);
+			const size_t encodedBytes = column->getEncodedStorageSize();
+			saved += (bytes > encodedBytes) ? bytes - encodedBytes : 0;
+		}
+	}
+	return saved;
+}
+
+const double FormatCostModel::DefaultMemoryWeight = 1.0;
+const double FormatCostModel::CompactMemoryWeight = 8.0;
+
+const FormatCostModel::Calibration FormatCostModel::DefaultCalibration = {
+	0.7,  // denseRow
+	0.25, // interceptRow
+	1.6,  // sparseEntry
+	1.55, // indicatorEntry
+	1.85, // varintEntry
+	1.3,  // bitmapEntry
+	8.0,  // bitmapWord
+	0.1   // streamByte
+};
+
+FormatSelection CompressedDataMatrix::selectColumnFormats(const FormatCostModel& model,
+		const std::vector<size_t>& fixedColumns, int interceptColumn) {
+	FormatSelection selection;
+	IntVector rows;
+	RealVector values;
+
+	for (size_t index = 0; index < allColumns.size(); ++index) {
+		CompressedDataColumn& column = *allColumns[index];
+		selection.bytesBefore += column.getStorageBytes();
+
+		ColumnFormat format(column.getFormatType(), column.getIndexEncoding());
+		if (std::find(fixedColumns.begin(), fixedColumns.end(), index) == fixedColumns.end()) {
+			column.getNonZeros(rows, values, nRows);
+			const bool isBinary = std::all_of(values.begin(), values.end(), [](real x) {
+				return x == static_cast<real>(1);
+			});
+			const ColumnFormat best = model.chooseFormat(
+				ColumnProfile(nRows, rows.begin(), rows.end(), isBinary),
+				static_cast<int>(index) == interceptColumn);
+
+			if (!(best == format)) {
+				column.convertColumn(best.type, nRows);
+				column.encodeIndices(best.encoding);
+				format = best;
+				++selection.nConverted;
+			}
+		}
+
+		selection.bytesAfter += column.getStorageBytes();
+		++selection.formatCounts[format.getName()];
+	}
+	return selection;
+}
+
+size_t CompressedDataMatrix::shareIdenticalColumns() {
+	std::unordered_map<size_t, std::vector<CompressedDataColumn*>> buckets;
+	size_t nAliases = 0;
+	for (auto& column : allColumns) {
+		if (column->getStorageBytes() == 0) {
+			continue; // Nothing to share
+		}
+		auto& bucket = buckets[column->hashContents()];
+		auto match = std::find_if(bucket.begin(), bucket.end(),
+			[&column](const CompressedDataColumn* candidate) {
+				return column->hasSameContents(*candidate);
+			});
+		if (match != bucket.end()) {
+			column->shareStorage(**match);
+			++nAliases;
+		} else {
+			bucket.push_back(column.get());
+		}
+	}
+	updateStorageAliases();
+	return nAliases;
+}
+
+std::vector<int> CompressedDataMatrix::findStorageAliases() const {
+	std::vector<int> aliases(allColumns.size());
+	std::unordered_map<const void*, int> owners;
+	for (size_t index = 0; index < allColumns.size(); ++index) {
+		aliases[index] = index;
+		const void* key = allColumns[index]->getStorageKey();
+		if (key) {
+			auto owner = owners.find(key);
+			if (owner != owners.end()) {
+				aliases[index] = owner->second;
+			} else {
+				owners[key] = index;
+			}
+		}
+	}
+	return aliases;
+}
+
+void CompressedDataMatrix::setResidentBudget(size_t budgetBytes) {
+	if (budgetBytes > 0) {
+		pager = bsccs::make_shared<ColumnPager>(*this, budgetBytes);
+	} else {
+		pager.reset();
+	}
+}
+
+void CompressedDataMatrix::packColumns() {
+
+	// Columns sharing storage are packed once, then re-aliased
+	const std::vector<int> aliases = findStorageAliases();
+
+	size_t nIndices = 0;
+	size_t nValues = 0;
+	for (size_t index = 0; index < allColumns.size(); ++index) {
+		if (aliases[index] != static_cast<int>(index)) {
+			continue;
+		}
+		auto& column = allColumns[index];
+		column->unpack(); // Repack any columns from a previous arena
+		size_t columnIndices, columnValues;
+		column->getStorageSize(columnIndices, columnValues);
+		nIndices += columnIndices;
+		nValues += columnValues;
+	}
+
+	auto arena = make_shared<ColumnArena>();
+	arena->indices.reserve(nIndices);
+	arena->values.reserve(nValues);
+
+	// Group by format type, so each type forms its own contiguous CSC block
+	const FormatType order[] = { INDICATOR, SPARSE, DENSE, INTERCEPT };
+	for (auto type : order) {
+		for (size_t index = 0; index < allColumns.size(); ++index) {
+			if (allColumns[index]->getFormatType() == type &&
+					aliases[index] == static_cast<int>(index)) {
+				allColumns[index]->pack(arena);
+			}
+		}
+	}
+
+	for (size_t index = 0; index < allColumns.size(); ++index) {
+		if (aliases[index] != static_cast<int>(index)) {
+			allColumns[index]->shareStorage(*allColumns[aliases[index]]);
+		}
+	}
+}
+
 void CompressedDataMatrix::printMatrixMarketFormat(std::ostream& stream) const {
 
     size_t nnz = 0;
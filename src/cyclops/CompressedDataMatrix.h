@@ -19,10 +19,15 @@
 #include <algorithm>
 #include <numeric>
 #include <stdexcept>
+#include <map>
 
 //#define DATA_AOS
 
 #include "Types.h"
+#include "CompressedIndices.h"
+#include "IndicatorBitmap.h"
+#include "HashIndex.h"
+#include "Thread.h"
 
 namespace bsccs {
 
@@ -37,6 +42,124 @@ enum FormatType {
 	DENSE, SPARSE, INDICATOR, INTERCEPT
 };
 
+// Non-owning view of a contiguous range, e.g. a column packed into a ColumnArena
+template <typename T>
+class ArrayView {
+public:
+	ArrayView() : first(nullptr), last(nullptr) { }
+	ArrayView(T* first, size_t length) : first(first), last(first + length) { }
+	template <typename U>
+	ArrayView(std::vector<U>& vec) : first(vec.data()), last(vec.data() + vec.size()) { }
+	template <typename U>
+	ArrayView(const std::vector<U>& vec) : first(vec.data()), last(vec.data() + vec.size()) { }
+
+	T* begin() const { return first; }
+	T* end() const { return last; }
+	T* data() const { return first; }
+	size_t size() const { return last - first; }
+	bool empty() const { return first == last; }
+	T& operator[](size_t i) const { return first[i]; }
+	T& back() const { return *(last - 1); }
+
+private:
+	T* first;
+	T* last;
+};
+
+typedef ArrayView<int> IntView;
+typedef ArrayView<real> RealView;
+
+// Contiguous storage shared by all packed columns of a CompressedDataMatrix
+struct ColumnArena {
+	IntVector indices;
+	RealVector values;
+	bsccs::shared_ptr<void> backing; // Keeps external storage (e.g. a file mapping) alive
+};
+
+typedef bsccs::shared_ptr<ColumnArena> ColumnArenaPtr;
+
+// Storage of the row indices of an INDICATOR column
+enum IndexEncoding {
+	PLAIN_INDICES, VARINT_INDICES, BITMAP_INDICES
+};
+
+// Encoded indices of an INDICATOR column
+struct EncodedColumn {
+	IndexEncoding encoding;
+	CompressedIndices varint;
+	IndicatorBitmap bitmap;
+
+	static const int MaxBlockSize = (CompressedIndices::BlockSize > IndicatorBitmap::BlockSize) ?
+		CompressedIndices::BlockSize : IndicatorBitmap::BlockSize;
+
+	template <typename InputIt>
+	EncodedColumn(IndexEncoding encoding, InputIt begin, InputIt end) : encoding(encoding) {
+		if (encoding == BITMAP_INDICES) {
+			bitmap = IndicatorBitmap(begin, end);
+		} else {
+			varint = CompressedIndices(begin, end);
+		}
+	}
+
+	size_t size() const {
+		return encoding == BITMAP_INDICES ? bitmap.size() : varint.size();
+	}
+
+	size_t getStorageSize() const {
+		return encoding == BITMAP_INDICES ? bitmap.getStorageSize() : varint.getStorageSize();
+	}
+
+	IntVector decode() const {
+		return encoding == BITMAP_INDICES ? bitmap.decode() : varint.decode();
+	}
+
+	size_t getNumberOfBlocks() const {
+		return encoding == BITMAP_INDICES ? bitmap.getNumberOfBlocks() : varint.getNumberOfBlocks();
+	}
+
+	// Decodes one block into out (room for MaxBlockSize entries); returns the number of entries
+	size_t decodeBlock(size_t block, int* out) const {
+		return encoding == BITMAP_INDICES ? bitmap.decodeBlock(block, out) :
+			varint.decodeBlock(block, out);
+	}
+
+	// Calls f(row) for every index, one decoded block at a time
+	template <typename Function>
+	void forEach(Function f) const {
+		int buffer[MaxBlockSize];
+		for (size_t block = 0; block < getNumberOfBlocks(); ++block) {
+			const size_t n = decodeBlock(block, buffer);
+			for (size_t i = 0; i < n; ++i) {
+				f(buffer[i]);
+			}
+		}
+	}
+
+	bool operator==(const EncodedColumn& rhs) const {
+		return encoding == rhs.encoding &&
+			(encoding == BITMAP_INDICES ? bitmap == rhs.bitmap : varint == rhs.varint);
+	}
+
+	size_t hash() const {
+		return encoding == BITMAP_INDICES ? bitmap.hash() : varint.hash();
+	}
+};
+
+typedef bsccs::shared_ptr<EncodedColumn> EncodedColumnPtr;
+
+class FormatCostModel;
+class ColumnPager;
+
+// Outcome of CompressedDataMatrix::selectColumnFormats()
+struct FormatSelection {
+	std::map<std::string, size_t> formatCounts;
+	size_t nConverted;
+	size_t bytesBefore;
+	size_t bytesAfter;
+
+	FormatSelection() : nConverted(0), bytesBefore(0), bytesAfter(0) { }
+};
+
 class CompressedDataColumn {
 public:
 
@@ -46,7 +169,9 @@ public:
 	CompressedDataColumn(IntVectorPtr colIndices, RealVectorPtr colData, FormatType colFormat,
 			std::string colName = "", IdType nName = 0, bool sPtrs = false) :
 		 columns(colIndices), data(colData), formatType(colFormat), stringName(colName),
-		 numericalName(nName), sharedPtrs(sPtrs) {
+		 numericalName(nName), sharedPtrs(sPtrs), labelChanges(nullptr), indexed(false),
+		 packedColumns(nullptr), packedData(nullptr), packedColumnsLength(0), packedDataLength(0),
+		 packedHasColumns(false), packedHasData(false) {
 		// Do nothing
 	}
 
@@ -60,44 +185,72 @@ public:
 //		}
 	}
 
+	// Plain indices only; encoded indices are read with forEachIndex() or block by block
 	int* getColumns() const {
-		return static_cast<int*>(columns->data());
+		if (encoded) {
+			throw new std::logic_error("Raw access to encoded indices");
+		}
+		return arena ? packedColumns : static_cast<int*>(columns->data());
 	}
 
 	real* getData() const {
-		return static_cast<real*>(data->data());
+		return arena ? packedData : static_cast<real*>(data->data());
 	}
 
-	const std::vector<int>& getColumnsVector() const {
-		return *columns;
+	IntView getColumnsView() const {
+		if (encoded) {
+			throw new std::logic_error("Raw access to encoded indices");
+		}
+		return arena ? IntView(packedColumns, packedColumnsLength) : IntView(*columns);
 	}
 
-	const std::vector<real>& getDataVector() const {
-		return *data;
+	RealView getDataView() const {
+		return arena ? RealView(packedData, packedDataLength) : RealView(*data);
+	}
+
+	const IntView getColumnsVector() const {
+		return getColumnsView();
+	}
+
+	const RealView getDataVector() const {
+		return getDataView();
 	}
 
+	// Mutable access; a packed, encoded or shared column is first copied back into its own storage
 	std::vector<int>& getColumnsVector() {
+		detach();
+		unpack();
+		decodeIndices();
 		return *columns;
 	}
 
 	std::vector<real>& getDataVector() {
+		detach();
+		unpack();
 		return *data;
 	}
 
 	std::vector<real> copyData() {
 // 		std::vector copy(std::begin(data), std::end(data));
 // 		return std::move(copy);
-		return std::vector<real>(*data);
+		const RealView view = getDataView();
+		return std::vector<real>(view.begin(), view.end());
 	}
 
 	template <typename Function>
 	void transform(Function f) {
-	    std::transform(data->begin(), data->end(), data->begin(), f);
+		detach();
+		if (getIsFileBacked()) {
+			unpack(); // The mapping is read-only
+		}
+		const RealView view = getDataView(); // In-place, also when packed
+	    std::transform(view.begin(), view.end(), view.begin(), f);
 	}
 
 	template <typename Function, typename ValueType>
 	ValueType accumulate(Function f, ValueType x) {
-	    return std::accumulate(data->begin(), data->end(), x, f);
+		const RealView view = getDataView();
+	    return std::accumulate(view.begin(), view.end(), x, f);
 	}
 
 	FormatType getFormatType() const {
@@ -134,22 +287,132 @@ public:
 	}
 
 	size_t getNumberOfEntries() const {
-		return columns->size();
+		if (encoded) {
+			return encoded->size();
+		}
+		return arena ? packedColumnsLength : columns->size();
 	}
 
 	size_t getDataVectorLength() const {
-		return data->size();
+		return arena ? packedDataLength : data->size();
+	}
+
+	bool getIsPacked() const {
+		return static_cast<bool>(arena);
+	}
+
+	// Packed into external storage, e.g. a mapped ModelDataFile
+	bool getIsFileBacked() const {
+		return arena && arena->backing;
+	}
+
+	void getStorageSize(size_t& nIndices, size_t& nValues) const {
+		if (encoded) {
+			nIndices = 0;
+			nValues = 0;
+		} else if (arena) {
+			nIndices = packedColumnsLength;
+			nValues = packedDataLength;
+		} else {
+			nIndices = columns ? columns->size() : 0;
+			nValues = data ? data->size() : 0;
+		}
+	}
+
+	// Moves storage into the arena (which must already hold enough capacity) and releases own vectors
+	void pack(ColumnArenaPtr columnArena);
+
+	// Copies storage back out of the arena
+	void unpack();
+
+	// Points storage at external memory held by columnArena (e.g. a file mapping); nullptr for absent parts
+	void attach(ColumnArenaPtr columnArena, int* indices, size_t nIndices, real* values, size_t nValues);
+
+	IndexEncoding getIndexEncoding() const {
+		return encoded ? encoded->encoding : PLAIN_INDICES;
 	}
 
+	// Only valid for columns with the matching encoding
+	template <class Encoding>
+	const Encoding& getEncodedIndices() const;
+
+	size_t getEncodedStorageSize() const {
+		return encoded ? encoded->getStorageSize() : 0;
+	}
+
+	// Copy of the decoded indices of an encoded column
+	IntVector getDecodedIndices() const {
+		return encoded->decode();
+	}
+
+	size_t getNumberOfIndexBlocks() const {
+		return encoded->getNumberOfBlocks();
+	}
+
+	// Decodes one block of an encoded column (see EncodedColumn::decodeBlock)
+	size_t decodeIndexBlock(size_t block, int* out) const {
+		return encoded->decodeBlock(block, out);
+	}
+
+	// Calls f(row) for the row of every entry of a SPARSE or INDICATOR column
+	template <typename Function>
+	void forEachIndex(Function f) const {
+		if (encoded) {
+			encoded->forEach(f);
+		} else {
+			const IntView indices = getColumnsView();
+			for (auto index : indices) {
+				f(index);
+			}
+		}
+	}
+
+	/**
+	 * Replaces the indices of an INDICATOR column by a delta/varint (VARINT_INDICES) or bitmap
+	 * (BITMAP_INDICES) encoding.  Kernels and iterators decode blocks on the fly; raw index access
+	 * (getColumns() and views) is only available for plain indices.  Returns false if the column
+	 * cannot be encoded.
+	 */
+	bool encodeIndices(IndexEncoding encoding);
+
+	// Restores plain index storage
+	void decodeIndices();
+
+	/**
+	 * Aliases the storage of other, which must have the same format and contents.  Shared
+	 * storage is copy-on-write: any modification first gives a column its own copy.
+	 */
+	void shareStorage(CompressedDataColumn& other);
+
+	// Gives a column with shared storage its own copy
+	void detach();
+
+	bool getSharesStorage() const {
+		return sharedPtrs;
+	}
+
+	// Identifies shared storage; nullptr if not shared
+	const void* getStorageKey() const;
+
+	bool hasSameContents(const CompressedDataColumn& other) const;
+
+	size_t hashContents() const;
+
 	void add_label(std::string label) {
 		stringName = label;
 	}
 
 	void add_label(IdType label) {
 		numericalName = label;
+		if (indexed && labelChanges) {
+			++*labelChanges; // Owner's id index is stale
+		}
 	}
 
 	bool add_data(int row, real value) {
+		detach();
+		unpack();
+		decodeIndices();
 		if (formatType == DENSE) {
 			//Making sure that we are at the correct row
 			for(int i = data->size(); i < row; i++) {
@@ -185,6 +448,22 @@ public:
 
 	void convertColumnToSparse(void);
 
+	// Copies the rows and values of all non-zero entries
+	void getNonZeros(IntVector& rows, RealVector& values, size_t nRows) const;
+
+	// Converts between any formats; INDICATOR and INTERCEPT require all non-zero values to equal 1
+	void convertColumn(FormatType newType, size_t nRows);
+
+	// Row i becomes row position[i], i.e. row k holds former row order[k]; keeps entries sorted
+	void permuteRows(const IntVector& order, const IntVector& position);
+
+	// Keeps rows kept[k] (increasing) as row k and drops the others, i.e. those with
+	// kept[position[i]] != i; keeps entries sorted
+	void selectRows(const IntVector& kept, const IntVector& position);
+
+	// Bytes held by indices, values and encodings
+	size_t getStorageBytes() const;
+
 	void fill(RealVector& values, int nRows);
 
 	void printColumn(int nRows);
@@ -228,9 +507,36 @@ private:
 	FormatType formatType;
 	mutable std::string stringName;
 	IdType numericalName;
-	bool sharedPtrs; // TODO Actually use shared pointers
+	bool sharedPtrs; // Storage aliased with other columns, see shareStorage()
+
+	// Set by the owning CompressedDataMatrix to keep its id index current
+	size_t* labelChanges;
+	bool indexed;
+	friend class CompressedDataMatrix;
+
+	// When packed, columns and data are released and these point into the shared arena
+	ColumnArenaPtr arena;
+	int* packedColumns;
+	real* packedData;
+	size_t packedColumnsLength;
+	size_t packedDataLength;
+	bool packedHasColumns;
+	bool packedHasData;
+
+	// When encoded, columns is released
+	EncodedColumnPtr encoded;
 };
 
+template <>
+inline const CompressedIndices& CompressedDataColumn::getEncodedIndices<CompressedIndices>() const {
+	return encoded->varint;
+}
+
+template <>
+inline const IndicatorBitmap& CompressedDataColumn::getEncodedIndices<IndicatorBitmap>() const {
+	return encoded->bitmap;
+}
+
 class CompressedDataMatrix {
 
 public:
@@ -252,14 +558,14 @@ public:
 	size_t getNumberOfNonZeroEntries(int column) const;
 
 	int* getCompressedColumnVector(int column) const; // TODO depreciate
-	std::vector<int>& getCompressedColumnVectorSTL(int column) const;
+	IntView getCompressedColumnVectorSTL(int column) const;
 
 	void removeFromColumnVector(int column, IntVector removeEntries) const;
 	void addToColumnVector(int column, IntVector addEntries) const;
 
  	real* getDataVector(int column) const;  // TODO depreciate
 
-	std::vector<real>& getDataVectorSTL(int column) const;
+	RealView getDataVectorSTL(int column) const;
 
 	void getDataRow(int row, real* x) const;
 	CompressedDataMatrix* transpose();
@@ -285,6 +591,7 @@ public:
 	void sortColumns(Comparator cmp) {
 		std::sort(allColumns.begin(), allColumns.end(),
 				cmp);
+		invalidateIdIndex();
 	}
 
 	const CompressedDataColumn& getColumn(size_t column) const {
@@ -295,6 +602,8 @@ public:
 		return *(allColumns[column]);
 	}
 
+	// Index of the first column labeled name, or -1; expected O(1) through a hash index.  Safe to
+	// call from several threads at once, but not while columns are added or relabeled
 	int getColumnIndexByName(IdType name) const;
 
 	// Make deep copy
@@ -385,6 +694,7 @@ public:
                 allColumns.rbegin() + reversePosition,
                 allColumns.rbegin() + reversePosition + 1, // rotate one element
                 allColumns.rend());
+            invalidateIdIndex();
     	}
     }
 
@@ -394,10 +704,78 @@ public:
 		//}
 		allColumns.erase(allColumns.begin() + column);
 		nCols--;
+		invalidateIdIndex();
 	}
 
 	void printMatrixMarketFormat(std::ostream& stream) const;
 
+	/**
+	 * Packs all column storage into one contiguous index array and one value array, grouped
+	 * by format type (CSC per format).  Columns become views; later modifications of a single
+	 * column copy only that column back out.
+	 */
+	void packColumns();
+
+	/**
+	 * Re-encodes INDICATOR columns if compress, else leaves them as they are; call before
+	 * packColumns().  Columns with at least bitmapDensity of rows set become bitmaps, the others
+	 * use delta/varint indices.  Returns the number of bytes saved.
+	 */
+	size_t encodeIndicatorColumns(bool compress, double bitmapDensity = DefaultBitmapDensity);
+
+	/**
+	 * Hashes the contents of all columns and lets columns with identical format, indices and
+	 * values share one copy of storage; call after encoding and before packColumns().  Returns
+	 * the number of columns that became aliases.
+	 */
+	size_t shareIdenticalColumns();
+
+	// For each column, the index of the first column sharing its storage (itself if none)
+	std::vector<int> findStorageAliases() const;
+
+	// Records findStorageAliases() for getStorageAlias(); called by shareIdenticalColumns()
+	// and at finalize, so kernels need not hash the columns again
+	void updateStorageAliases() {
+		storageAliases = findStorageAliases();
+	}
+
+	// First column sharing storage with column index as of the last update (index if none)
+	int getStorageAlias(size_t index) const {
+		return storageAliases.empty() ? static_cast<int>(index) : storageAliases[index];
+	}
+
+	size_t getNumberOfStorageAliases() const {
+		size_t nAliases = 0;
+		for (size_t index = 0; index < storageAliases.size(); ++index) {
+			if (storageAliases[index] != static_cast<int>(index)) {
+				++nAliases;
+			}
+		}
+		return nAliases;
+	}
+
+	static const double DefaultBitmapDensity;
+
+	/**
+	 * Converts each column (except fixedColumns) to the format with the lowest cost under model,
+	 * among DENSE, SPARSE and INDICATOR (plain, varint or bitmap indices), based on its density
+	 * and whether all its values equal 1; call before packColumns().  Only interceptColumn
+	 * (-1 if none) may become INTERCEPT.
+	 */
+	FormatSelection selectColumnFormats(const FormatCostModel& model,
+			const std::vector<size_t>& fixedColumns, int interceptColumn = -1);
+
+	/**
+	 * Bounds the memory held by file-backed columns during mode finding to budgetBytes: columns
+	 * are paged in ahead of each coordinate-descent sweep and the least recently used ones paged
+	 * back out (see ColumnPager).  A budget of 0 disables paging.
+	 */
+	void setResidentBudget(size_t budgetBytes);
+
+	ColumnPager* getPager() const {
+		return pager.get();
+	}
+
 protected:
 
     typedef CompressedDataColumn::Ptr CompressedDataColumnPtr;
@@ -410,7 +788,8 @@ protected:
         make_unique<CompressedDataColumn>
 		(colIndices, colData, colFormat)
 		);
-		nCols++;
+		allColumns.back()->labelChanges = &labelChanges;
+		nCols++; // Indexed lazily on next lookup
 	}
 
 	void replace(int position, IntVectorPtr colIndices, RealVectorPtr colData, FormatType colFormat) {
@@ -419,20 +798,30 @@ protected:
 // 		std::cerr << (colIndices == nullptr ? "null" : "notnull") << std::endl;
 // 		std::cerr << (colData == nullptr ? "null" : "notnull") << std::endl;
 		auto newColumn = make_unique<CompressedDataColumn>(colIndices, colData, colFormat);
+		newColumn->labelChanges = &labelChanges;
 // 		std::cerr << "New at " << newColumn.get() << std::endl;
 	    allColumns[position] = std::move(newColumn);
+	    invalidateIdIndex();
 // 	    std::cerr << "allColumns[" << position << "] = " << allColumns[position].get() << std::endl;
 // 	    std::cerr << "allColumns[0] = " << allColumns[0].get() << std::endl;
 	}
 
 	void insert(DataColumnVector::iterator position, IntVectorPtr colIndices, RealVectorPtr colData, FormatType colFormat) {
-	    allColumns.insert(position,
+	    auto inserted = allColumns.insert(position,
 // 	    new CompressedDataColumn
 // 	    make_shared<CompressedDataColumn>
         make_unique<CompressedDataColumn>
 	    (colIndices, colData, colFormat)
 	    );
+	    (*inserted)->labelChanges = &labelChanges;
 	    nCols++;
+	    invalidateIdIndex();
+	}
+
+	// Positions changed; rebuilt on next lookup
+	void invalidateIdIndex() const {
+		idIndex.clear();
+		indexedColumns = 0;
 	}
 
 	size_t nRows;
@@ -440,6 +829,18 @@ protected:
 	size_t nEntries;
 	DataColumnVector allColumns;
 
+	// Label -> column index for allColumns[0, indexedColumns); extended or rebuilt lazily
+	// by lookups, which hold idIndexGuard
+	mutable mutex idIndexGuard;
+	mutable HashIndex<IdType> idIndex;
+	mutable size_t indexedColumns;
+	size_t labelChanges; // Relabeled indexed columns
+	mutable size_t indexedLabelChanges;
+
+	bsccs::shared_ptr<ColumnPager> pager;
+
+	std::vector<int> storageAliases; // Empty if never updated
+
 private:
 	// Disable copy-constructors and copy-assignment
 	CompressedDataMatrix(const CompressedDataMatrix&);
@@ -0,0 +1,244 @@
+/*
+ * CompressedIndices.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: msuchard
+ */
+
+#ifndef COMPRESSEDINDICES_H_
+#define COMPRESSEDINDICES_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+// SSSE3 decoding is compiled for any x86 target and chosen at run time
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	#define CYCLOPS_SSSE3_DISPATCH
+	#include <tmmintrin.h>
+#endif
+
+namespace bsccs {
+
+/**
+ * Sorted row indices stored as deltas in the StreamVByte layout: one 2-bit length code per
+ * delta packed four to a control byte, followed by the 1-4 data bytes of each delta.  Indices
+ * are split into blocks of BlockSize; each block keeps its first index and byte offset, so blocks
+ * decode independently.  On x86 CPUs with SSSE3 (checked at run time) a control byte decodes
+ * four deltas in one shuffle; otherwise a portable scalar loop is used.
+ */
+class CompressedIndices {
+public:
+
+	static const int BlockSize = 128;
+
+	CompressedIndices() : length(0) { }
+
+	template <typename InputIt>
+	CompressedIndices(InputIt begin, InputIt end) : length(0) {
+		encode(begin, end);
+	}
+
+	size_t size() const { return length; }
+
+	size_t getNumberOfBlocks() const { return blockFirst.size(); }
+
+	size_t getBlockLength(size_t block) const {
+		return (block + 1 < blockFirst.size()) ?
+			BlockSize : length - block * BlockSize;
+	}
+
+	size_t getStorageSize() const {
+		return stream.size() + blockFirst.size() * sizeof(int) +
+			blockOffset.size() * sizeof(size_t);
+	}
+
+	// Decodes one block into out (room for BlockSize entries); returns the number of entries
+	size_t decodeBlock(size_t block, int* out) const {
+		const size_t n = getBlockLength(block);
+		const uint8_t* control = stream.data() + blockOffset[block];
+		const uint8_t* bytes = control + (n + 2) / 4; // n - 1 deltas
+		int previous = blockFirst[block];
+		out[0] = previous;
+		decodeDeltas(control, bytes, n - 1, previous, out + 1);
+		return n;
+	}
+
+	void decode(int* out) const {
+		for (size_t block = 0; block < getNumberOfBlocks(); ++block) {
+			out += decodeBlock(block, out);
+		}
+	}
+
+	// Calls f(index) for each index in order, decoding one block at a time
+	template <typename F>
+	void forEachRow(F f) const {
+		int block[BlockSize];
+		for (size_t b = 0; b < getNumberOfBlocks(); ++b) {
+			const size_t n = decodeBlock(b, block);
+			for (size_t i = 0; i < n; ++i) {
+				f(block[i]);
+			}
+		}
+	}
+
+	std::vector<int> decode() const {
+		std::vector<int> out(length);
+		decode(out.data());
+		return out;
+	}
+
+	bool operator==(const CompressedIndices& rhs) const {
+		return length == rhs.length && blockFirst == rhs.blockFirst && stream == rhs.stream;
+	}
+
+	size_t hash() const {
+		size_t seed = length;
+		for (auto first : blockFirst) {
+			seed = seed * 31 + static_cast<size_t>(first);
+		}
+		for (auto byte : stream) {
+			seed = seed * 31 + byte;
+		}
+		return seed;
+	}
+
+	// Bytes encode() would use for the sorted indices in [begin, end)
+	template <typename InputIt>
+	static size_t getEncodedSize(InputIt begin, InputIt end) {
+		size_t bytes = 16; // Padding
+		size_t position = 0;
+		int previous = 0;
+		for (; begin != end; ++begin, ++position) {
+			const size_t i = position % BlockSize;
+			if (i == 0) {
+				bytes += sizeof(int) + sizeof(size_t);
+			} else {
+				const uint32_t delta = static_cast<uint32_t>(*begin - previous);
+				bytes += (delta < (1u << 8)) ? 1 : (delta < (1u << 16)) ? 2 : (delta < (1u << 24)) ? 3 : 4;
+				if (i % 4 == 1) {
+					++bytes; // Control byte
+				}
+			}
+			previous = *begin;
+		}
+		return bytes;
+	}
+
+private:
+
+	template <typename InputIt>
+	void encode(InputIt begin, InputIt end) {
+		std::vector<uint32_t> deltas;
+		deltas.reserve(BlockSize);
+
+		while (begin != end) {
+			blockFirst.push_back(*begin);
+			blockOffset.push_back(stream.size());
+
+			int previous = *begin;
+			++begin;
+			++length;
+			deltas.clear();
+			for (int i = 1; i < BlockSize && begin != end; ++i, ++begin, ++length) {
+				deltas.push_back(static_cast<uint32_t>(*begin - previous));
+				previous = *begin;
+			}
+
+			const size_t controlStart = stream.size();
+			stream.resize(controlStart + (deltas.size() + 3) / 4, 0);
+			for (size_t i = 0; i < deltas.size(); ++i) {
+				const uint32_t delta = deltas[i];
+				const int code = (delta < (1u << 8)) ? 0 : (delta < (1u << 16)) ? 1 :
+					(delta < (1u << 24)) ? 2 : 3;
+				stream[controlStart + i / 4] |= static_cast<uint8_t>(code << (2 * (i % 4)));
+				for (int b = 0; b <= code; ++b) {
+					stream.push_back(static_cast<uint8_t>(delta >> (8 * b)));
+				}
+			}
+		}
+		stream.resize(stream.size() + 16, 0); // Vector loads may read past the last block
+		stream.shrink_to_fit();
+	}
+
+	static void decodeDeltas(const uint8_t* control, const uint8_t* bytes, size_t count,
+			int previous, int* out) {
+		size_t i = 0;
+#ifdef CYCLOPS_SSSE3_DISPATCH
+		static const bool hasSsse3 = __builtin_cpu_supports("ssse3");
+		if (hasSsse3) {
+			i = decodeQuadsSsse3(control, bytes, count, previous, out);
+			if (i > 0) {
+				previous = out[i - 1];
+			}
+		}
+#endif
+		for (; i < count; ++i) {
+			const int code = (control[i / 4] >> (2 * (i % 4))) & 3;
+			uint32_t delta = bytes[0];
+			for (int b = 1; b <= code; ++b) {
+				delta |= static_cast<uint32_t>(bytes[b]) << (8 * b);
+			}
+			bytes += code + 1;
+			previous += static_cast<int>(delta);
+			out[i] = previous;
+		}
+	}
+
+#ifdef CYCLOPS_SSSE3_DISPATCH
+	// Decodes the leading multiple of four deltas and advances bytes past them
+	__attribute__((target("ssse3")))
+	static size_t decodeQuadsSsse3(const uint8_t* control, const uint8_t*& bytes, size_t count,
+			int previous, int* out) {
+		const Tables& tables = getTables();
+		__m128i prefix = _mm_set1_epi32(previous);
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			const uint8_t key = control[i / 4];
+			__m128i deltas = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+			deltas = _mm_shuffle_epi8(deltas,
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.shuffle[key])));
+			bytes += tables.length[key];
+			deltas = _mm_add_epi32(deltas, _mm_slli_si128(deltas, 4));
+			deltas = _mm_add_epi32(deltas, _mm_slli_si128(deltas, 8));
+			deltas = _mm_add_epi32(deltas, prefix);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), deltas);
+			prefix = _mm_shuffle_epi32(deltas, 0xFF);
+		}
+		return i;
+	}
+
+	struct Tables {
+		uint8_t shuffle[256][16];
+		uint8_t length[256];
+
+		Tables() {
+			for (int key = 0; key < 256; ++key) {
+				uint8_t position = 0;
+				for (int lane = 0; lane < 4; ++lane) {
+					const int bytesInLane = ((key >> (2 * lane)) & 3) + 1;
+					for (int b = 0; b < 4; ++b) {
+						shuffle[key][4 * lane + b] = (b < bytesInLane) ? position++ : 0xFF;
+					}
+				}
+				length[key] = position;
+			}
+		}
+	};
+
+	static const Tables& getTables() {
+		static const Tables tables;
+		return tables;
+	}
+#endif
+
+	size_t length;
+	std::vector<int> blockFirst;
+	std::vector<size_t> blockOffset;
+	std::vector<uint8_t> stream;
+};
+
+} // namespace
+
+#endif /* COMPRESSEDINDICES_H_ */
@@ -19,6 +19,7 @@
 #include "CyclicCoordinateDescent.h"
 #include "Iterators.h"
 #include "Timing.h"
+#include "ColumnPager.h"
 
 namespace bsccs {
 
@@ -49,6 +50,8 @@ CyclicCoordinateDescent::CyclicCoordinateDescent(
 	likelihoodCount = 0;
 	noiseLevel = NOISY;
 	initialBound = 2.0;
+	nThreads = 1;
+	usePager = true;
 
 	init(hXI.getHasOffsetCovariate());
 }
@@ -84,6 +87,8 @@ CyclicCoordinateDescent::CyclicCoordinateDescent(const CyclicCoordinateDescent&
 	likelihoodCount = 0;
 	noiseLevel = copy.noiseLevel;
 	initialBound = copy.initialBound;
+	nThreads = copy.nThreads;
+	usePager = false; // Shared data; the pager follows a single fit
 
 	init(hXI.getHasOffsetCovariate());
 
@@ -158,6 +163,14 @@ void CyclicCoordinateDescent::setInitialBound(double bound) {
     initialBound = bound;
 }
 
+void CyclicCoordinateDescent::setThreads(int threads) {
+	nThreads = std::max(1, threads);
+}
+
+void CyclicCoordinateDescent::setUsePager(bool use) {
+	usePager = use;
+}
+
 void CyclicCoordinateDescent::resetBounds() {
 	for (int j = 0; j < J; j++) {
 		hDelta[j] = initialBound;
@@ -197,6 +210,10 @@ void CyclicCoordinateDescent::init(bool offset) {
 			NULL,
 			hY
 			);
+
+	if (!hXI.getRowCounts().empty()) {
+		setWeights(NULL);
+	}
 }
 
 int CyclicCoordinateDescent::getAlignedLength(int N) {
@@ -269,6 +286,15 @@ double CyclicCoordinateDescent::getPredictiveLogLikelihood(double* weights) {
 
 	getDenominators();
 
+	const RealVector& counts = hXI.getRowCounts();
+	if (!counts.empty()) {
+		std::vector<double> countWeights(weights, weights + K);
+		for (int i = 0; i < K; ++i) {
+			countWeights[i] *= counts[i];
+		}
+		return modelSpecifics.getPredictiveLogLikelihood(countWeights.data());
+	}
+
 	return modelSpecifics.getPredictiveLogLikelihood(weights); // TODO Pass double
 }
 
@@ -403,9 +429,25 @@ void CyclicCoordinateDescent::setBeta(int i, double beta) {
 	varianceKnown = false;
 }
 
+void CyclicCoordinateDescent::setAccumulationCache(AccumulationCachePtr cache) {
+	modelSpecifics.setAccumulationCache(cache);
+}
+
+void CyclicCoordinateDescent::setWeights(double* iWeights, int weightsKey) {
+	setWeights(iWeights);
+	if (iWeights != NULL) {
+		modelSpecifics.setAccumulationKey(weightsKey);
+	}
+}
+
 void CyclicCoordinateDescent::setWeights(double* iWeights) {
 
-	if (iWeights == NULL) {
+	modelSpecifics.setAccumulationKey(-1);
+
+	// Rows merged by ModelData::compressRows() carry their counts as weights
+	const RealVector& counts = hXI.getRowCounts();
+
+	if (iWeights == NULL && counts.empty()) {
 		if (hWeights.size() != 0) {
 			hWeights.resize(0);
 		}
@@ -420,7 +462,10 @@ void CyclicCoordinateDescent::setWeights(double* iWeights) {
 			hWeights.resize(K); // = (double*) malloc(sizeof(double) * K);
 		}
 		for (int i = 0; i < K; ++i) {
-			hWeights[i] = iWeights[i];
+			hWeights[i] = (iWeights == NULL) ? 1.0 : iWeights[i];
+			if (!counts.empty()) {
+				hWeights[i] *= counts[i];
+			}
 		}
 		useCrossValidation = true;
 		validWeights = false;
@@ -707,9 +752,15 @@ void CyclicCoordinateDescent::kktSwindle(const ModeFindingArguments& arguments)
 template <typename Container>
 void CyclicCoordinateDescent::computeKktConditions(Container& scoreSet) {
 
+    ColumnPager* pager = usePager ? hXI.getPager() : nullptr;
+
     for (auto& score : scoreSet) {
         const auto index = std::get<0>(score);
 
+		if (pager) {
+			pager->visit(index);
+		}
+
 		computeNumeratorForGradient(index);
 
 		priors::GradientHessian gh;
@@ -772,12 +823,21 @@ void CyclicCoordinateDescent::findMode(
 		saveXBeta();
 	}
 
+	ColumnPager* pager = usePager ? hXI.getPager() : nullptr;
+
 	while (!done) {
 
+		if (pager) {
+			pager->beginSweep(fixBeta);
+		}
+
 		// Do a complete cycle
 		for(int index = 0; index < J; index++) {
 
 			if (!fixBeta[index]) {
+				if (pager) {
+					pager->visit(index);
+				}
 				double delta = ccdUpdateBeta(index);
 				delta = applyBounds(delta, index);
 				if (delta != 0.0) {
@@ -864,6 +924,14 @@ void CyclicCoordinateDescent::findMode(
 	lastIterationCount = iteration;
 	updateCount += 1;
 
+	if (pager && noiseLevel > QUIET) {
+		std::ostringstream stream;
+		stream << "Column paging: " << pager->getResidentBytes() << " of "
+			<< pager->getBudget() << " bytes resident, " << pager->getNumberOfPrefetches()
+			<< " prefetches, " << pager->getNumberOfEvictions() << " evictions";
+		logger->writeLine(stream);
+	}
+
 	modelSpecifics.printTiming();
 
 	fisherInformationKnown = false;
@@ -901,6 +969,17 @@ double CyclicCoordinateDescent::getHessianDiagonal(int index) {
 	return g_d2;
 }
 
+double CyclicCoordinateDescent::getLogLikelihoodGradient(int index) {
+
+	checkAllLazyFlags();
+	double g_d1, g_d2;
+
+	computeNumeratorForGradient(index);
+	computeGradientAndHessian(index, &g_d1, &g_d2);
+
+	return -g_d1; // Gradient of the log-likelihood, not its negative
+}
+
 double CyclicCoordinateDescent::getAsymptoticVariance(int indexOne, int indexTwo) {
 	checkAllLazyFlags();
 	if (!fisherInformationKnown) {
@@ -909,7 +988,7 @@ double CyclicCoordinateDescent::getAsymptoticVariance(int indexOne, int indexTwo
 	}
 
 	if (!varianceKnown) {
-		computeAsymptoticVarianceMatrix();
+		factorAsymptoticPrecisionMatrix();
 		varianceKnown = true;
 	}
 
@@ -919,7 +998,7 @@ double CyclicCoordinateDescent::getAsymptoticVariance(int indexOne, int indexTwo
 	if (itOne == hessianIndexMap.end() || itTwo == hessianIndexMap.end()) {
 		return NAN;
 	} else {
-		return varianceMatrix(itOne->second, itTwo->second);
+		return getAsymptoticVarianceColumn(itTwo->second)(itOne->second);
 	}
 }
 
@@ -940,17 +1019,12 @@ double CyclicCoordinateDescent::getAsymptoticPrecision(int indexOne, int indexTw
 	}
 }
 
-CyclicCoordinateDescent::Matrix CyclicCoordinateDescent::computeFisherInformation(const std::vector<size_t>& indices) const {
+CyclicCoordinateDescent::Matrix CyclicCoordinateDescent::computeFisherInformation(const std::vector<size_t>& indices) {
+    checkAllLazyFlags(); // Betas may have been set since the last fit
     Matrix fisherInformation(indices.size(), indices.size());
-    for (size_t ii = 0; ii < indices.size(); ++ii) {
-        const int i = indices[ii];
-        for (size_t jj = ii; jj < indices.size(); ++jj) {
-            const int j = indices[jj];
-            double element = 0.0;
-             modelSpecifics.computeFisherInformation(i, j, &element, useCrossValidation);
-            fisherInformation(jj, ii) = fisherInformation(ii, jj) = element;
-        }
-    }
+    std::vector<int> columns(indices.begin(), indices.end());
+    modelSpecifics.computeFisherInformationMatrix(columns, fisherInformation.data(), nThreads,
+        useCrossValidation);
     return fisherInformation;
 }
 
@@ -971,42 +1045,52 @@ void CyclicCoordinateDescent::computeAsymptoticPrecisionMatrix(void) {
 	}
 
 	hessianMatrix.resize(indices.size(), indices.size());
-	modelSpecifics.makeDirty(); // clear hessian terms
-
-	for (size_t ii = 0; ii < indices.size(); ++ii) {
-		for (size_t jj = ii; jj < indices.size(); ++jj) {
-			const int i = indices[ii];
-			const int j = indices[jj];
-//			std::cerr << "(" << i << "," << j << ")" << std::endl;
-			double fisherInformation = 0.0;
-			modelSpecifics.computeFisherInformation(i, j, &fisherInformation, useCrossValidation);
-//			if (fisherInformation != 0.0) {
-				// Add tuple to sparse matrix
-//				tripletList.push_back(Triplet<double>(ii,jj,fisherInformation));
-//			}
-			hessianMatrix(jj,ii) = hessianMatrix(ii,jj) = fisherInformation;
-
-//			std::cerr << "Info = " << fisherInformation << std::endl;
-//			std::cerr << "Hess = " << getHessianDiagonal(0) << std::endl;
-//			exit(-1);
-		}
+
+	// Cross-terms cached since xBeta last changed remain valid
+	modelSpecifics.resetCrossTermCacheCounters();
+	modelSpecifics.computeFisherInformationMatrix(indices, hessianMatrix.data(), nThreads,
+			useCrossValidation);
+
+	if (noiseLevel > QUIET) {
+		std::ostringstream stream;
+		stream << "Cross-term cache: " << modelSpecifics.getCrossTermCacheHits() << " hits, "
+			<< modelSpecifics.getCrossTermCacheMisses() << " misses, "
+			<< modelSpecifics.getCrossTermCacheBytes() << " bytes";
+		logger->writeLine(stream);
 	}
+}
+
+void CyclicCoordinateDescent::factorAsymptoticPrecisionMatrix(void) {
 
-//	sm.setFromTriplets(tripletList.begin(), tripletList.end());
-//	cout << sm;
-//	auto inv = sm.triangularView<Upper>().solve(dv1);
-//	cout << sm.inverse();
-//	cout << hessianMatrix << endl;
+	varianceColumns.clear();
 
-	// Take inverse
-//	hessianMatrix = hessianMatrix.inverse();
+	// Most cross-terms vanish when covariates rarely co-occur; a sparse factorization then
+	// avoids the O(p^3) dense work
+	const Matrix::Index p = hessianMatrix.rows();
+	const Matrix::Index nonZeros = (hessianMatrix.array() != 0.0).count();
+	useSparseFactor = p >= 100 && nonZeros < 0.1 * p * p;
 
-//	cout << hessianMatrix << endl;
+	if (useSparseFactor) {
+		sparseHessianFactor.compute(hessianMatrix.sparseView());
+		if (sparseHessianFactor.info() != Eigen::Success) {
+			useSparseFactor = false;
+		}
+	}
+	if (!useSparseFactor) {
+		hessianFactor.compute(hessianMatrix);
+	}
 }
 
-void CyclicCoordinateDescent::computeAsymptoticVarianceMatrix(void) {
-	varianceMatrix = hessianMatrix.inverse();
-// 	cout << varianceMatrix << endl;
+const Eigen::VectorXd& CyclicCoordinateDescent::getAsymptoticVarianceColumn(int column) {
+	auto it = varianceColumns.find(column);
+	if (it == varianceColumns.end()) {
+		const Eigen::VectorXd unit = Eigen::VectorXd::Unit(hessianMatrix.rows(), column);
+		it = varianceColumns.insert(std::make_pair(column,
+			useSparseFactor ?
+				Eigen::VectorXd(sparseHessianFactor.solve(unit)) :
+				Eigen::VectorXd(hessianFactor.solve(unit)))).first;
+	}
+	return it->second;
 }
 
 double CyclicCoordinateDescent::ccdUpdateBeta(int index) {
@@ -1043,7 +1127,16 @@ void CyclicCoordinateDescent::axpyXBeta(const double beta, const int j) {
 	if (beta != static_cast<double>(0.0)) {
 		switch (hXI.getFormatType(j)) {
 		case INDICATOR:
-			axpy < IndicatorIterator > (hXBeta.data(), beta, j);
+			switch (hXI.getColumn(j).getIndexEncoding()) {
+			case VARINT_INDICES:
+				axpy < CompressedIndicatorIterator > (hXBeta.data(), beta, j);
+				break;
+			case BITMAP_INDICES:
+				axpy < BitmapIndicatorIterator > (hXBeta.data(), beta, j);
+				break;
+			default:
+				axpy < IndicatorIterator > (hXBeta.data(), beta, j);
+			}
 			break;
 		case INTERCEPT:
 		    axpy < InterceptIterator > (hXBeta.data(), beta, j);
@@ -23,6 +23,9 @@
 #pragma GCC diagnostic ignored "-Wignored-attributes" // To keep C++14 quiet
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 #include <Eigen/Dense>
+#include <Eigen/SparseCore>
+#include <Eigen/OrderingMethods>
+#include <Eigen/SparseCholesky>
 #pragma GCC diagnostic pop
 
 #include <deque>
@@ -104,6 +107,8 @@ public:
 
 	double getHessianDiagonal(int index);
 
+	double getLogLikelihoodGradient(int index);
+
 	double getAsymptoticVariance(int i, int j);
 
 	double getAsymptoticPrecision(int i, int j);
@@ -127,6 +132,11 @@ public:
 
 	void setWeights(double* weights);
 
+	// Weights sharing a key (e.g. a cross-validation fold) reuse cached accumulation structures
+	void setWeights(double* weights, int weightsKey);
+
+	void setAccumulationCache(AccumulationCachePtr cache);
+
 	void setLogisticRegression(bool idoLR);
 
 //	template <typename T>
@@ -168,7 +178,12 @@ public:
 
 	void setInitialBound(double bound);
 
-	Matrix computeFisherInformation(const std::vector<size_t>& indices) const;
+	void setThreads(int threads);
+
+	// Page file-backed columns during fits (see ColumnPager); clones never do
+	void setUsePager(bool use);
+
+	Matrix computeFisherInformation(const std::vector<size_t>& indices);
 
 	loggers::ProgressLogger& getProgressLogger() const { return *logger; }
 
@@ -215,7 +230,9 @@ protected:
 
 	void computeAsymptoticPrecisionMatrix(void);
 
-	void computeAsymptoticVarianceMatrix(void);
+	void factorAsymptoticPrecisionMatrix(void);
+
+	const Eigen::VectorXd& getAsymptoticVarianceColumn(int column);
 
 	template <class IteratorType>
 	void incrementNumeratorForGradientImpl(int index);
@@ -327,6 +344,8 @@ protected:
 	int priorType;
 
 	double initialBound;
+	int nThreads;
+	bool usePager;
 
 	bool sufficientStatisticsKnown;
 	bool xBetaKnown;
@@ -346,7 +365,12 @@ protected:
 	int lastIterationCount;
 
 	Matrix hessianMatrix;
-	Matrix varianceMatrix;
+
+	typedef Eigen::SparseMatrix<double> SparseMatrix;
+	Eigen::LDLT<Matrix> hessianFactor;
+	Eigen::SimplicialLDLT<SparseMatrix> sparseHessianFactor;
+	bool useSparseFactor;
+	std::map<int, Eigen::VectorXd> varianceColumns; // Solved columns of the inverse precision
 
 	typedef std::map<int, int> IndexMap;
 	IndexMap hessianIndexMap;
@@ -0,0 +1,260 @@
+/*
+ * FormatCostModel.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: msuchard
+ */
+
+#ifndef FORMATCOSTMODEL_H_
+#define FORMATCOSTMODEL_H_
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <cstddef>
+
+#include "CompressedDataMatrix.h"
+
+namespace bsccs {
+
+// Density and value pattern of one column
+struct ColumnProfile {
+	size_t nRows;
+	size_t nonZeros;
+	bool isBinary;       // All non-zero values equal 1
+	size_t varintBytes;  // Storage as CompressedIndices
+	size_t bitmapBytes;  // Storage as IndicatorBitmap
+	size_t bitmapWords;  // Words scanned by bitmap containers
+
+	template <typename IntItr>
+	ColumnProfile(size_t nRows, IntItr rowsBegin, IntItr rowsEnd, bool isBinary) :
+			nRows(nRows), nonZeros(std::distance(rowsBegin, rowsEnd)), isBinary(isBinary) {
+		varintBytes = CompressedIndices::getEncodedSize(rowsBegin, rowsEnd);
+		IndicatorBitmap::getEncodedSize(rowsBegin, rowsEnd, bitmapBytes, bitmapWords);
+	}
+};
+
+struct ColumnFormat {
+	FormatType type;
+	IndexEncoding encoding;
+
+	ColumnFormat(FormatType type, IndexEncoding encoding = PLAIN_INDICES) :
+		type(type), encoding(encoding) { }
+
+	bool operator==(const ColumnFormat& rhs) const {
+		return type == rhs.type && encoding == rhs.encoding;
+	}
+
+	std::string getName() const {
+		switch (type) {
+			case DENSE : return "dense";
+			case SPARSE : return "sparse";
+			case INTERCEPT : return "intercept";
+			default : return (encoding == VARINT_INDICES) ? "varint indicator" :
+				(encoding == BITMAP_INDICES) ? "bitmap indicator" : "indicator";
+		}
+	}
+};
+
+/**
+ * Chooses a storage format per column by the expected time of one xBeta/gradient sweep plus a
+ * price on its memory.  Per-entry times come from a fixed table of typical times, so the choice
+ * is reproducible, or, if requested, from a one-time calibration that runs each format's inner
+ * loop on synthetic data.  Memory is priced as memoryWeight extra streaming passes over the
+ * column's bytes.
+ */
+class FormatCostModel {
+public:
+
+	// Nanoseconds per unit of work
+	struct Calibration {
+		double denseRow;
+		double interceptRow;
+		double sparseEntry;
+		double indicatorEntry;
+		double varintEntry;
+		double bitmapEntry;
+		double bitmapWord;
+		double streamByte;
+	};
+
+	static const double DefaultMemoryWeight;
+	static const double CompactMemoryWeight;
+
+	// Typical x86-64 times, from calibrate() at -O2
+	static const Calibration DefaultCalibration;
+
+	FormatCostModel(double memoryWeight = DefaultMemoryWeight, bool calibrated = false) :
+		memoryWeight(memoryWeight),
+		calibration(calibrated ? getCalibration() : DefaultCalibration) { }
+
+	// Measured once per process; timings vary between runs, and so may the chosen formats
+	static const Calibration& getCalibration() {
+		static const Calibration calibration = calibrate();
+		return calibration;
+	}
+
+	const Calibration& getTimes() const { return calibration; }
+
+	size_t getBytes(const ColumnProfile& profile, const ColumnFormat& format) const {
+		switch (format.type) {
+			case DENSE : return profile.nRows * sizeof(real);
+			case SPARSE : return profile.nonZeros * (sizeof(real) + sizeof(int));
+			case INTERCEPT : return 0;
+			default :
+				return (format.encoding == VARINT_INDICES) ? profile.varintBytes :
+					(format.encoding == BITMAP_INDICES) ? profile.bitmapBytes :
+					profile.nonZeros * sizeof(int);
+		}
+	}
+
+	double getSweepTime(const ColumnProfile& profile, const ColumnFormat& format) const {
+		switch (format.type) {
+			case DENSE : return profile.nRows * calibration.denseRow;
+			case SPARSE : return profile.nonZeros * calibration.sparseEntry;
+			case INTERCEPT : return profile.nRows * calibration.interceptRow;
+			default :
+				return (format.encoding == VARINT_INDICES) ? profile.nonZeros * calibration.varintEntry :
+					(format.encoding == BITMAP_INDICES) ? profile.nonZeros * calibration.bitmapEntry +
+						profile.bitmapWords * calibration.bitmapWord :
+					profile.nonZeros * calibration.indicatorEntry;
+		}
+	}
+
+	double getCost(const ColumnProfile& profile, const ColumnFormat& format) const {
+		return getSweepTime(profile, format) +
+			memoryWeight * calibration.streamByte * getBytes(profile, format);
+	}
+
+	// INTERCEPT is only a candidate for the model's intercept; other all-ones columns keep a stored format
+	ColumnFormat chooseFormat(const ColumnProfile& profile, bool isIntercept = false) const {
+		std::vector<ColumnFormat> candidates = { DENSE, SPARSE };
+		if (profile.isBinary) {
+			candidates.push_back(ColumnFormat(INDICATOR, PLAIN_INDICES));
+			candidates.push_back(ColumnFormat(INDICATOR, VARINT_INDICES));
+			candidates.push_back(ColumnFormat(INDICATOR, BITMAP_INDICES));
+			if (isIntercept && profile.nonZeros == profile.nRows) {
+				candidates.push_back(INTERCEPT);
+			}
+		}
+
+		ColumnFormat best = candidates[0];
+		double bestCost = std::numeric_limits<double>::max();
+		for (const auto& format : candidates) {
+			const double cost = getCost(profile, format);
+			if (cost < bestCost) {
+				bestCost = cost;
+				best = format;
+			}
+		}
+		return best;
+	}
+
+private:
+
+	template <typename Kernel>
+	static double timeKernel(Kernel kernel) {
+		double best = std::numeric_limits<double>::max();
+		for (int rep = 0; rep < CalibrationReplicates; ++rep) {
+			const auto start = std::chrono::steady_clock::now();
+			kernel();
+			const auto end = std::chrono::steady_clock::now();
+			best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+		}
+		return best;
+	}
+
+	template <typename Encoding>
+	static double timeEncoded(const Encoding& encoding, std::vector<real>& xBeta, real delta) {
+		int buffer[Encoding::BlockSize];
+		return timeKernel([&]() {
+			for (size_t block = 0; block < encoding.getNumberOfBlocks(); ++block) {
+				const size_t n = encoding.decodeBlock(block, buffer);
+				for (size_t i = 0; i < n; ++i) {
+					xBeta[buffer[i]] += delta;
+				}
+			}
+		});
+	}
+
+	static Calibration calibrate() {
+		const int nRows = CalibrationRows;
+		const real delta = 0.5;
+		std::vector<real> xBeta(nRows, 0.0);
+		std::vector<real> values(nRows);
+		for (int i = 0; i < nRows; ++i) {
+			values[i] = static_cast<real>(i % 7) - 3.0;
+		}
+
+		// Rows at density 1/2 and 1/8; both dense enough for bitmap containers
+		std::vector<int> halfRows, eighthRows;
+		for (int i = 0; i < nRows; ++i) {
+			if (i % 2 == 0) halfRows.push_back(i);
+			if (i % 8 == 3) eighthRows.push_back(i);
+		}
+		const size_t nHalf = halfRows.size();
+		const size_t nEighth = eighthRows.size();
+
+		Calibration c;
+
+		c.denseRow = timeKernel([&]() {
+			for (int i = 0; i < nRows; ++i) {
+				xBeta[i] += delta * values[i];
+			}
+		}) / nRows;
+
+		c.interceptRow = timeKernel([&]() {
+			for (int i = 0; i < nRows; ++i) {
+				xBeta[i] += delta;
+			}
+		}) / nRows;
+
+		c.sparseEntry = timeKernel([&]() {
+			for (size_t k = 0; k < nEighth; ++k) {
+				xBeta[eighthRows[k]] += delta * values[k];
+			}
+		}) / nEighth;
+
+		c.indicatorEntry = timeKernel([&]() {
+			for (size_t k = 0; k < nEighth; ++k) {
+				xBeta[eighthRows[k]] += delta;
+			}
+		}) / nEighth;
+
+		const CompressedIndices varint(eighthRows.begin(), eighthRows.end());
+		c.varintEntry = timeEncoded(varint, xBeta, delta) / nEighth;
+
+		// Same bitmap words at two densities separate the per-entry and per-word costs
+		const IndicatorBitmap halfBitmap(halfRows.begin(), halfRows.end());
+		const IndicatorBitmap eighthBitmap(eighthRows.begin(), eighthRows.end());
+		const double halfTime = timeEncoded(halfBitmap, xBeta, delta);
+		const double eighthTime = timeEncoded(eighthBitmap, xBeta, delta);
+		const double nWords = static_cast<double>(nRows) / 64;
+		c.bitmapEntry = std::max(0.0, (halfTime - eighthTime) / (nHalf - nEighth));
+		c.bitmapWord = std::max(0.0, (eighthTime - c.bitmapEntry * nEighth) / nWords);
+
+		real sum = 0.0;
+		c.streamByte = timeKernel([&]() {
+			for (int i = 0; i < nRows; ++i) {
+				sum += values[i];
+			}
+		}) / (nRows * sizeof(real));
+
+		volatile real sink = sum + xBeta[0]; // Keep the timed loops observable
+		(void) sink;
+
+		return c;
+	}
+
+	static const int CalibrationRows = 1 << 16;
+	static const int CalibrationReplicates = 5;
+
+	double memoryWeight;
+	const Calibration& calibration;
+};
+
+} // namespace
+
+#endif /* FORMATCOSTMODEL_H_ */
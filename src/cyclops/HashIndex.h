@@ -0,0 +1,140 @@
+/*
+ * HashIndex.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: msuchard
+ */
+
+#ifndef HASHINDEX_H_
+#define HASHINDEX_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace bsccs {
+
+/**
+ * Open-addressing hash map from a 64-bit key to a non-negative int, with linear probing over a
+ * power-of-two table that doubles at half load.  Keys are never removed individually; callers
+ * clear() and re-insert when positions change.
+ */
+template <typename Key>
+class HashIndex {
+public:
+
+	static const int NotFound = -1;
+
+	HashIndex() : count(0), mask(0) { }
+
+	size_t size() const { return count; }
+
+	size_t getStorageBytes() const {
+		return slots.capacity() * sizeof(Slot);
+	}
+
+	void clear() {
+		slots.clear();
+		count = 0;
+		mask = 0;
+	}
+
+	void reserve(size_t n) {
+		size_t capacity = MinimumCapacity;
+		while (capacity < 2 * n) {
+			capacity *= 2;
+		}
+		if (capacity > slots.size()) {
+			rehash(capacity);
+		}
+	}
+
+	int find(Key key) const {
+		if (count == 0) {
+			return NotFound;
+		}
+		for (size_t slot = hash(key) & mask; ; slot = (slot + 1) & mask) {
+			const Slot& entry = slots[slot];
+			if (entry.value == NotFound) {
+				return NotFound;
+			}
+			if (entry.key == key) {
+				return entry.value;
+			}
+		}
+	}
+
+	// Keeps the first value inserted for a key; returns false if the key was already present
+	bool insert(Key key, int value) {
+		Slot& entry = locate(key);
+		if (entry.value != NotFound) {
+			return false;
+		}
+		entry.key = key;
+		entry.value = value;
+		++count;
+		return true;
+	}
+
+	// Maps key to value, replacing any earlier value
+	void assign(Key key, int value) {
+		Slot& entry = locate(key);
+		if (entry.value == NotFound) {
+			entry.key = key;
+			++count;
+		}
+		entry.value = value;
+	}
+
+private:
+
+	struct Slot {
+		Key key;
+		int value;
+
+		Slot() : key(0), value(NotFound) { }
+	};
+
+	static const size_t MinimumCapacity = 16;
+
+	static size_t hash(Key key) {
+		uint64_t x = static_cast<uint64_t>(key); // splitmix64 finalizer
+		x = (x ^ (x >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+		x = (x ^ (x >> 27)) * UINT64_C(0x94d049bb133111eb);
+		return static_cast<size_t>(x ^ (x >> 31));
+	}
+
+	// Slot holding key, else the empty slot where it belongs; grows first so one is left
+	Slot& locate(Key key) {
+		if (2 * (count + 1) > slots.size()) {
+			rehash(slots.empty() ? MinimumCapacity : 2 * slots.size());
+		}
+		for (size_t slot = hash(key) & mask; ; slot = (slot + 1) & mask) {
+			Slot& entry = slots[slot];
+			if (entry.value == NotFound || entry.key == key) {
+				return entry;
+			}
+		}
+	}
+
+	void rehash(size_t capacity) {
+		std::vector<Slot> old;
+		old.swap(slots);
+		slots.resize(capacity);
+		mask = capacity - 1;
+		count = 0;
+		for (const auto& entry : old) {
+			if (entry.value != NotFound) {
+				insert(entry.key, entry.value);
+			}
+		}
+	}
+
+	std::vector<Slot> slots;
+	size_t count;
+	size_t mask;
+};
+
+} // namespace
+
+#endif /* HASHINDEX_H_ */
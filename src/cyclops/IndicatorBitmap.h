@@ -0,0 +1,304 @@
+/*
+ * IndicatorBitmap.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: msuchard
+ */
+
+#ifndef INDICATORBITMAP_H_
+#define INDICATORBITMAP_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace bsccs {
+
+/**
+ * Roaring-style set of row indices for high-density indicator columns.  Rows are split into
+ * blocks of BlockRows; each non-empty block is a container holding either a bitmap of
+ * WordsPerBlock 64-bit words or, when it has fewer than ArrayLimit rows, a sorted array of
+ * 16-bit offsets.  Bitmap containers are read 64 rows per word with count-trailing-zeros, by
+ * forEachRow() or a RowCursor, without decoding into a buffer.
+ */
+class IndicatorBitmap {
+public:
+
+	static const int BlockRows = 2048;
+	static const int WordsPerBlock = BlockRows / 64;
+	static const int BlockSize = BlockRows; // Most entries decoded per block
+	static const int ArrayLimit = WordsPerBlock * 4; // Array container is smaller than bitmap
+
+	IndicatorBitmap() : length(0) { }
+
+	template <typename InputIt>
+	IndicatorBitmap(InputIt begin, InputIt end) : length(0) {
+		encode(begin, end);
+	}
+
+	size_t size() const { return length; }
+
+	size_t getNumberOfBlocks() const { return containers.size(); }
+
+	size_t getBlockLength(size_t block) const { return containers[block].cardinality; }
+
+	size_t getStorageSize() const {
+		return containers.size() * sizeof(Container) + words.size() * sizeof(uint64_t) +
+			offsets.size() * sizeof(uint16_t);
+	}
+
+	// Decodes one container into out (room for BlockSize entries); returns the number of entries
+	size_t decodeBlock(size_t block, int* out) const {
+		const Container& container = containers[block];
+		const int base = container.key * BlockRows;
+		if (container.isBitmap) {
+			const uint64_t* word = words.data() + container.offset;
+			int* start = out;
+			for (int w = 0; w < WordsPerBlock; ++w) {
+				uint64_t bits = word[w];
+				const int wordBase = base + 64 * w;
+				while (bits) {
+					*out++ = wordBase + countTrailingZeros(bits);
+					bits &= bits - 1;
+				}
+			}
+			return out - start;
+		} else {
+			const uint16_t* offset = offsets.data() + container.offset;
+			for (size_t i = 0; i < container.cardinality; ++i) {
+				out[i] = base + offset[i];
+			}
+			return container.cardinality;
+		}
+	}
+
+	void decode(int* out) const {
+		for (size_t block = 0; block < getNumberOfBlocks(); ++block) {
+			out += decodeBlock(block, out);
+		}
+	}
+
+	// Calls f(row) for each row in order, straight from the bitmap words and offset arrays
+	template <typename F>
+	void forEachRow(F f) const {
+		for (const Container& container : containers) {
+			const int base = container.key * BlockRows;
+			if (container.isBitmap) {
+				const uint64_t* word = words.data() + container.offset;
+				for (int w = 0; w < WordsPerBlock; ++w) {
+					uint64_t bits = word[w];
+					const int wordBase = base + 64 * w;
+					while (bits) {
+						f(wordBase + countTrailingZeros(bits));
+						bits &= bits - 1;
+					}
+				}
+			} else {
+				const uint16_t* offset = offsets.data() + container.offset;
+				for (size_t i = 0; i < container.cardinality; ++i) {
+					f(base + offset[i]);
+				}
+			}
+		}
+	}
+
+	// Steps through the rows in order as forEachRow() does, one row at a time
+	class RowCursor {
+	public:
+		explicit RowCursor(const IndicatorBitmap& bitmap) : bitmap(bitmap), container(0) {
+			enter();
+		}
+
+		operator bool() const { return container < bitmap.containers.size(); }
+
+		int row() const { return current; }
+
+		void next() {
+			const Container& block = bitmap.containers[container];
+			if (block.isBitmap) {
+				bits &= bits - 1;
+				if (bits) {
+					current = base + 64 * word + countTrailingZeros(bits);
+				} else {
+					nextWord();
+				}
+			} else if (++position < block.cardinality) {
+				current = base + bitmap.offsets[block.offset + position];
+			} else {
+				++container;
+				enter();
+			}
+		}
+
+	private:
+		// Moves to the first row of the current container, if any
+		void enter() {
+			if (container < bitmap.containers.size()) {
+				const Container& block = bitmap.containers[container];
+				base = block.key * BlockRows;
+				if (block.isBitmap) {
+					word = -1;
+					nextWord();
+				} else {
+					position = 0;
+					current = base + bitmap.offsets[block.offset];
+				}
+			}
+		}
+
+		// Moves to the next non-zero word of a bitmap container, or on to the next container
+		void nextWord() {
+			const uint64_t* words = bitmap.words.data() + bitmap.containers[container].offset;
+			while (++word < WordsPerBlock) {
+				if (words[word]) {
+					bits = words[word];
+					current = base + 64 * word + countTrailingZeros(bits);
+					return;
+				}
+			}
+			++container;
+			enter();
+		}
+
+		const IndicatorBitmap& bitmap;
+		size_t container;
+		int base;
+		int word;
+		uint64_t bits;
+		uint32_t position;
+		int current;
+	};
+
+	std::vector<int> decode() const {
+		std::vector<int> out(length);
+		decode(out.data());
+		return out;
+	}
+
+	// Bytes needed to store n sorted rows out of nRows, assuming a uniform spread
+	static size_t expectedStorageSize(size_t n, size_t nRows) {
+		const size_t blocks = (nRows + BlockRows - 1) / BlockRows;
+		if (blocks == 0) {
+			return 0;
+		}
+		const size_t perBlock = n / blocks;
+		const size_t payload = (perBlock < static_cast<size_t>(ArrayLimit)) ?
+			n * sizeof(uint16_t) : blocks * WordsPerBlock * sizeof(uint64_t);
+		return payload + blocks * sizeof(Container);
+	}
+
+	bool operator==(const IndicatorBitmap& rhs) const {
+		if (length != rhs.length || containers.size() != rhs.containers.size() ||
+				words != rhs.words || offsets != rhs.offsets) {
+			return false;
+		}
+		for (size_t i = 0; i < containers.size(); ++i) {
+			if (containers[i].key != rhs.containers[i].key ||
+					containers[i].isBitmap != rhs.containers[i].isBitmap) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	size_t hash() const {
+		size_t seed = length;
+		for (const auto& container : containers) {
+			seed = seed * 31 + static_cast<size_t>(container.key);
+		}
+		for (auto word : words) {
+			seed = seed * 31 + static_cast<size_t>(word ^ (word >> 32));
+		}
+		for (auto offset : offsets) {
+			seed = seed * 31 + offset;
+		}
+		return seed;
+	}
+
+	// Bytes encode() would use for the sorted rows in [begin, end), and the bitmap words it would scan
+	template <typename InputIt>
+	static void getEncodedSize(InputIt begin, InputIt end, size_t& bytes, size_t& nWords) {
+		bytes = 0;
+		nWords = 0;
+		while (begin != end) {
+			const int key = *begin / BlockRows;
+			size_t count = 0;
+			for (; begin != end && *begin / BlockRows == key; ++begin) {
+				++count;
+			}
+			if (count >= static_cast<size_t>(ArrayLimit)) {
+				bytes += WordsPerBlock * sizeof(uint64_t);
+				nWords += WordsPerBlock;
+			} else {
+				bytes += count * sizeof(uint16_t);
+			}
+			bytes += sizeof(Container);
+		}
+	}
+
+private:
+
+	struct Container {
+		int key;
+		uint32_t cardinality;
+		size_t offset;
+		bool isBitmap;
+	};
+
+	template <typename InputIt>
+	void encode(InputIt begin, InputIt end) {
+		std::vector<uint16_t> rows;
+		rows.reserve(BlockRows);
+
+		while (begin != end) {
+			const int key = *begin / BlockRows;
+			rows.clear();
+			for (; begin != end && *begin / BlockRows == key; ++begin) {
+				rows.push_back(static_cast<uint16_t>(*begin - key * BlockRows));
+			}
+
+			Container container;
+			container.key = key;
+			container.cardinality = static_cast<uint32_t>(rows.size());
+			container.isBitmap = rows.size() >= static_cast<size_t>(ArrayLimit);
+			if (container.isBitmap) {
+				container.offset = words.size();
+				words.resize(words.size() + WordsPerBlock, 0);
+				uint64_t* word = words.data() + container.offset;
+				for (auto row : rows) {
+					word[row / 64] |= static_cast<uint64_t>(1) << (row % 64);
+				}
+			} else {
+				container.offset = offsets.size();
+				offsets.insert(offsets.end(), rows.begin(), rows.end());
+			}
+			containers.push_back(container);
+			length += rows.size();
+		}
+		words.shrink_to_fit();
+		offsets.shrink_to_fit();
+		containers.shrink_to_fit();
+	}
+
+	static inline int countTrailingZeros(uint64_t bits) {
+#if defined(__GNUC__)
+		return __builtin_ctzll(bits);
+#else
+		int count = 0;
+		while (!(bits & 1)) {
+			bits >>= 1;
+			++count;
+		}
+		return count;
+#endif
+	}
+
+	size_t length;
+	std::vector<Container> containers;
+	std::vector<uint64_t> words;
+	std::vector<uint16_t> offsets;
+};
+
+} // namespace
+
+#endif /* INDICATORBITMAP_H_ */
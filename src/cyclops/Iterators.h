@@ -42,9 +42,15 @@ class IndicatorIterator {
 // 	    mId(0), mEnd(
 
 	inline IndicatorIterator(const CompressedDataMatrix& mat, Index column)
-	  : mIndices(mat.getCompressedColumnVector(column)),
+	  : mIndices(nullptr),
 	    mId(0), mEnd(mat.getNumberOfEntries(column)){
-		// Do nothing
+		const CompressedDataColumn& col = mat.getColumn(column);
+		if (col.getIndexEncoding() != PLAIN_INDICES) { // Decode into own storage, released with the iterator
+			mDecoded = col.getDecodedIndices();
+			mIndices = mDecoded.data();
+		} else {
+			mIndices = col.getColumns();
+		}
 	}
 
 	inline IndicatorIterator(const std::vector<int>& vec, Index max = 0)
@@ -72,6 +78,90 @@ class IndicatorIterator {
     const Index* mIndices;
     Index mId;
     const Index mEnd;
+    std::vector<Index> mDecoded;
+};
+
+// Iterator for a sparse of indicators column with encoded indices; decodes one block at a time
+// into a local buffer
+template <class Encoding>
+class EncodedIndicatorIterator {
+  public:
+
+	typedef IndicatorTag tag;
+	typedef real Scalar;
+	typedef int Index;
+	typedef boost::tuples::tuple<Index> XTuple;
+
+	const static std::string name;
+
+	static const bool isIndicatorStatic = true;
+	enum  { isIndicator = true };
+	enum  { isSparse = true };
+
+	inline EncodedIndicatorIterator(const CompressedDataMatrix& mat, Index column)
+	  : mIndices(mat.getColumn(column).template getEncodedIndices<Encoding>()),
+	    mBlock(0), mPosition(0), mLength(0), mId(0), mEnd(mIndices.size()) {
+		if (mEnd > 0) {
+			mLength = mIndices.decodeBlock(mBlock, mBuffer);
+		}
+	}
+
+    inline EncodedIndicatorIterator& operator++() {
+    	++mId;
+    	if (++mPosition == mLength && mId < mEnd) {
+    		mLength = mIndices.decodeBlock(++mBlock, mBuffer);
+    		mPosition = 0;
+    	}
+    	return *this;
+    }
+
+    inline const Scalar value() const { return static_cast<Scalar>(1); }
+
+    inline Index index() const { return mBuffer[mPosition]; }
+    inline operator bool() const { return (mId < mEnd); }
+
+  protected:
+    const Encoding& mIndices;
+    size_t mBlock;
+    size_t mPosition;
+    size_t mLength;
+    size_t mId;
+    const size_t mEnd;
+    Index mBuffer[Encoding::BlockSize];
+};
+
+typedef EncodedIndicatorIterator<CompressedIndices> CompressedIndicatorIterator;
+
+// Iterator for a sparse of indicators column stored as an IndicatorBitmap; steps through the
+// bitmap words directly rather than decoding blocks
+class BitmapIndicatorIterator {
+  public:
+
+	typedef IndicatorTag tag;
+	typedef real Scalar;
+	typedef int Index;
+	typedef boost::tuples::tuple<Index> XTuple;
+
+	const static std::string name;
+
+	static const bool isIndicatorStatic = true;
+	enum  { isIndicator = true };
+	enum  { isSparse = true };
+
+	inline BitmapIndicatorIterator(const CompressedDataMatrix& mat, Index column)
+	  : mRows(mat.getColumn(column).template getEncodedIndices<IndicatorBitmap>()) {
+		// Do nothing
+	}
+
+    inline BitmapIndicatorIterator& operator++() { mRows.next(); return *this; }
+
+    inline const Scalar value() const { return static_cast<Scalar>(1); }
+
+    inline Index index() const { return mRows.row(); }
+    inline operator bool() const { return mRows; }
+
+  protected:
+    IndicatorBitmap::RowCursor mRows;
 };
 
 // Iterator for a sparse column
@@ -341,7 +431,7 @@ class GenericIterator {
 
 	inline GenericIterator(const CompressedDataMatrix& mat, Index column)
 	  : mFormatType(mat.getFormatType(column)),
-	    mId(0) {
+	    mId(0), mPosition(0), mLength(0), mColumn(nullptr), mBlock(0) {
 		if (mFormatType == DENSE) {
 			mValues = mat.getDataVector(column);
 			mIndices = NULL;
@@ -356,12 +446,27 @@ class GenericIterator {
 			} else {
 				mValues = NULL;
 			}
-			mIndices = mat.getCompressedColumnVector(column);
 			mEnd = mat.getNumberOfEntries(column);
+			mLength = mEnd;
+			if (mat.getColumn(column).getIndexEncoding() != PLAIN_INDICES) { // Decode one block at a time
+				mColumn = &mat.getColumn(column);
+				mDecoded.resize(EncodedColumn::MaxBlockSize);
+				mIndices = mDecoded.data();
+				mLength = (mEnd > 0) ? mColumn->decodeIndexBlock(mBlock, mIndices) : 0;
+			} else {
+				mIndices = mat.getCompressedColumnVector(column);
+			}
 		}
 	}
 
-    inline GenericIterator& operator++() { ++mId; return *this; }
+    inline GenericIterator& operator++() {
+    	++mId;
+    	if (++mPosition == mLength && mColumn && mId < mEnd) {
+    		mLength = mColumn->decodeIndexBlock(++mBlock, mIndices);
+    		mPosition = 0;
+    	}
+    	return *this;
+    }
 
     inline const Scalar value() const {
     	if (mFormatType == INDICATOR || mFormatType == INTERCEPT) {
@@ -376,7 +481,7 @@ class GenericIterator {
     	if (mFormatType == DENSE || mFormatType == INTERCEPT) {
     		return mId;
     	} else {
-    		return mIndices[mId];
+    		return mIndices[mPosition];
     	}
     }
     inline operator bool() const { return (mId < mEnd); }
@@ -387,6 +492,11 @@ class GenericIterator {
     Index* mIndices;
     Index mId;
     Index mEnd;
+    Index mPosition; // Within the current block of an encoded column, otherwise mId
+    Index mLength;
+    const CompressedDataColumn* mColumn; // Only for encoded columns
+    size_t mBlock;
+    std::vector<Index> mDecoded;
 };
 
 // Iterator for grouping by another IndicatorIterator
@@ -16,23 +16,222 @@
 #include <numeric>
 #include <list>
 #include <functional>
+#include <limits>
+#include <stdexcept>
 
 #include <boost/iterator/permutation_iterator.hpp>
 #include <boost/iterator/transform_iterator.hpp>
+#include <boost/iterator/counting_iterator.hpp>
 
 #include "ModelData.h"
+#include "FormatCostModel.h"
+#include "HashIndex.h"
+#include "Thread.h"
+#include "io/AppendSession.h"
 
 namespace bsccs {
 
 using std::string;
 using std::vector;
 
+namespace {
+
+// Smaller bulk loads are not worth a thread
+const size_t MinEntriesPerLoadTask = 1 << 16;
+
+// Boundaries of nTasks contiguous blocks of [0, n)
+std::vector<size_t> splitRange(const size_t n, const size_t nTasks) {
+	std::vector<size_t> bounds(nTasks + 1);
+	for (size_t task = 0; task <= nTasks; ++task) {
+		bounds[task] = n / nTasks * task + std::min(task, n % nTasks);
+	}
+	return bounds;
+}
+
+template <typename Function>
+void forEachTask(const size_t nTasks, Function function) {
+	if (nTasks == 1) {
+		function(0);
+	} else {
+		TaskScheduler<boost::counting_iterator<size_t> >(
+			boost::make_counting_iterator(static_cast<size_t>(0)),
+			boost::make_counting_iterator(nTasks),
+			nTasks).execute(function);
+	}
+}
+
+// Entries [begin, end) of one block with the same covariate id
+struct EntrySegment {
+	size_t begin;
+	size_t end;
+	size_t nNonZero;
+	bool nonBinary;
+	bool startsRun; // Else continues the previous block's last segment
+	size_t run;
+	size_t offset; // Within the run's non-zero entries
+
+	EntrySegment(size_t begin, bool startsRun) : begin(begin), end(begin), nNonZero(0),
+		nonBinary(false), startsRun(startsRun), run(0), offset(0) { }
+};
+
+// All new entries of one column, written in place
+struct EntryRun {
+	IdType id;
+	size_t nNonZero;
+	bool nonBinary;
+	CompressedDataColumn* column;
+	int* indices;
+	real* values; // nullptr unless SPARSE
+
+	EntryRun(IdType id) : id(id), nNonZero(0), nonBinary(false), column(nullptr),
+		indices(nullptr), values(nullptr) { }
+};
+
+// Earliest invalid entry seen by a task
+struct EntryProblem {
+	enum Kind { NONE, REPEATED, UNSORTED, OUT_OF_BOUNDS };
+
+	size_t position;
+	Kind kind;
+
+	EntryProblem() : position(std::numeric_limits<size_t>::max()), kind(NONE) { }
+
+	void note(size_t k, Kind problem) {
+		if (k < position) {
+			position = k;
+			kind = problem;
+		}
+	}
+
+	static EntryProblem first(const std::vector<EntryProblem>& problems) {
+		EntryProblem earliest;
+		for (const auto& problem : problems) {
+			earliest.note(problem.position, problem.kind);
+		}
+		return earliest;
+	}
+};
+
+// Throws if run.column cannot take sparse entries; runs are all checked before any is prepared
+void checkRun(const EntryRun& run, loggers::ErrorHandler& error) {
+	const FormatType format = run.column->getFormatType();
+	if (format == DENSE || format == INTERCEPT) {
+		std::ostringstream stream;
+		stream << "Cannot add sparse entries to dense variable " << run.id;
+		error.throwError(stream);
+	}
+}
+
+// Grows run.column by run.nNonZero entries, upcasting to SPARSE for non-binary values
+void prepareRun(EntryRun& run) {
+	CompressedDataColumn& column = *run.column;
+	if (run.nonBinary && column.getFormatType() == INDICATOR) {
+		column.convertColumnToSparse();
+	}
+
+	std::vector<int>& indices = column.getColumnsVector();
+	const size_t start = indices.size();
+	indices.resize(start + run.nNonZero);
+	run.indices = indices.data() + start;
+
+	if (column.getFormatType() == SPARSE) {
+		std::vector<real>& values = column.getDataVector();
+		values.resize(start + run.nNonZero);
+		run.values = values.data() + start;
+	}
+}
+
+// Sort key of a row; the input position makes keys distinct, so any sort is stable
+struct RowKey {
+	IdType stratum;
+	real time; // Negated, so later times come first
+	real y;
+	int row;
+
+	bool operator<(const RowKey& rhs) const {
+		if (stratum != rhs.stratum) {
+			return stratum < rhs.stratum;
+		}
+		if (time != rhs.time) {
+			return time < rhs.time;
+		}
+		if (y != rhs.y) {
+			return y < rhs.y;
+		}
+		return row < rhs.row;
+	}
+};
+
+// Sorts nTasks blocks in parallel, then merges pairs of sorted blocks in parallel rounds
+template <typename T>
+void parallelSort(std::vector<T>& values, const size_t nTasks) {
+	const std::vector<size_t> bounds = splitRange(values.size(), nTasks);
+	forEachTask(nTasks, [&](const size_t task) {
+		std::sort(values.begin() + bounds[task], values.begin() + bounds[task + 1]);
+	});
+
+	std::vector<T> merged(values.size());
+	for (size_t width = 1; width < nTasks; width *= 2) {
+		const size_t nMerges = (nTasks + 2 * width - 1) / (2 * width);
+		forEachTask(nMerges, [&](const size_t merge) {
+			const size_t first = 2 * width * merge;
+			const size_t middle = std::min(first + width, nTasks);
+			const size_t last = std::min(first + 2 * width, nTasks);
+			std::merge(values.begin() + bounds[first], values.begin() + bounds[middle],
+				values.begin() + bounds[middle], values.begin() + bounds[last],
+				merged.begin() + bounds[first]);
+		});
+		values.swap(merged);
+	}
+}
+
+// Rows [begin, end) of permuted get values[order[i]]; skipped unless values has one per row
+template <typename T>
+void gatherRows(std::vector<T>& values, const IntVector& order, const size_t begin,
+		const size_t end, std::vector<T>& permuted) {
+	if (values.size() == order.size()) {
+		for (size_t i = begin; i < end; ++i) {
+			permuted[i] = std::move(values[order[i]]);
+		}
+	}
+}
+
+template <typename T>
+void preparePermuted(const std::vector<T>& values, const size_t nRows, std::vector<T>& permuted) {
+	if (values.size() == nRows) {
+		permuted.resize(nRows);
+	}
+}
+
+template <typename T>
+void replaceByPermuted(std::vector<T>& values, const size_t nRows, std::vector<T>& permuted) {
+	if (values.size() == nRows) {
+		values.swap(permuted);
+	}
+}
+
+// Keeps values[kept[k]] as values[k]; skipped unless values has one per row
+template <typename T>
+void keepRows(std::vector<T>& values, const IntVector& kept, const size_t nRows) {
+	if (values.size() == nRows) {
+		for (size_t k = 0; k < kept.size(); ++k) {
+			if (kept[k] != static_cast<int>(k)) {
+				values[k] = std::move(values[kept[k]]);
+			}
+		}
+		values.resize(kept.size());
+	}
+}
+
+} // namespace
+
 ModelData::ModelData(
     ModelType _modelType,
     loggers::ProgressLoggerPtr _log,
     loggers::ErrorHandlerPtr _error
     ) : modelType(_modelType), nPatients(0), nStrata(0), hasOffsetCovariate(false), hasInterceptCovariate(false), isFinalized(false),
-        lastStratumMap(0,0), sparseIndexer(*this), log(_log), error(_error), touchedY(true), touchedX(true) {
+        lastStratumMap(0,0), sparseIndexer(*this), log(_log), error(_error), nThreads(-1),
+        touchedY(true), touchedX(true) {
 	// Do nothing
 }
 
@@ -52,10 +251,10 @@ void ModelData::moveTimeToCovariate(bool takeLog) {
 }
 
 void ModelData::loadY(
-		const std::vector<IdType>& oStratumId,
-		const std::vector<IdType>& oRowId,
-		const std::vector<double>& oY,
-		const std::vector<double>& oTime) {
+		const IdView& oStratumId,
+		const IdView& oRowId,
+		const DoubleView& oY,
+		const DoubleView& oTime) {
 
     bool previouslyLoaded = y.size() > 0;
 
@@ -69,9 +268,9 @@ void ModelData::loadY(
         error->throwError(stream);
     }
 
-	y =  oY; // copy assignment
+	y.assign(oY.begin(), oY.end());
 	if (oTime.size() == oY.size()) {
-		offs = oTime; // copy assignment
+		offs.assign(oTime.begin(), oTime.end());
 	}
 	touchedY = true;
 
@@ -87,7 +286,7 @@ void ModelData::loadY(
 
 		for (size_t i = 0; i < oRowId.size(); ++i) { // ignored if oRowId.size() == 0
 			IdType currentRowId = oRowId[i];
-			rowIdMap[currentRowId] = i;
+			rowIdIndex.push_back(currentRowId, i);
 
 			// Begin code duplication
 			if (processStrata) {
@@ -96,11 +295,13 @@ void ModelData::loadY(
 					lastStratumMap.first = cInStratum;
 					lastStratumMap.second = 0;
 					nPatients++;
+					stratumIds.push_back(cInStratum);
 				} else {
 					if (cInStratum != lastStratumMap.first) {
 						lastStratumMap.first = cInStratum;
 						lastStratumMap.second++;
 						nPatients++;
+						stratumIds.push_back(cInStratum);
 					}
 				}
 				pid.push_back(lastStratumMap.second);
@@ -133,112 +334,167 @@ void ModelData::loadY(
 
 
 int ModelData::loadMultipleX(
-		const std::vector<int64_t>& covariateIds,
-		const std::vector<int64_t>& rowIds,
-		const std::vector<double>& covariateValues,
+		const IdView& covariateIds,
+		const IdView& rowIds,
+		const DoubleView& covariateValues,
 		const bool checkCovariateIds,
 		const bool checkCovariateBounds,
 		const bool append,
 		const bool forceSparse) {
 
-	auto columnIdItr = std::begin(covariateIds);
-	const auto columnIdEnd = std::end(covariateIds);
-	auto rowIdItr = std::begin(rowIds);
-	auto covariateValueItr = std::begin(covariateValues);
+	const size_t nEntries = covariateIds.size();
+	if (nEntries == 0) {
+		return getNumberOfColumns();
+	}
 
 	int firstColumnIndex = getNumberOfColumns();
-
-	auto previousColumnId = *columnIdItr;
-
-	auto index = getColumnIndexByName(previousColumnId);
-	if (index >= 0) {
+	const int existingIndex = getColumnIndexByName(covariateIds[0]);
+	if (existingIndex >= 0) {
 		if (!append) {
             std::ostringstream stream;
-            stream << "Variable " << previousColumnId << " already exists";
+            stream << "Variable " << covariateIds[0] << " already exists";
             error->throwError(stream);
 		}
-		firstColumnIndex = index;
-	} else {
-		--previousColumnId; // not found
+		firstColumnIndex = existingIndex;
 	}
 
 	const bool hasCovariateValues = covariateValues.size() > 0;
-	const bool useRowMap = rowIdMap.size() > 0;
+	const bool useRowMap = rowIdIndex.size() > 0;
+
+	// Entries are grouped by covariate id; each task splits its block into runs of one id,
+	// counts the non-zero entries and validates them
+	const size_t nTasks = getLoadTasks(nEntries);
+	const std::vector<size_t> bounds = splitRange(nEntries, nTasks);
+	std::vector<std::vector<EntrySegment> > segments(nTasks);
+	std::vector<EntryProblem> problems(nTasks);
+
+	forEachTask(nTasks, [&](const size_t task) {
+		std::vector<EntrySegment>& list = segments[task];
+		EntryProblem& problem = problems[task];
+		for (size_t k = bounds[task]; k < bounds[task + 1]; ++k) {
+			const bool startsRun = (k == 0 || covariateIds[k] != covariateIds[k - 1]);
+			if (startsRun || k == bounds[task]) {
+				list.push_back(EntrySegment(k, startsRun));
+			}
+			EntrySegment& segment = list.back();
+			segment.end = k + 1;
 
-// 	std::function<size_t(IdType)>
-//     xform = [this](IdType id) {
-//         return rowIdMap[id];
-//     };
+			if (!startsRun && rowIds[k] == rowIds[k - 1]) {
+				problem.note(k, EntryProblem::REPEATED);
+			}
+			if (checkCovariateIds && k > 0 && covariateIds[k] < covariateIds[k - 1]) {
+				problem.note(k, EntryProblem::UNSORTED);
+			}
+			if (checkCovariateBounds && (useRowMap ?
+					rowIdIndex.find(rowIds[k]) == RowIdIndex::NotFound :
+					rowIds[k] < 0 || static_cast<size_t>(rowIds[k]) >= getNumberOfRows())) {
+				problem.note(k, EntryProblem::OUT_OF_BOUNDS);
+			}
 
+			if (!hasCovariateValues) {
+				++segment.nNonZero;
+			} else if (covariateValues[k] != 0.0) {
+				++segment.nNonZero;
+				if (covariateValues[k] != 1.0) {
+					segment.nonBinary = true;
+				}
+			}
+		}
+	});
 
-	while (columnIdItr != columnIdEnd) {
-
-		if (index < 0) { // Create new column if necessary
-		    const auto format =
-		        (hasCovariateValues &&
-		            (!(*covariateValueItr == 1.0 || *covariateValueItr == 0.0) // not 0 or 1
-                    || forceSparse)) ?
-		                SPARSE : INDICATOR;
-	        push_back(format);
-	        index = getNumberOfColumns() - 1;
-	        getColumn(index).add_label(*columnIdItr);
-        }
-
-		// Append data into CompressedDataColumn
-		CompressedDataColumn& column = getColumn(index);
-		FormatType format = column.getFormatType();
-
-		// Grab whole column worth of data
-		const auto columnId = *columnIdItr;
-		auto lastRowId = *rowIdItr - 1;
-
-		while (columnIdItr != columnIdEnd && *columnIdItr == columnId) {
-		    if (*rowIdItr == lastRowId) {
-		        std::ostringstream stream;
-		        stream << "Repeated row-column entry at ";
-		        stream << *rowIdItr << " - " << *columnIdItr;
-		        throw std::range_error(stream.str());
-		    }
-		    const auto mappedRow = (useRowMap) ? rowIdMap[*rowIdItr] : *rowIdItr;
-		    if (hasCovariateValues) {
-                if (*covariateValueItr != 0.0) {
-                    if (format == INDICATOR && *covariateValueItr != 1.0) {
-                        // Upcast
-                        column.convertColumnToSparse();
-                        format = SPARSE;
-                    }
-                    if (format == SPARSE) {
-                        column.getDataVector().push_back(*covariateValueItr);
-                    }
-                    column.getColumnsVector().push_back(mappedRow);
-                }
-		        ++covariateValueItr;
-		    } else {
-		        column.getColumnsVector().push_back(mappedRow);
-		    }
+	const EntryProblem problem = EntryProblem::first(problems);
+	if (problem.kind == EntryProblem::REPEATED) {
+        std::ostringstream stream;
+        stream << "Repeated row-column entry at ";
+        stream << rowIds[problem.position] << " - " << covariateIds[problem.position];
+        throw std::range_error(stream.str());
+	} else if (problem.kind != EntryProblem::NONE) {
+		std::ostringstream stream;
+		if (problem.kind == EntryProblem::UNSORTED) {
+			stream << "Covariate ids are not sorted: " << covariateIds[problem.position]
+				<< " follows " << covariateIds[problem.position - 1];
+		} else {
+			stream << "Row id " << rowIds[problem.position] << " of covariate "
+				<< covariateIds[problem.position] << " is not a loaded row";
+		}
+		error->throwError(stream);
+	}
 
-		    lastRowId = *rowIdItr;
+	// Join segments into runs, one per column
+	std::vector<EntryRun> runs;
+	for (auto& list : segments) {
+		for (auto& segment : list) {
+			if (segment.startsRun) {
+				runs.push_back(EntryRun(covariateIds[segment.begin]));
+			}
+			EntryRun& run = runs.back();
+			segment.run = runs.size() - 1;
+			segment.offset = run.nNonZero;
+			run.nNonZero += segment.nNonZero;
+			run.nonBinary = run.nonBinary || segment.nonBinary;
+		}
+	}
 
-			++columnIdItr;
-			++rowIdItr;
+	// Check every run before any column is added or grown, so a bad batch changes nothing
+	if (existingIndex >= 0) {
+		runs[0].column = &getColumn(existingIndex);
+		checkRun(runs[0], *error);
+	}
+	if (checkCovariateIds) {
+		for (size_t r = 1; r < runs.size(); ++r) {
+			if (getColumnIndexByName(runs[r].id) >= 0) {
+				std::ostringstream stream;
+				stream << "Variable " << runs[r].id << " already exists";
+				error->throwError(stream);
+			}
 		}
-		index = -1; // new column
 	}
 
+	for (auto& run : runs) {
+		if (!run.column) {
+			push_back((hasCovariateValues && (run.nonBinary || forceSparse)) ? SPARSE : INDICATOR);
+			run.column = &getColumn(getNumberOfColumns() - 1);
+			run.column->add_label(run.id);
+		}
+		prepareRun(run);
+	}
+
+	forEachTask(nTasks, [&](const size_t task) {
+		for (const auto& segment : segments[task]) {
+			const EntryRun& run = runs[segment.run];
+			int* indices = run.indices + segment.offset;
+			real* values = run.values ? run.values + segment.offset : nullptr;
+			for (size_t k = segment.begin; k < segment.end; ++k) {
+				if (hasCovariateValues && covariateValues[k] == 0.0) {
+					continue;
+				}
+				if (useRowMap) {
+					const int found = rowIdIndex.find(rowIds[k]);
+					*indices++ = (found != RowIdIndex::NotFound) ? found : 0;
+				} else {
+					*indices++ = rowIds[k];
+				}
+				if (values) {
+					*values++ = hasCovariateValues ? covariateValues[k] : static_cast<real>(1);
+				}
+			}
+		}
+	});
+
 	touchedX = true;
 	return firstColumnIndex;
 }
 
 int ModelData::loadX(
 		const IdType covariateId,
-		const std::vector<IdType>& rowId,
-		const std::vector<double>& covariateValue,
+		const IdView& rowId,
+		const DoubleView& covariateValue,
 		const bool reload,
 		const bool append,
 		const bool forceSparse) {
 
     const bool hasCovariateValues = covariateValue.size() > 0;
-    const bool useRowMap = rowIdMap.size() > 0;
+    const bool useRowMap = rowIdIndex.size() > 0;
 
     // Determine covariate type
     FormatType newType = rowId.size() == 0 ?
@@ -299,8 +555,8 @@ int ModelData::loadX(
 
         // brand new, make deep copy
         if (newType == DENSE || newType == INTERCEPT) {
-            push_back(begin(rowId), end(rowId),
-                      begin(covariateValue), end(covariateValue),
+            push_back(std::begin(rowId), std::end(rowId),
+                      std::begin(covariateValue), std::end(covariateValue),
                       newType);
         } else { // SPARSE or INDICATOR
             push_back(newType);
@@ -319,7 +575,8 @@ int ModelData::loadX(
                     stream << *rowIdItr << " - " << covariateId;
                     throw std::range_error(stream.str());
                 }
-                const auto mappedRow = (useRowMap) ? rowIdMap[*rowIdItr] : *rowIdItr;
+                const auto mappedRow = (useRowMap) ?
+                    std::max(0, rowIdIndex.find(*rowIdItr)) : *rowIdItr;
                 if (hasCovariateValues) {
                     if (*covariateValueItr != 0.0) {
                         if (newType == INDICATOR && *covariateValueItr != 1.0) {
@@ -356,13 +613,13 @@ int ModelData::loadX(
 }
 
 size_t ModelData::append(
-        const std::vector<IdType>& oStratumId,
-        const std::vector<IdType>& oRowId,
-        const std::vector<double>& oY,
-        const std::vector<double>& oTime,
-        const std::vector<IdType>& cRowId,
-        const std::vector<IdType>& cCovariateId,
-        const std::vector<double>& cCovariateValue) {
+        const IdView& oStratumId,
+        const IdView& oRowId,
+        const DoubleView& oY,
+        const DoubleView& oTime,
+        const IdView& cRowId,
+        const IdView& cCovariateId,
+        const DoubleView& cCovariateValue) {
 
     // Check covariate dimensions
     if ((cRowId.size() != cCovariateId.size()) ||
@@ -395,8 +652,29 @@ size_t ModelData::append(
     std::cout << "sizeof(long long) = " << sizeof(long long) << std::endl;
 #endif
 
+    // Entries [rowStarts[i], rowStarts[i + 1]) are covariates of row i
+    const size_t firstRow = nRows;
+    std::vector<size_t> rowStarts(nOutcomes + 1);
     size_t cOffset = 0;
+    for (size_t i = 0; i < nOutcomes; ++i) {
+        rowStarts[i] = cOffset;
+        while (cOffset < nCovariates && cRowId[cOffset] == oRowId[i]) {
+            ++cOffset;
+        }
+    }
+    rowStarts[nOutcomes] = cOffset;
 
+    if (cOffset < nCovariates) {
+        std::ostringstream stream;
+        stream << "Warning: " << (nCovariates - cOffset) << " covariate entries from row "
+                << cRowId[cOffset] << " on are not in outcome row order and were skipped";
+        log->writeLine(stream);
+    }
+
+    // Covariates are checked and written first; a bad batch throws before any outcome is added
+    appendCovariates(firstRow, rowStarts, oRowId, cCovariateId, cCovariateValue);
+
+    // Outcomes are copied in order
     for (size_t i = 0; i < nOutcomes; ++i) {
 
     	// TODO Begin code duplication with 'loadY'
@@ -405,11 +683,13 @@ size_t ModelData::append(
         	lastStratumMap.first = cInStratum;
         	lastStratumMap.second = 0;
         	nPatients++;
+        	stratumIds.push_back(cInStratum);
         } else {
         	if (cInStratum != lastStratumMap.first) {
           	    lastStratumMap.first = cInStratum;
             	lastStratumMap.second++;
             	nPatients++;
+            	stratumIds.push_back(cInStratum);
         	}
         }
         pid.push_back(lastStratumMap.second);
@@ -419,48 +699,642 @@ size_t ModelData::append(
         }
 
         IdType currentRowId = oRowId[i];
-        // TODO Check timing on adding label as string
-        std::stringstream ss;
-        ss << currentRowId;
-        labels.push_back(ss.str());
+        labels.push_back(std::to_string(currentRowId));
         // TODO End code duplication with 'loadY;
 
 #ifdef DEBUG_64BIT
         std::cout << currentRowId << std::endl;
 #endif
-        while (cOffset < nCovariates && cRowId[cOffset] == currentRowId) {
-            IdType covariate = cCovariateId[cOffset];
-            real value = cCovariateValue[cOffset];
+        ++nRows;
+    }
 
-			if (!sparseIndexer.hasColumn(covariate)) {
-				// Add new column
-				sparseIndexer.addColumn(covariate, INDICATOR);
-			}
+    return nOutcomes;
+}
 
-			CompressedDataColumn& column = sparseIndexer.getColumn(covariate);
-			if (value != static_cast<real>(1) && value != static_cast<real>(0)) {
-				if (column.getFormatType() == INDICATOR) {
-					std::ostringstream stream;
-					stream << "Up-casting covariate " << column.getLabel() << " to sparse!";
-					log->writeLine(stream);
-					column.convertColumnToSparse();
-				}
-			}
+void ModelData::appendCovariates(
+        const size_t firstRow,
+        const std::vector<size_t>& rowStarts,
+        const IdView& oRowId,
+        const IdView& cCovariateId,
+        const DoubleView& cCovariateValue) {
 
-			// Add to storage
-			bool valid = column.add_data(nRows, value);
-			if (!valid) {
-				std::ostringstream stream;
-				stream << "Warning: repeated sparse entries in data row: "
-						<< cRowId[cOffset]
-						<< ", column: " << column.getLabel();
-				log->writeLine(stream);
-			}
-			++cOffset;
+    const size_t nEntries = rowStarts.back();
+    if (nEntries == 0) {
+        return;
+    }
+
+    const size_t nTasks = getLoadTasks(nEntries);
+    const std::vector<size_t> bounds = splitRange(nEntries, nTasks);
+
+    // Each task numbers the covariate ids it touches in order of appearance, so its
+    // counts are sized by the batch rather than by all columns
+    std::vector<int> slots(nEntries);
+    std::vector<std::vector<IdType> > touched(nTasks);
+    std::vector<std::vector<size_t> > counts(nTasks);
+    std::vector<std::vector<char> > nonBinary(nTasks);
+
+    forEachTask(nTasks, [&](const size_t task) {
+        HashIndex<IdType> local;
+        for (size_t k = bounds[task]; k < bounds[task + 1]; ++k) {
+            int slot = local.find(cCovariateId[k]);
+            if (slot < 0) {
+                slot = touched[task].size();
+                local.insert(cCovariateId[k], slot);
+                touched[task].push_back(cCovariateId[k]);
+                counts[task].push_back(0);
+                nonBinary[task].push_back(false);
+            }
+            slots[k] = slot;
+            const real value = cCovariateValue[k];
+            if (value != static_cast<real>(0)) {
+                ++counts[task][slot];
+                if (value != static_cast<real>(1)) {
+                    nonBinary[task][slot] = true;
+                }
+            }
+        }
+    });
+
+    // One run per touched column, in order of first appearance
+    std::vector<EntryRun> runs;
+    std::vector<std::vector<int> > runOfSlot(nTasks);
+    HashIndex<IdType> runOfId;
+    for (size_t task = 0; task < nTasks; ++task) {
+        for (size_t slot = 0; slot < touched[task].size(); ++slot) {
+            const IdType id = touched[task][slot];
+            int r = runOfId.find(id);
+            if (r < 0) {
+                r = runs.size();
+                runOfId.insert(id, r);
+                runs.push_back(EntryRun(id));
+                const int index = getColumnIndexByName(id);
+                if (index >= 0) {
+                    runs.back().column = &getColumn(index);
+                }
+            }
+            runOfSlot[task].push_back(r);
+            runs[r].nNonZero += counts[task][slot];
+            runs[r].nonBinary = runs[r].nonBinary || nonBinary[task][slot];
         }
-        ++nRows;
     }
-    return nOutcomes;
+
+    // Check every run before any column is added or grown, so a bad batch changes nothing
+    for (const auto& run : runs) {
+        if (run.column && run.nNonZero > 0) {
+            checkRun(run, *error);
+        }
+    }
+
+    // New columns are added in order of first appearance, then each column is sized once;
+    // counts become each task's write position
+    for (auto& run : runs) {
+        if (!run.column) {
+            sparseIndexer.addColumn(run.id, INDICATOR);
+            run.column = &getColumn(getNumberOfColumns() - 1);
+        }
+        if (run.nNonZero > 0) {
+            if (run.nonBinary && run.column->getFormatType() == INDICATOR) {
+                std::ostringstream stream;
+                stream << "Up-casting covariate " << run.column->getLabel() << " to sparse!";
+                log->writeLine(stream);
+                run.column->convertColumnToSparse();
+            }
+            prepareRun(run);
+        }
+    }
+    std::vector<size_t> offsets(runs.size(), 0);
+    for (size_t task = 0; task < nTasks; ++task) {
+        for (size_t slot = 0; slot < touched[task].size(); ++slot) {
+            const int r = runOfSlot[task][slot];
+            const size_t count = counts[task][slot];
+            counts[task][slot] = offsets[r];
+            offsets[r] += count;
+        }
+    }
+
+    forEachTask(nTasks, [&](const size_t task) {
+        std::vector<size_t>& positions = counts[task];
+        size_t outcome = std::upper_bound(rowStarts.begin(), rowStarts.end(), bounds[task])
+            - rowStarts.begin() - 1;
+        for (size_t k = bounds[task]; k < bounds[task + 1]; ++k) {
+            while (rowStarts[outcome + 1] <= k) {
+                ++outcome;
+            }
+            const real value = cCovariateValue[k];
+            if (value != static_cast<real>(0)) {
+                const int slot = slots[k];
+                const EntryRun& run = runs[runOfSlot[task][slot]];
+                const size_t position = positions[slot]++;
+                run.indices[position] = firstRow + outcome;
+                if (run.values) {
+                    run.values[position] = value;
+                }
+            }
+        }
+    });
+
+    // A row may list a covariate more than once; keep the first entry
+    std::vector<std::vector<int> > repeatedRows(runs.size());
+    const size_t nRunTasks = std::max<size_t>(1, std::min(nTasks, runs.size()));
+    const std::vector<size_t> runBounds = splitRange(runs.size(), nRunTasks);
+    forEachTask(nRunTasks, [&](const size_t task) {
+        for (size_t r = runBounds[task]; r < runBounds[task + 1]; ++r) {
+            EntryRun& run = runs[r];
+            if (run.nNonZero == 0) {
+                continue;
+            }
+            size_t kept = 1;
+            for (size_t k = 1; k < run.nNonZero; ++k) {
+                if (run.indices[k] == run.indices[kept - 1]) {
+                    repeatedRows[r].push_back(run.indices[k]);
+                } else {
+                    run.indices[kept] = run.indices[k];
+                    if (run.values) {
+                        run.values[kept] = run.values[k];
+                    }
+                    ++kept;
+                }
+            }
+            run.nNonZero = kept;
+        }
+    });
+
+    for (size_t r = 0; r < runs.size(); ++r) {
+        const EntryRun& run = runs[r];
+        for (const auto row : repeatedRows[r]) {
+            std::ostringstream stream;
+            stream << "Warning: repeated sparse entries in data row: "
+                    << oRowId[row - firstRow]
+                    << ", column: " << run.column->getLabel();
+            log->writeLine(stream);
+        }
+        if (!repeatedRows[r].empty()) {
+            std::vector<int>& indices = run.column->getColumnsVector();
+            indices.resize(indices.size() - repeatedRows[r].size());
+            if (run.values) {
+                run.column->getDataVector().resize(indices.size());
+            }
+        }
+    }
+}
+
+AppendSession& ModelData::beginAppendSession(const size_t maxQueuedBatches) {
+    if (appendSession) {
+        std::ostringstream stream;
+        stream << "An append session is already open";
+        error->throwError(stream);
+    }
+    appendSession = bsccs::make_shared<AppendSession>(*this, maxQueuedBatches);
+    return *appendSession;
+}
+
+size_t ModelData::endAppendSession() {
+    if (!appendSession) {
+        return 0;
+    }
+    const bsccs::shared_ptr<AppendSession> session = appendSession;
+    appendSession.reset();
+    const bool succeeded = session->finish();
+    if (!succeeded) {
+        std::ostringstream stream;
+        stream << "Appending failed: " << session->getError();
+        error->throwError(stream);
+    }
+    return session->getNumberOfRows();
+}
+
+size_t ModelData::getLoadTasks(const size_t nEntries) const {
+    const size_t threads = (nThreads == -1) ? bsccs::thread::hardware_concurrency() :
+        std::max(1, nThreads);
+    return std::max<size_t>(1, std::min<size_t>(threads, nEntries / MinEntriesPerLoadTask));
+}
+
+bool ModelData::getHasSortedStrata() const {
+    // A new stratum run starts whenever the id changes, so sorted ids increase strictly
+    for (size_t i = 1; i < stratumIds.size(); ++i) {
+        if (stratumIds[i] <= stratumIds[i - 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ModelData::sortRows() {
+    const size_t n = getNumberOfRows();
+    const bool hasStrata = pid.size() == n;
+    const bool bySurvival = modelType == ModelType::COX || modelType == ModelType::COX_RAW;
+    const bool hasTime = offs.size() == n;
+    if (n == 0 || (!hasStrata && !bySurvival)) {
+        return;
+    }
+
+    const size_t nTasks = getLoadTasks(n);
+    const std::vector<size_t> bounds = splitRange(n, nTasks);
+
+    std::vector<RowKey> keys(n);
+    std::vector<char> missingKeys(nTasks, false);
+    forEachTask(nTasks, [&](const size_t task) {
+        for (size_t i = bounds[task]; i < bounds[task + 1]; ++i) {
+            RowKey& key = keys[i];
+            key.stratum = !hasStrata ? 0 :
+                (stratumIds.empty() ? pid[i] : stratumIds[pid[i]]);
+            key.time = (bySurvival && hasTime) ? -offs[i] : static_cast<real>(0);
+            key.y = bySurvival ? y[i] : static_cast<real>(0);
+            key.row = static_cast<int>(i);
+            if (std::isnan(key.time) || std::isnan(key.y)) {
+                missingKeys[task] = true;
+            }
+        }
+    });
+
+    if (std::find(missingKeys.begin(), missingKeys.end(), true) != missingKeys.end()) {
+        std::ostringstream stream;
+        stream << "Cannot sort rows with missing times or outcomes";
+        error->throwError(stream);
+        return;
+    }
+
+    if (std::is_sorted(keys.begin(), keys.end())) {
+        return;
+    }
+
+    parallelSort(keys, nTasks);
+
+    IntVector order(n);
+    IntVector position(n);
+    for (size_t i = 0; i < n; ++i) {
+        order[i] = keys[i].row;
+        position[keys[i].row] = static_cast<int>(i);
+    }
+
+    // Per-row outcomes, labels and weights
+    RealVector permutedY, permutedZ, permutedOffs, permutedCounts, permutedFixedTimes;
+    IntVector permutedEvents;
+    std::vector<std::string> permutedLabels;
+    preparePermuted(y, n, permutedY);
+    preparePermuted(z, n, permutedZ);
+    preparePermuted(offs, n, permutedOffs);
+    preparePermuted(nevents, n, permutedEvents);
+    preparePermuted(labels, n, permutedLabels);
+    preparePermuted(rowCounts, n, permutedCounts);
+    preparePermuted(fixedTermTimes, n, permutedFixedTimes);
+
+    forEachTask(nTasks, [&](const size_t task) {
+        gatherRows(y, order, bounds[task], bounds[task + 1], permutedY);
+        gatherRows(z, order, bounds[task], bounds[task + 1], permutedZ);
+        gatherRows(offs, order, bounds[task], bounds[task + 1], permutedOffs);
+        gatherRows(nevents, order, bounds[task], bounds[task + 1], permutedEvents);
+        gatherRows(labels, order, bounds[task], bounds[task + 1], permutedLabels);
+        gatherRows(rowCounts, order, bounds[task], bounds[task + 1], permutedCounts);
+        gatherRows(fixedTermTimes, order, bounds[task], bounds[task + 1], permutedFixedTimes);
+    });
+
+    replaceByPermuted(y, n, permutedY);
+    replaceByPermuted(z, n, permutedZ);
+    replaceByPermuted(offs, n, permutedOffs);
+    replaceByPermuted(nevents, n, permutedEvents);
+    replaceByPermuted(labels, n, permutedLabels);
+    replaceByPermuted(rowCounts, n, permutedCounts);
+    replaceByPermuted(fixedTermTimes, n, permutedFixedTimes);
+
+    // Strata become contiguous
+    if (hasStrata) {
+        std::vector<IdType> strata;
+        for (size_t i = 0; i < n; ++i) {
+            if (i == 0 || keys[i].stratum != keys[i - 1].stratum) {
+                strata.push_back(keys[i].stratum);
+            }
+            pid[i] = static_cast<int>(strata.size() - 1);
+        }
+        nPatients = strata.size();
+        nStrata = 0;
+        lastStratumMap.first = strata.back();
+        lastStratumMap.second = nPatients - 1;
+        if (!stratumIds.empty()) {
+            stratumIds.swap(strata);
+        }
+    }
+
+    rowIdIndex.permute(position);
+
+    // Shared storage is copied first, so no column is written while another reads it
+    const size_t nColumns = getNumberOfColumns();
+    for (size_t j = 0; j < nColumns; ++j) {
+        getColumn(j).detach();
+    }
+    const size_t nColumnTasks = std::max<size_t>(1, std::min(nTasks, nColumns));
+    const std::vector<size_t> columnBounds = splitRange(nColumns, nColumnTasks);
+    forEachTask(nColumnTasks, [&](const size_t task) {
+        for (size_t j = columnBounds[task]; j < columnBounds[task + 1]; ++j) {
+            getColumn(j).permuteRows(order, position);
+        }
+    });
+
+    if (inputRows.empty()) {
+        inputRows.swap(position);
+    } else {
+        for (auto& row : inputRows) {
+            row = position[row];
+        }
+    }
+
+    touchedY = true;
+    touchedX = true;
+}
+
+size_t ModelData::compressRows(bool hasOffsetColumn) {
+    const size_t n = getNumberOfRows();
+    const bool bySCCS = modelType == ModelType::SELF_CONTROLLED_MODEL;
+    const bool byFrequency = modelType == ModelType::LOGISTIC ||
+        modelType == ModelType::POISSON || modelType == ModelType::NORMAL;
+    if (n < 2 || !(bySCCS || byFrequency)) {
+        return 0;
+    }
+    if (bySCCS && hasOffsetColumn) {
+        std::ostringstream stream;
+        stream << "Rows are not merged, as the offset comes from a covariate";
+        log->writeLine(stream);
+        return 0;
+    }
+
+    const bool hasStrata = pid.size() == n;
+    const bool hasTime = offs.size() == n;
+    const bool hasZ = z.size() == n;
+    const size_t nTasks = getLoadTasks(n);
+    const std::vector<size_t> bounds = splitRange(n, nTasks);
+
+    // Shared storage is copied first, so no column is written while another reads it
+    const size_t nColumns = getNumberOfColumns();
+    for (size_t j = 0; j < nColumns; ++j) {
+        getColumn(j).detach();
+    }
+    const size_t nColumnTasks = std::max<size_t>(1, std::min(nTasks, nColumns));
+    const std::vector<size_t> columnBounds = splitRange(nColumns, nColumnTasks);
+
+    // Covariates of each row, in column order; the intercept is the same for all rows
+    std::vector<IntVector> columnRows(nColumns);
+    std::vector<RealVector> columnValues(nColumns);
+    forEachTask(nColumnTasks, [&](const size_t task) {
+        for (size_t j = columnBounds[task]; j < columnBounds[task + 1]; ++j) {
+            const CompressedDataColumn& column = getColumn(j);
+            if (column.getFormatType() != INTERCEPT) {
+                column.getNonZeros(columnRows[j], columnValues[j], n);
+            }
+        }
+    });
+
+    std::vector<size_t> rowStarts(n + 1, 0);
+    for (const auto& rows : columnRows) {
+        for (const int row : rows) {
+            ++rowStarts[row + 1];
+        }
+    }
+    std::partial_sum(rowStarts.begin(), rowStarts.end(), rowStarts.begin());
+
+    IntVector entryColumns(rowStarts[n]);
+    RealVector entryValues(rowStarts[n]);
+    {
+        std::vector<size_t> next(rowStarts.begin(), rowStarts.end() - 1);
+        for (size_t j = 0; j < nColumns; ++j) {
+            for (size_t k = 0; k < columnRows[j].size(); ++k) {
+                const size_t entry = next[columnRows[j][k]]++;
+                entryColumns[entry] = static_cast<int>(j);
+                entryValues[entry] = columnValues[j][k];
+            }
+            IntVector().swap(columnRows[j]);
+            RealVector().swap(columnValues[j]);
+        }
+    }
+
+    // SCCS rows merge within a stratum; other rows must also share outcome and time
+    auto sameRow = [&](const int a, const int b) {
+        if (bySCCS) {
+            if (hasStrata && pid[a] != pid[b]) {
+                return false;
+            }
+        } else if (y[a] != y[b] || (hasTime && offs[a] != offs[b]) || (hasZ && z[a] != z[b])) {
+            return false;
+        }
+        const size_t length = rowStarts[a + 1] - rowStarts[a];
+        return length == rowStarts[b + 1] - rowStarts[b] &&
+            std::equal(entryColumns.begin() + rowStarts[a], entryColumns.begin() + rowStarts[a + 1],
+                entryColumns.begin() + rowStarts[b]) &&
+            std::equal(entryValues.begin() + rowStarts[a], entryValues.begin() + rowStarts[a + 1],
+                entryValues.begin() + rowStarts[b]);
+    };
+
+    std::vector<std::pair<size_t,int> > hashes(n);
+    forEachTask(nTasks, [&](const size_t task) {
+        const std::hash<real> hasher;
+        for (size_t i = bounds[task]; i < bounds[task + 1]; ++i) {
+            size_t seed;
+            if (bySCCS) {
+                seed = hasStrata ? static_cast<size_t>(pid[i]) : 0;
+            } else {
+                seed = hasher(y[i]);
+                seed = seed * 31 + (hasTime ? hasher(offs[i]) : 0);
+                seed = seed * 31 + (hasZ ? hasher(z[i]) : 0);
+            }
+            for (size_t entry = rowStarts[i]; entry < rowStarts[i + 1]; ++entry) {
+                seed = seed * 31 + static_cast<size_t>(entryColumns[entry]);
+                seed = seed * 31 + hasher(entryValues[entry]);
+            }
+            hashes[i] = std::make_pair(seed, static_cast<int>(i));
+        }
+    });
+
+    parallelSort(hashes, nTasks);
+
+    // Each row's first identical row; runs of equal hashes are not split between tasks
+    std::vector<size_t> runBounds(bounds);
+    for (size_t task = 1; task < nTasks; ++task) {
+        size_t& bound = runBounds[task];
+        bound = std::max(bound, runBounds[task - 1]);
+        while (bound > 0 && bound < n && hashes[bound].first == hashes[bound - 1].first) {
+            ++bound;
+        }
+    }
+
+    IntVector representative(n);
+    forEachTask(nTasks, [&](const size_t task) {
+        IntVector distinct; // Rows of the current run unlike each other
+        for (size_t k = runBounds[task]; k < runBounds[task + 1]; ++k) {
+            if (k == runBounds[task] || hashes[k].first != hashes[k - 1].first) {
+                distinct.clear();
+            }
+            const int row = hashes[k].second;
+            representative[row] = row;
+            for (const int other : distinct) {
+                if (sameRow(other, row)) {
+                    representative[row] = other;
+                    break;
+                }
+            }
+            if (representative[row] == row) {
+                distinct.push_back(row);
+            }
+        }
+    });
+
+    // Merged rows take the place of their first member, so strata stay in order
+    IntVector group(n);
+    IntVector kept;
+    for (size_t i = 0; i < n; ++i) {
+        if (representative[i] == static_cast<int>(i)) {
+            group[i] = static_cast<int>(kept.size());
+            kept.push_back(static_cast<int>(i));
+        } else {
+            group[i] = group[representative[i]];
+        }
+    }
+    const size_t nGroups = kept.size();
+    if (nGroups == n) {
+        return 0;
+    }
+
+    if (bySCCS) {
+        // Sums keep the likelihood; the fixed term y log(time) is kept through an effective time
+        RealVector summedY(nGroups, static_cast<real>(0));
+        RealVector summedTime(hasTime ? nGroups : 0, static_cast<real>(0));
+        RealVector fixedTerms(hasTime ? nGroups : 0, static_cast<real>(0));
+        IntVector summedEvents(nevents.size() == n ? nGroups : 0, 0);
+        for (size_t i = 0; i < n; ++i) {
+            const int g = group[i];
+            summedY[g] += y[i];
+            if (hasTime) {
+                summedTime[g] += offs[i];
+                if (y[i] != static_cast<real>(0)) {
+                    fixedTerms[g] += y[i] * std::log(fixedTermTimes.size() == n ?
+                        fixedTermTimes[i] : offs[i]);
+                }
+            }
+            if (!summedEvents.empty()) {
+                summedEvents[g] += nevents[i];
+            }
+        }
+        for (size_t g = 0; g < fixedTerms.size(); ++g) {
+            fixedTerms[g] = (summedY[g] != static_cast<real>(0)) ?
+                std::exp(fixedTerms[g] / summedY[g]) : summedTime[g];
+        }
+        y.swap(summedY);
+        offs.swap(summedTime);
+        fixedTermTimes.swap(fixedTerms);
+        if (!summedEvents.empty()) {
+            nevents.swap(summedEvents);
+        }
+    } else {
+        // Selectors still draw over the caller's strata (see getInputPidVectorSTL)
+        if (hasStrata && inputPid.empty()) {
+            const size_t nInput = getNumberOfInputRows();
+            inputPid.resize(nInput);
+            for (size_t i = 0; i < nInput; ++i) {
+                inputPid[i] = pid[inputRows.empty() ? i : inputRows[i]];
+            }
+        }
+        RealVector counts(nGroups, static_cast<real>(0));
+        for (size_t i = 0; i < n; ++i) {
+            counts[group[i]] += (rowCounts.size() == n) ? rowCounts[i] : static_cast<real>(1);
+        }
+        rowCounts.swap(counts);
+        keepRows(y, kept, n);
+        keepRows(offs, kept, n);
+        keepRows(nevents, kept, n);
+    }
+    keepRows(z, kept, n);
+
+    // Callers still see their own rows and labels
+    if (labels.size() == n && inputLabels.empty()) {
+        const size_t nInput = getNumberOfInputRows();
+        inputLabels.resize(nInput);
+        for (size_t i = 0; i < nInput; ++i) {
+            inputLabels[i] = labels[inputRows.empty() ? i : inputRows[i]];
+        }
+    }
+    keepRows(labels, kept, n);
+
+    if (inputRows.empty()) {
+        inputRows = group;
+    } else {
+        for (auto& row : inputRows) {
+            row = group[row];
+        }
+    }
+    rowIdIndex.permute(group);
+
+    // Strata are renumbered; merged independent rows keep their first member's stratum
+    if (hasStrata) {
+        keepRows(pid, kept, n);
+        std::vector<IdType> strata;
+        int lastPid = -1;
+        for (size_t k = 0; k < nGroups; ++k) {
+            if (k == 0 || pid[k] != lastPid) {
+                lastPid = pid[k];
+                strata.push_back(stratumIds.empty() ? lastPid : stratumIds[lastPid]);
+            }
+            pid[k] = static_cast<int>(strata.size() - 1);
+        }
+        nPatients = strata.size();
+        lastStratumMap.first = strata.back();
+        lastStratumMap.second = nPatients - 1;
+        if (!stratumIds.empty()) {
+            stratumIds.swap(strata);
+        }
+    } else {
+        nPatients = nGroups;
+    }
+    nStrata = 0;
+    nRows = nGroups;
+
+    forEachTask(nColumnTasks, [&](const size_t task) {
+        for (size_t j = columnBounds[task]; j < columnBounds[task + 1]; ++j) {
+            getColumn(j).selectRows(kept, group);
+        }
+    });
+
+    std::ostringstream stream;
+    stream << "Merged " << n << " rows into " << nGroups << " with distinct covariates";
+    log->writeLine(stream);
+
+    touchedY = true;
+    touchedX = true;
+
+    return n - nGroups;
+}
+
+FormatSelection ModelData::optimizeColumnFormats(const std::vector<size_t>& fixedColumns,
+		double memoryWeight, bool calibrated) {
+	std::vector<size_t> fixed(fixedColumns);
+	if (hasOffsetCovariate) {
+		fixed.push_back(0); // Values are read back as the offset
+	}
+
+	const FormatCostModel model(memoryWeight, calibrated);
+	if (calibrated) {
+		const FormatCostModel::Calibration& times = model.getTimes();
+		std::ostringstream stream;
+		stream << "Calibrated format costs (ns): dense row " << times.denseRow
+			<< ", intercept row " << times.interceptRow
+			<< ", sparse entry " << times.sparseEntry
+			<< ", indicator entry " << times.indicatorEntry
+			<< ", varint entry " << times.varintEntry
+			<< ", bitmap entry " << times.bitmapEntry
+			<< ", bitmap word " << times.bitmapWord
+			<< ", streamed byte " << times.streamByte;
+		log->writeLine(stream);
+	}
+	const int interceptColumn = hasInterceptCovariate ? (hasOffsetCovariate ? 1 : 0) : -1;
+	const FormatSelection selection = selectColumnFormats(model, fixed, interceptColumn);
+
+	std::ostringstream stream;
+	stream << "Column formats:";
+	for (const auto& count : selection.formatCounts) {
+		stream << " " << count.second << " " << count.first;
+	}
+	stream << "; converted " << selection.nConverted << " of " << getNumberOfColumns()
+		<< " columns, " << selection.bytesBefore << " -> " << selection.bytesAfter << " bytes";
+	log->writeLine(stream);
+
+	return selection;
 }
 
 std::vector<double> ModelData::normalizeCovariates(const NormalizationType type) {
@@ -546,7 +1420,7 @@ const string ModelData::getConditionId() const {
 }
 
 ModelData::~ModelData() {
-	// Do nothing
+	appendSession.reset(); // Joins its thread
 }
 
 const int* ModelData::getPidVector() const { // TODO deprecated
@@ -568,6 +1442,43 @@ std::vector<int> ModelData::getPidVectorSTL() const {
     }
 }
 
+std::vector<int> ModelData::getInputPidVectorSTL() const {
+    if (inputRows.empty()) {
+        return getPidVectorSTL();
+    } else if (!inputPid.empty()) {
+        return inputPid;
+    }
+    std::vector<int> tPid(inputRows.size());
+    if (pid.size() == 0) {
+        std::iota (std::begin(tPid), std::end(tPid), 0);
+    } else {
+        for (size_t i = 0; i < inputRows.size(); ++i) {
+            tPid[i] = pid[inputRows[i]];
+        }
+    }
+    return tPid;
+}
+
+RealVector ModelData::getRowMembers() const {
+    RealVector members;
+    if (getNumberOfInputRows() != getNumberOfRows()) {
+        members.assign(getNumberOfRows(), static_cast<real>(0));
+        for (const int row : inputRows) {
+            ++members[row];
+        }
+    }
+    return members;
+}
+
+int ModelData::getNumberOfInputPatients() const {
+    if (inputRows.empty()) {
+        return nPatients;
+    }
+    // Strata of the caller's rows are numbered from 0 in the order first loaded or sorted
+    const std::vector<int> strata = getInputPidVectorSTL();
+    return strata.empty() ? 0 : *std::max_element(strata.begin(), strata.end()) + 1;
+}
+
 const real* ModelData::getYVector() const { // TODO deprecated
 //	return makeDeepCopy(&y[0], y.size());
 	return &y[0];
@@ -599,8 +1510,22 @@ double ModelData::getSquaredNorm() const {
 
 	std::vector<double> squaredNorm;
 
+	// Rows merged by compressRows() count once per member
+	const RealVector members = getRowMembers();
+
 	for (size_t index = startIndex; index < getNumberOfColumns(); ++index) {
-		squaredNorm.push_back(getColumn(index).squaredSumColumn(getNumberOfRows()));
+		if (members.empty()) {
+			squaredNorm.push_back(getColumn(index).squaredSumColumn(getNumberOfRows()));
+		} else {
+			IntVector rows;
+			RealVector values;
+			getColumn(index).getNonZeros(rows, values, getNumberOfRows());
+			double sum = 0.0;
+			for (size_t k = 0; k < rows.size(); ++k) {
+				sum += members[rows[k]] * values[k] * values[k];
+			}
+			squaredNorm.push_back(sum);
+		}
 	}
 
 	return std::accumulate(squaredNorm.begin(), squaredNorm.end(), 0.0);
@@ -626,7 +1551,7 @@ size_t ModelData::getNumberOfStrata() const {
 double ModelData::getNormalBasedDefaultVar() const {
 // 	return getNumberOfVariableColumns() * getNumberOfRows() / getSquaredNorm();
 	// Reciprocal of what is reported in Genkins et al.
-	return getSquaredNorm() / getNumberOfVariableColumns() / getNumberOfRows();
+	return getSquaredNorm() / getNumberOfVariableColumns() / getNumberOfInputRows();
 }
 
 int ModelData::getNumberOfVariableColumns() const {
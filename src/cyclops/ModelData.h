@@ -25,11 +25,18 @@
 #include "CompressedDataMatrix.h"
 #include "io/ProgressLogger.h"
 #include "io/SparseIndexer.h"
+#include "RowIdIndex.h"
 
 //#define USE_DRUG_STRING
 
 namespace bsccs {
 
+// Read-only input columns, e.g. R vectors used in place
+typedef ArrayView<const IdType> IdView;
+typedef ArrayView<const double> DoubleView;
+
+class AppendSession;
+
 // template <class T> void reindexVector(std::vector<T>& vec, std::vector<int> ind) {
 // 	int n = (int) vec.size();
 // 	std::vector<T> temp = vec;
@@ -71,6 +78,7 @@ public:
 		, offs(_offs.begin(), _offs.end()) // copy
 		, sparseIndexer(*this)
 		, log(_log), error(_error)
+		, nThreads(-1)
 		, touchedY(true), touchedX(true)
 		{
 
@@ -79,27 +87,27 @@ public:
 	virtual ~ModelData();
 
 	size_t append(
-        const std::vector<IdType>& oStratumId,
-        const std::vector<IdType>& oRowId,
-        const std::vector<double>& oY,
-        const std::vector<double>& oTime,
-        const std::vector<IdType>& cRowId,
-        const std::vector<IdType>& cCovariateId,
-        const std::vector<double>& cCovariateValue
+        const IdView& oStratumId,
+        const IdView& oRowId,
+        const DoubleView& oY,
+        const DoubleView& oTime,
+        const IdView& cRowId,
+        const IdView& cCovariateId,
+        const DoubleView& cCovariateValue
     );
 
 
 	void loadY(
-		const std::vector<IdType>& stratumId,
-		const std::vector<IdType>& rowId,
-		const std::vector<double>& y,
-		const std::vector<double>& time
+		const IdView& stratumId,
+		const IdView& rowId,
+		const DoubleView& y,
+		const DoubleView& time
 	);
 
 	int loadX(
 		const IdType covariateId,
-		const std::vector<IdType>& rowId,
-		const std::vector<double>& covariateValue,
+		const IdView& rowId,
+		const DoubleView& covariateValue,
 		const bool reload,
 		const bool append,
 		const bool forceSparse
@@ -107,15 +115,31 @@ public:
 
 
 	int loadMultipleX(
-		const std::vector<int64_t>& covariateId,
-		const std::vector<int64_t>& rowId,
-		const std::vector<double>& covariateValue,
+		const IdView& covariateId,
+		const IdView& rowId,
+		const DoubleView& covariateValue,
 		const bool checkCovariateIds,
 		const bool checkCovariateBounds,
 		const bool append,
 		const bool forceSparse
 	);
 
+	// Threads for bulk loads (append, loadMultipleX); -1 uses all cores for large inputs
+	void setThreads(int threads) {
+		nThreads = threads;
+	}
+
+	// Appends batches on a background thread (see AppendSession); the data must not otherwise be
+	// used until the session ends
+	AppendSession& beginAppendSession(size_t maxQueuedBatches);
+
+	AppendSession* getAppendSession() const {
+		return appendSession.get();
+	}
+
+	// Waits for the queued batches and returns the rows appended; errors if a batch failed
+	size_t endAppendSession();
+
 	const int* getPidVector() const;
 	const real* getYVector() const;
 	void setYVector(std::vector<real> y_);
@@ -126,6 +150,9 @@ public:
 	const std::string getConditionId() const;
 	std::vector<int> getPidVectorSTL() const;
 
+	// Stratum of each of the caller's rows, numbered as before compressRows() merged any
+	std::vector<int> getInputPidVectorSTL() const;
+
 	const std::vector<real>& getZVectorRef() const {
 		return z;
 	}
@@ -178,16 +205,136 @@ public:
 		return (labels.size() == getNumberOfRows());
 	}
 
+	bool getHasInputRowLabels() const {
+		return inputLabels.empty() ? getHasRowLabels() : true;
+	}
+
 	bool getIsFinalized() const {
 	    return isFinalized;
 	}
 
 	void setIsFinalized(bool b) {
 	    isFinalized = b;
+	    if (b) {
+	        updateStorageAliases();
+	    }
 	}
 
 	void sortDataColumns(std::vector<int> sortedInds);
 
+	/**
+	 * Sorts the rows by stratum and, for Cox models, by decreasing time and then outcome, as the
+	 * likelihoods require, so rows may be loaded in any order.  Ties keep their input order.  The
+	 * outcomes, labels and every column are permuted in parallel; the row now holding each of the
+	 * caller's rows is kept in getInputRows().  Must precede packing and encoding.
+	 */
+	void sortRows();
+
+	// False if the rows of a stratum were loaded apart or strata were loaded out of order
+	bool getHasSortedStrata() const;
+
+	/**
+	 * Merges rows with identical covariates into one row.  For independent-row models (logistic,
+	 * Poisson, normal) rows must also share their outcome and time, and the number merged becomes
+	 * a frequency weight in getRowCounts().  For the self-controlled case series, rows merge within
+	 * a stratum and their outcomes and times are summed, which leaves the likelihood unchanged;
+	 * they are left as they are if a covariate column will become the offset (hasOffsetColumn),
+	 * whose values merged rows could not sum.  Other models are left as they are.  Returns the
+	 * number of rows removed.  Must precede packing and encoding.
+	 */
+	size_t compressRows(bool hasOffsetColumn = false);
+
+	// Rows as loaded by the caller, before compressRows() merged any
+	size_t getNumberOfInputRows() const {
+		return inputRows.empty() ? getNumberOfRows() : inputRows.size();
+	}
+
+	// Row holding each of the caller's rows if sortRows() or compressRows() moved any; else empty
+	const IntVector& getInputRows() const {
+		return inputRows;
+	}
+
+	// Number of the caller's rows merged into each row by compressRows(); else empty
+	const RealVector& getRowCounts() const {
+		return rowCounts;
+	}
+
+	// Number of the caller's rows held in each row, for any model, if compressRows() merged rows; else empty
+	RealVector getRowMembers() const;
+
+	// Strata of the caller's rows, counted as before compressRows() merged any
+	int getNumberOfInputPatients() const;
+
+	// Times whose log, times the outcome, gives each merged SCCS row's fixed likelihood term; else empty
+	const RealVector& getFixedTermTimeVectorRef() const {
+		return fixedTermTimes;
+	}
+
+	// True if compressRows() summed rows within strata rather than counting them as frequencies
+	bool getHasSummedRows() const {
+		return getNumberOfInputRows() != getNumberOfRows() && rowCounts.empty();
+	}
+
+	/**
+	 * Per-row values in the caller's order to the rows held.  A row merged as a frequency takes
+	 * the mean of its members; members of a summed row (see getHasSummedRows) must agree.
+	 */
+	template <typename T>
+	void toModelRows(const T* input, T* output) const {
+		const size_t nRows = getNumberOfRows();
+		if (inputRows.empty()) {
+			std::copy(input, input + nRows, output);
+			return;
+		}
+		if (getHasSummedRows()) {
+			std::vector<bool> seen(nRows, false);
+			for (size_t i = 0; i < inputRows.size(); ++i) {
+				const int row = inputRows[i];
+				if (seen[row] && output[row] != input[i]) {
+					std::ostringstream stream;
+					stream << "Rows merged within a stratum by compressRows must share their weight; "
+						<< "row " << (i + 1) << " differs";
+					error->throwError(stream);
+				}
+				output[row] = input[i];
+				seen[row] = true;
+			}
+			return;
+		}
+		std::vector<int> members(nRows, 0);
+		std::fill(output, output + nRows, static_cast<T>(0));
+		for (size_t i = 0; i < inputRows.size(); ++i) {
+			output[inputRows[i]] += input[i];
+			++members[inputRows[i]];
+		}
+		for (size_t k = 0; k < nRows; ++k) {
+			if (members[k] > 1) {
+				output[k] /= members[k];
+			}
+		}
+	}
+
+	// Per-row values of the rows held to the caller's order; members of a merged row share its value
+	template <typename T>
+	void toInputRows(const T* input, T* output) const {
+		if (inputRows.empty()) {
+			std::copy(input, input + getNumberOfRows(), output);
+			return;
+		}
+		for (size_t i = 0; i < inputRows.size(); ++i) {
+			output[i] = input[inputRows[i]];
+		}
+	}
+
+	/**
+	 * Re-chooses the storage format of every covariate with a FormatCostModel and logs a
+	 * summary; the offset covariate and fixedColumns keep their format.  Larger memoryWeight
+	 * favors smaller formats.  Costs come from the model's fixed table unless calibrated, when
+	 * they are measured on this machine and logged.
+	 */
+	FormatSelection optimizeColumnFormats(const std::vector<size_t>& fixedColumns,
+			double memoryWeight, bool calibrated = false);
+
 	double getSquaredNorm() const;
 
 	double getNormalBasedDefaultVar() const;
@@ -214,6 +361,19 @@ public:
 		}
 	}
 
+	// Label of the caller's i-th row
+	const std::string& getInputRowLabel(size_t i) const {
+		if (!inputLabels.empty()) {
+			return i < inputLabels.size() ? inputLabels[i] : missing;
+		}
+		return getRowLabel(inputRows.empty() ? i : inputRows[i]);
+	}
+
+	// Rows of the ids loaded by loadY
+	const RowIdIndex& getRowIdIndex() const {
+		return rowIdIndex;
+	}
+
 	void clean() const { touchedY = false; touchedX = false; }
 
 	const bool getTouchedY() const { return touchedY; }
@@ -227,6 +387,8 @@ public:
 	friend class CoxInputReader;
 	friend class CCTestInputReader;
 	friend class GenericSparseReader;
+	friend class ModelDataFile;
+	friend class AppendSession;
 
 	template <class FormatType, class MissingPolicy> friend class BaseInputReader;
 	template <class ImputationPolicy> friend class BBRInputReader;
@@ -249,6 +411,12 @@ protected:
 	IntVector nevents; // TODO Where are these used?
 	std::string conditionId;
 	std::vector<std::string> labels; // TODO Change back to 'long'
+	std::vector<IdType> stratumIds; // Input stratum of each pid, if loaded with strata
+	IntVector inputRows;
+	IntVector inputPid; // Strata of the caller's rows, if compressRows() merged rows across strata
+	RealVector rowCounts; // Frequency weights, if compressRows() merged rows
+	RealVector fixedTermTimes;
+	std::vector<std::string> inputLabels; // Caller's row labels, if compressRows() merged rows
 
 	int nTypes;
 
@@ -263,12 +431,25 @@ private:
 
     SparseIndexer sparseIndexer;
 
+	void appendCovariates(
+		size_t firstRow,
+		const std::vector<size_t>& rowStarts,
+		const IdView& oRowId,
+		const IdView& cCovariateId,
+		const DoubleView& cCovariateValue
+	);
+
+	size_t getLoadTasks(size_t nEntries) const;
+
 protected:
     loggers::ProgressLoggerPtr log;
     loggers::ErrorHandlerPtr error;
 
-    typedef bsccs::unordered_map<IdType,size_t> RowIdMap;
-    RowIdMap rowIdMap;
+    RowIdIndex rowIdIndex;
+
+    int nThreads;
+
+    bsccs::shared_ptr<AppendSession> appendSession;
 
 
     mutable bool touchedY;
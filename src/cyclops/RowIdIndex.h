@@ -0,0 +1,173 @@
+/*
+ * RowIdIndex.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: msuchard
+ */
+
+#ifndef ROWIDINDEX_H_
+#define ROWIDINDEX_H_
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <cstddef>
+
+#include "Types.h"
+#include "HashIndex.h"
+
+namespace bsccs {
+
+/**
+ * Maps row ids, e.g. from SQL, to row indices with as little memory as the ids allow.  Ids are
+ * added in turn; while each is one more than the last, lookups subtract the first (IDENTITY),
+ * while they increase, they are kept in a sorted array searched by interpolation (SORTED), and
+ * otherwise in a HashIndex (HASHED).  An id that breaks the current pattern moves the index to
+ * the next mode.  Rows are stored only once they differ from the order in which ids were added,
+ * e.g. after ModelData::sortRows or compressRows.  A repeated id maps to its last row.
+ */
+class RowIdIndex {
+public:
+
+	enum Mode {
+		IDENTITY, SORTED, HASHED
+	};
+
+	static const int NotFound = -1;
+
+	RowIdIndex() : mode(IDENTITY), first(0), count(0) { }
+
+	size_t size() const { return count; }
+
+	Mode getMode() const { return mode; }
+
+	void clear() {
+		mode = IDENTITY;
+		first = 0;
+		count = 0;
+		std::vector<IdType>().swap(ids);
+		hash.clear();
+		std::vector<int>().swap(rows);
+	}
+
+	void push_back(IdType id, int row) {
+		if (rows.empty() && row != static_cast<int>(count)) {
+			rows.resize(count);
+			std::iota(rows.begin(), rows.end(), 0);
+		}
+		if (!rows.empty()) {
+			rows.push_back(row);
+		}
+
+		if (mode == IDENTITY) {
+			if (count == 0) {
+				first = id;
+			} else if (id != first + static_cast<IdType>(count)) {
+				if (id > first + static_cast<IdType>(count)) {
+					toSorted();
+				} else {
+					toHashed();
+				}
+			}
+		} else if (mode == SORTED && id <= ids.back()) {
+			toHashed();
+		}
+
+		if (mode == SORTED) {
+			ids.push_back(id);
+		} else if (mode == HASHED) {
+			hash.assign(id, static_cast<int>(count));
+		}
+		++count;
+	}
+
+	int find(IdType id) const {
+		const int entry = findEntry(id);
+		return (entry == NotFound || rows.empty()) ? entry : rows[entry];
+	}
+
+	// The row of each id moves from r to position[r]
+	void permute(const IntVector& position) {
+		if (rows.empty()) {
+			rows.assign(position.begin(), position.begin() + count);
+		} else {
+			for (auto& row : rows) {
+				row = position[row];
+			}
+		}
+	}
+
+	size_t getStorageBytes() const {
+		return ids.capacity() * sizeof(IdType) + hash.getStorageBytes() +
+			rows.capacity() * sizeof(int);
+	}
+
+private:
+
+	static const int InterpolationSteps = 4;
+
+	int findEntry(IdType id) const {
+		switch (mode) {
+			case IDENTITY :
+				return (count == 0 || id < first || id - first >= static_cast<IdType>(count)) ?
+					NotFound : static_cast<int>(id - first);
+			case SORTED :
+				return search(id);
+			default :
+				return hash.find(id);
+		}
+	}
+
+	// A few interpolation steps narrow [lo, hi], then a binary search guards against skew
+	int search(IdType id) const {
+		size_t lo = 0;
+		size_t hi = ids.size() - 1;
+		for (int step = 0; step < InterpolationSteps && lo < hi; ++step) {
+			if (id < ids[lo] || id > ids[hi]) {
+				return NotFound;
+			}
+			const double fraction = (static_cast<double>(id) - static_cast<double>(ids[lo])) /
+				(static_cast<double>(ids[hi]) - static_cast<double>(ids[lo]));
+			const size_t guess = std::min(hi, lo + static_cast<size_t>(fraction * (hi - lo)));
+			if (ids[guess] == id) {
+				return static_cast<int>(guess);
+			} else if (ids[guess] < id) {
+				lo = guess + 1;
+			} else {
+				hi = guess;
+			}
+		}
+		const auto found = std::lower_bound(ids.begin() + lo, ids.begin() + hi + 1, id);
+		return (found != ids.begin() + hi + 1 && *found == id) ?
+			static_cast<int>(found - ids.begin()) : NotFound;
+	}
+
+	void toSorted() {
+		ids.resize(count);
+		std::iota(ids.begin(), ids.end(), first);
+		mode = SORTED;
+	}
+
+	void toHashed() {
+		if (mode == IDENTITY) {
+			toSorted();
+		}
+		hash.reserve(count + 1);
+		for (size_t k = 0; k < ids.size(); ++k) {
+			hash.insert(ids[k], static_cast<int>(k));
+		}
+		std::vector<IdType>().swap(ids);
+		mode = HASHED;
+	}
+
+	Mode mode;
+	IdType first; // IDENTITY
+	size_t count;
+	std::vector<IdType> ids; // SORTED
+	HashIndex<IdType> hash; // HASHED
+	std::vector<int> rows; // Row of the k-th id added; empty while the k-th id is at row k
+};
+
+} // namespace
+
+#endif /* ROWIDINDEX_H_ */
@@ -4,6 +4,8 @@
 #include <algorithm>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <chrono>
 #include "tinythread/tinythread.h"
 
 #if defined(_WIN32) || defined(__WIN32__) || defined(__WINDOWS__) || defined(WIN_BUILD)
@@ -16,11 +18,25 @@ namespace bsccs {
 #ifdef USE_TTHREAD
     using tthread::mutex;
     using tthread::thread;
+    using tthread::condition_variable; // wait() takes the locked mutex
 #else
     using std::mutex;
     using std::thread;
+    typedef std::condition_variable_any condition_variable;
 #endif
 
+// Waits on a condition for at most the given time, with m locked; tinythread has no timed wait,
+// so sleeps unlocked instead
+inline void waitFor(condition_variable& condition, mutex& m, const int milliseconds) {
+#ifdef USE_TTHREAD
+    m.unlock();
+    tthread::this_thread::sleep_for(tthread::chrono::milliseconds(milliseconds));
+    m.lock();
+#else
+    condition.wait_for(m, std::chrono::milliseconds(milliseconds));
+#endif
+}
+
 namespace threading {
     struct std_thread {};
     struct tthread_thread {};
@@ -94,9 +94,21 @@ void AbstractCrossValidationDriver::drive(
     }
 	// End of multi-thread set-up
 
+	// Fold-specific accumulation structures are re-used across all grid-points
+	auto accumulationCache = bsccs::make_shared<AccumulationCache>(
+		allArguments.crossValidation.foldToCompute);
+	for (auto element : ccdPool) {
+		element->setAccumulationCache(accumulationCache);
+	}
+
+	ccd.setUsePager(nThreads == 1); // Concurrent fits cannot share the pager
+
 	// Delegate to auto or grid loop
     maxPoint = doCrossValidationLoop(ccd, selector, allArguments, nThreads, ccdPool, selectorPool);
 
+	ccd.setAccumulationCache(nullptr);
+	ccd.setUsePager(true);
+
 	// Clean up
 	for (int i = 1; i < nThreads; ++i) {
 		delete ccdPool[i];
@@ -141,6 +153,9 @@ double AbstractCrossValidationDriver::doCrossValidationStep(
 	auto& weightsExclude = this->weightsExclude;
 	auto& logger = this->logger;
 
+	// Weights buffers are reused by all tasks on the same thread
+	std::vector<std::vector<real> > weightsPool(nThreads);
+
 	auto scheduler = TaskScheduler<decltype(boost::make_counting_iterator(0))>(
 		boost::make_counting_iterator(0),
 		boost::make_counting_iterator(arguments.foldToCompute),
@@ -149,7 +164,7 @@ double AbstractCrossValidationDriver::doCrossValidationStep(
 	auto oneTask =
 		[step, coldStart, nThreads, &ccdPool, &selectorPool,
 		&arguments, &allArguments, &predLogLikelihood,
-			&weightsExclude, &logger //, &lock
+			&weightsExclude, &logger, &weightsPool //, &lock
 		 //    ,&ccd, &selector
 		 		, &scheduler
 			](int task) {
@@ -173,7 +188,7 @@ double AbstractCrossValidationDriver::doCrossValidationStep(
 				int fold = task % arguments.fold;
 
 				// Get this fold and update
-				std::vector<real> weights; // Task-specific
+				std::vector<real>& weights = weightsPool[uniqueId];
 				selectorTask->getWeights(fold, weights);
 				if (weightsExclude){
 					for(size_t j = 0; j < weightsExclude->size(); j++){
@@ -182,7 +197,7 @@ double AbstractCrossValidationDriver::doCrossValidationStep(
 						}
 					}
 				}
-				ccdTask->setWeights(&weights[0]);
+				ccdTask->setWeights(&weights[0], task);
 
 				std::ostringstream stream;
 				stream << "Running at " << ccdTask->getPriorInfo() << " ";
@@ -7,6 +7,7 @@
 
 #include <iostream>
 #include <algorithm>
+#include <sstream>
 
 #include "AbstractSelector.h"
 
@@ -48,6 +49,47 @@ AbstractSelector::AbstractSelector(
 	}
 }
 
+void AbstractSelector::setInputRows(const std::vector<int>& rows, size_t nRows, bool summed) {
+	if (rows.size() != K) {
+		std::ostringstream stream;
+		stream << "Selector has " << K << " ids but " << rows.size() << " input rows";
+		error->throwError(stream);
+	}
+	if (summed && type == SelectorType::BY_ROW) {
+		std::ostringstream stream;
+		stream << "Rows merged within strata by compressRows cannot be selected by row; select by stratum";
+		error->throwError(stream);
+	}
+	inputRows = rows;
+	members.assign(nRows, 0);
+	for (const int row : inputRows) {
+		++members[row];
+	}
+}
+
+std::vector<real>& AbstractSelector::getInputWeights(std::vector<real>& weights) {
+	std::vector<real>& rowWeights = inputRows.empty() ? weights : inputWeights;
+	if (rowWeights.size() != K) {
+		rowWeights.resize(K);
+	}
+	return rowWeights;
+}
+
+void AbstractSelector::toHeldRows(std::vector<real>& weights) const {
+	if (inputRows.empty()) {
+		return;
+	}
+	weights.assign(members.size(), static_cast<real>(0));
+	for (size_t i = 0; i < K; ++i) {
+		weights[inputRows[i]] += inputWeights[i];
+	}
+	for (size_t k = 0; k < members.size(); ++k) {
+		if (members[k] > 1) {
+			weights[k] /= members[k];
+		}
+	}
+}
+
 AbstractSelector::~AbstractSelector() {
 // 	if (ids) {
 // 		delete ids;
@@ -45,7 +45,21 @@ public:
 	
 	virtual AbstractSelector* clone() const = 0; // pure virtual
 
+	/**
+	 * Draws over the caller's rows when ModelData has sorted or merged them (see
+	 * ModelData::getInputRows), so folds and replicates do not depend on either.  ids then hold
+	 * one entry per caller's row, and getWeights() returns one weight per row held: the mean over
+	 * its members, which CyclicCoordinateDescent scales by the row's count.  Rows summed within
+	 * strata (see ModelData::getHasSummedRows) cannot be split, so a BY_ROW selector is refused.
+	 */
+	void setInputRows(const std::vector<int>& rows, size_t nRows, bool summed);
+
 protected:
+	// Weights of ids' rows are filled here, then toHeldRows() maps them onto weights
+	std::vector<real>& getInputWeights(std::vector<real>& weights);
+
+	void toHeldRows(std::vector<real>& weights) const;
+
 	const std::vector<int> ids;
 	SelectorType type;
 	long seed;
@@ -53,6 +67,10 @@ protected:
 	size_t N;
 	bool deterministic;
 	std::mt19937 prng;
+
+	std::vector<int> inputRows;
+	std::vector<int> members; // Caller's rows in each row held
+	std::vector<real> inputWeights;
 	
 	
     loggers::ProgressLoggerPtr logger;
@@ -13,8 +13,12 @@
 #include <cmath>
 #include <sstream>
 
+#include "boost/iterator/counting_iterator.hpp"
+
+#include "Types.h"
+#include "Thread.h"
 #include "BootstrapDriver.h"
-#include "AbstractSelector.h"
+#include "BootstrapSelector.h"
 
 namespace bsccs {
 
@@ -27,21 +31,11 @@ BootstrapDriver::BootstrapDriver(
 		loggers::ErrorHandlerPtr _error		
 		) : AbstractDriver(_logger, _error), replicates(inReplicates), modelData(inModelData),
 		J(inModelData->getNumberOfColumns()) {
-
-	// Set-up storage for bootstrap estimates
-	estimates.resize(J);
-//	int count = 0;
-	for (rarrayIterator it = estimates.begin(); it != estimates.end(); ++it) {
-		*it = new rvector();
-	}
+	// Do nothing
 }
 
 BootstrapDriver::~BootstrapDriver() {
-	for (rarrayIterator it = estimates.begin(); it != estimates.end(); ++it) {
-		if (*it) {
-			delete *it;
-		}
-	}
+	// Do nothing
 }
 
 void BootstrapDriver::drive(
@@ -49,25 +43,142 @@ void BootstrapDriver::drive(
 		AbstractSelector& selector,
 		const CCDArguments& arguments) {
 
-	// TODO Make sure that selector is type-of BootstrapSelector
-	std::vector<real> weights;
+	BootstrapSelector* bootstrapSelector = dynamic_cast<BootstrapSelector*>(&selector);
+	if (bootstrapSelector == nullptr) {
+		std::ostringstream stream;
+		stream << "Bootstrap driver requires a bootstrap selector";
+		error->throwError(stream);
+	}
+
+	int nThreads = (arguments.threads == -1) ?
+		bsccs::thread::hardware_concurrency() :
+		arguments.threads;
+
+	if (nThreads < 1) {
+		nThreads = 1;
+	}
+	if (nThreads > replicates) {
+		nThreads = std::max(replicates, 1);
+	}
+
+	std::ostringstream stream2;
+	stream2 << "Using " << nThreads << " thread(s)";
+	logger->writeLine(stream2);
+
+	std::vector<CyclicCoordinateDescent*> ccdPool;
+	std::vector<BootstrapSelector*> selectorPool;
+
+	ccdPool.push_back(&ccd);
+	selectorPool.push_back(bootstrapSelector);
+
+	for (int i = 1; i < nThreads; ++i) {
+		ccdPool.push_back(ccd.clone());
+		selectorPool.push_back(static_cast<BootstrapSelector*>(bootstrapSelector->clone()));
+	}
+
+	// Check of poor allocation
+	bool allocationError = false;
+	for (auto element : ccdPool) {
+		if (element == nullptr) {
+			allocationError = true;
+		}
+	}
+
+	for (auto element : selectorPool) {
+		if (element == nullptr) {
+			allocationError = true;
+		}
+	}
+
+	if (allocationError) {
+		std::ostringstream errorStream;
+		errorStream << "Memory allocation error in multi-threaded bootstrap driver";
+		error->throwError(errorStream);
+	}
+
+	ccd.setUsePager(nThreads == 1); // Concurrent fits cannot share the pager
+
+	// Every replicate is warm-started from the point estimate
+	std::vector<double> pointEstimate(J);
+	for (int j = 0; j < J; ++j) {
+		pointEstimate[j] = ccd.getBeta(j);
+	}
 
-	for (int step = 0; step < replicates; step++) {
-		selector.permute();
-		selector.getWeights(0, weights);
-		ccd.setWeights(&weights[0]);
+	// Per-thread summaries are merged after all replicates complete
+	std::vector<std::vector<StreamingSummary> > threadSummaries(nThreads,
+			std::vector<StreamingSummary>(J));
+
+	const bool reportRaw = arguments.reportRawEstimates;
+	if (reportRaw) {
+		estimates.assign(J, rvector(replicates));
+	}
+
+	// Weights buffers are reused by all replicates on the same thread
+	std::vector<std::vector<real> > weightsPool(nThreads);
+
+	auto scheduler = TaskScheduler<decltype(boost::make_counting_iterator(0))>(
+		boost::make_counting_iterator(0),
+		boost::make_counting_iterator(replicates),
+		nThreads);
+
+	auto oneTask =
+		[this, reportRaw, &ccdPool, &selectorPool, &arguments, &pointEstimate,
+			&threadSummaries, &weightsPool, &scheduler](int replicate) {
+
+			const auto uniqueId = scheduler.getThreadIndex(replicate);
+			auto ccdTask = ccdPool[uniqueId];
+			auto selectorTask = selectorPool[uniqueId];
+
+			std::vector<real>& weights = weightsPool[uniqueId];
+			selectorTask->permute(replicate);
+			selectorTask->getWeights(0, weights);
+			ccdTask->setWeights(&weights[0]);
+			ccdTask->setBeta(pointEstimate);
+
+			std::ostringstream stream;
+			stream << "Running replicate #" << (replicate + 1);
+			logger->writeLine(stream);
+
+			ccdTask->update(arguments.modeFinding);
+
+			// Store point estimates
+			auto& summary = threadSummaries[uniqueId];
+			for (int j = 0; j < J; ++j) {
+				const double beta = ccdTask->getBeta(j);
+				summary[j].add(beta);
+				if (reportRaw) {
+					estimates[j][replicate] = beta;
+				}
+			}
+		};
 
-        std::ostringstream stream;
-		stream << std::endl << "Running replicate #" << (step + 1);
-		logger->writeLine(stream);
-		// Run CCD using a warm start
-		ccd.update(arguments.modeFinding);
+	// Run all replicates in parallel
+	if (nThreads > 1) {
+		ccd.getProgressLogger().setConcurrent(true);
+	}
+	scheduler.execute(oneTask);
+	if (nThreads > 1) {
+		ccd.getProgressLogger().setConcurrent(false);
+		ccd.getProgressLogger().flush();
+	}
 
-		// Store point estimates
+	summaries.swap(threadSummaries[0]);
+	for (int i = 1; i < nThreads; ++i) {
 		for (int j = 0; j < J; ++j) {
-			estimates[j]->push_back(ccd.getBeta(j));
-		}		
+			summaries[j].merge(threadSummaries[i][j]);
+		}
 	}
+
+	// Clean up
+	for (int i = 1; i < nThreads; ++i) {
+		delete ccdPool[i];
+		delete selectorPool[i];
+	}
+
+	// Restore point estimate
+	ccd.setWeights(NULL);
+	ccd.setBeta(pointEstimate);
+	ccd.setUsePager(true);
 }
 
 void BootstrapDriver::logResults(const CCDArguments& arguments) {
@@ -98,31 +209,15 @@ void BootstrapDriver::logResults(const CCDArguments& arguments, std::vector<doub
 			sep << conditionId << sep;
 		if (arguments.reportRawEstimates) {
 			ostream_iterator<real> output(outLog, sep.c_str());
-			copy(estimates[j]->begin(), estimates[j]->end(), output);
+			copy(estimates[j].begin(), estimates[j].end(), output);
 			outLog << endl;
 		} else {
-			real mean = 0.0;
-			real var = 0.0;
-			real prob0 = 0.0;
-			for (rvector::iterator it = estimates[j]->begin(); it != estimates[j]->end(); ++it) {
-				mean += *it;
-				var += *it * *it;
-				if (*it == 0.0) {
-					prob0 += 1.0;
-				}
-			}
-
-			real size = static_cast<real>(estimates[j]->size());
-			mean /= size;
-			var = (var / size) - (mean * mean);
-			prob0 /= size;
-
-			sort(estimates[j]->begin(), estimates[j]->end());
-			int offsetLower = static_cast<int>(size * 0.025);
-			int offsetUpper = static_cast<int>(size * 0.975);
-
-			real lower = *(estimates[j]->begin() + offsetLower);
-			real upper = *(estimates[j]->begin() + offsetUpper);
+			StreamingSummary& summary = summaries[j];
+			const real mean = summary.getMean();
+			const real var = summary.getVariance();
+			const real prob0 = summary.getProbabilityZero();
+			const real lower = summary.getQuantile(0.025);
+			const real upper = summary.getQuantile(0.975);
 
 			outLog << savedBeta[j] << sep;
 			outLog << std::sqrt(var) << sep << mean << sep << lower << sep << upper << sep << prob0 << endl;
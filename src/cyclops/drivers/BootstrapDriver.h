@@ -12,12 +12,12 @@
 
 #include "AbstractDriver.h"
 #include "ModelData.h"
+#include "StreamingSummary.h"
 
 namespace bsccs {
 
 typedef std::vector<real> rvector;
-typedef std::vector<rvector*> rarray;
-typedef	rarray::iterator rarrayIterator;
+typedef std::vector<rvector> rarray;
 
 class BootstrapDriver : public AbstractDriver {
 public:
@@ -43,7 +43,8 @@ private:
 	const int replicates;
 	ModelData* modelData;
 	const int J;
-	rarray estimates;
+	std::vector<StreamingSummary> summaries;
+	rarray estimates; // Only filled when raw estimates are reported
 };
 
 } // namespace
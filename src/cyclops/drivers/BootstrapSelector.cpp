@@ -6,6 +6,8 @@
  */
 
 #include <cstdlib>
+#include <cstdint>
+#include <cmath>
 #include <iostream>
 #include <sstream>
 
@@ -27,19 +29,16 @@ BootstrapSelector::BootstrapSelector(
 		<< " replicates [seed = " << seed << "]";
 	logger->writeLine(stream);
 
-	if(wtsExclude){
-		for(size_t i = 0; i < wtsExclude->size(); i++){
-			if(wtsExclude->at(i) == 0){
-				indicesIncluded.push_back(i);
+	excluded.resize(N, false);
+	if (wtsExclude) {
+		for (size_t i = 0; i < wtsExclude->size() && i < N; i++) {
+			if (wtsExclude->at(i) != 0) {
+				excluded[i] = true;
 			}
 		}
 	}
-	else{
-		for(size_t i = 0; i < N; i++){
-			indicesIncluded.push_back(i);
-		}
-	}
 
+	replicate = -1;
 	permute();
 }
 
@@ -51,54 +50,58 @@ AbstractSelector* BootstrapSelector::clone() const {
 	return new BootstrapSelector(*this);
 }
 
-void BootstrapSelector::permute() {
-	selectedSet.clear();
-
-	// Get non-excluded indices
-	int N_new = indicesIncluded.size();
-	if (type == SelectorType::BY_PID) {
-	    std::uniform_int_distribution<int> uniform(0, N_new - 1);
-		for (int i = 0; i < N_new; i++) {
-            int ind =  uniform(prng);
-			int draw = indicesIncluded[ind];
-			selectedSet.insert(draw);
-		}
-	} else {
-        std::ostringstream stream;
-        stream << "BootstrapSelector::permute is not yet implemented.";
-        error->throwError(stream);	
-	}
+namespace {
 
-//	int total = 0;
-//	for (int i = 0; i < N; i++) {
-//		int count = selectedSet.count(i);
-//		std::cout << i << " : " << count << std::endl;
-//		total += count;
-//	}
-//	std::cout << "Total = " << total << std::endl;
-//	exit(0);
+// SplitMix64 finalizer; a counter-based generator needs no state beyond its key
+inline uint64_t mix(uint64_t x) {
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
 }
 
-void BootstrapSelector::getWeights(int batch, std::vector<real>& weights) {
-	if (weights.size() != K) {
-		weights.resize(K);
-	}
+} // namespace
 
-	std::fill(weights.begin(), weights.end(), 0.0);
-	if (batch == -1) {
-		return;
+void BootstrapSelector::permute(int inReplicate) {
+	replicate = inReplicate;
+}
+
+void BootstrapSelector::permute() {
+	++replicate;
+}
+
+real BootstrapSelector::getPoissonWeight(size_t object) const {
+	// Poisson(1) draw keyed by (seed, replicate, object)
+	const uint64_t key = mix(mix(mix(static_cast<uint64_t>(seed)) ^
+			static_cast<uint64_t>(replicate)) ^ static_cast<uint64_t>(object));
+	const double u = (key >> 11) * (1.0 / 9007199254740992.0); // 2^-53
+
+	// Inverse CDF
+	int count = 0;
+	double probability = std::exp(-1.0);
+	double cdf = probability;
+	while (u > cdf && count < 32) {
+		++count;
+		probability /= count;
+		cdf += probability;
 	}
+	return static_cast<real>(count);
+}
 
-	if (type == SelectorType::BY_PID) {
+void BootstrapSelector::getWeights(int batch, std::vector<real>& heldWeights) {
+	std::vector<real>& weights = getInputWeights(heldWeights);
+
+	std::fill(weights.begin(), weights.end(), 0.0);
+	if (batch != -1) {
 		for (size_t k = 0; k < K; k++) {
-			int count = selectedSet.count(ids.at(k));
-			weights[k] = static_cast<real>(count);
+			const size_t object = (type == SelectorType::BY_PID) ? ids[k] : k;
+			if (!excluded[object]) {
+				weights[k] = getPoissonWeight(object);
+			}
 		}
-	} else {
-        std::ostringstream stream;
-        stream << "BootstrapSelector::getWeights is not yet implemented.";
-        error->throwError(stream);     
 	}
+
+	toHeldRows(heldWeights);
 }
 
 void BootstrapSelector::getComplement(std::vector<real>& weights) {
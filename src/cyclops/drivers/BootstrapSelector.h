@@ -8,7 +8,7 @@
 #ifndef BOOTSTRAPSELECTOR_H_
 #define BOOTSTRAPSELECTOR_H_
 
-#include <set>
+#include <vector>
 
 #include "AbstractSelector.h"
 
@@ -29,6 +29,9 @@ public:
 
 	virtual void permute();
 
+	// Select replicate-specific weights, independent of prior calls
+	void permute(int replicate);
+
 	virtual void getWeights(int batch, std::vector<real>& weights);
 
 	virtual void getComplement(std::vector<real>& weights);
@@ -36,8 +39,10 @@ public:
 	AbstractSelector* clone() const;
 
 private:
-	std::multiset<int> selectedSet;
-	std::vector<int> indicesIncluded;
+	real getPoissonWeight(size_t object) const;
+
+	int replicate;
+	std::vector<bool> excluded;
 };
 
 } // namespace
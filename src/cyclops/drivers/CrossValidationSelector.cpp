@@ -8,15 +8,13 @@
 #include <iostream>
 #include <algorithm>
 #include <iterator>
-#include <set>
+#include <limits>
 
 #include "CrossValidationSelector.h"
 
 namespace bsccs {
 
 using std::vector;
-using std::set;
-using std::insert_iterator;
 
 CrossValidationSelector::CrossValidationSelector(
 		int inFold,
@@ -51,51 +49,70 @@ CrossValidationSelector::CrossValidationSelector(
 	logger->writeLine(stream);
 
 	permutation.resize(N);
+	if (fold <= std::numeric_limits<uint8_t>::max()) {
+		foldId.resize(N);
+	}
 
 	weightsExclude = wtsExclude;
 }
 
+void CrossValidationSelector::assignFolds() {
+	if (foldId.size() == 0) {
+		return;
+	}
+	for (int batch = 0; batch < fold; ++batch) {
+		for (int i = intervalStart[batch]; i < intervalStart[batch + 1]; ++i) {
+			foldId[permutation[i]] = static_cast<uint8_t>(batch);
+		}
+	}
+}
+
 void CrossValidationSelector::reseed() {
 //	std::cerr << "RESEEDING"  << std::endl;
 	prng.seed(seed);
 	for (size_t i = 0; i < N; ++i) {
 		permutation[i] = i;
 	}
+	assignFolds();
 }
 
 CrossValidationSelector::~CrossValidationSelector() {
 	// Do nothing
 }
 
-void CrossValidationSelector::getWeights(int batch, std::vector<real>& weights) {
-	if (weights.size() != K) {
-		weights.resize(K);
-	}
+void CrossValidationSelector::getWeights(int batch, std::vector<real>& heldWeights) {
+	std::vector<real>& weights = getInputWeights(heldWeights);
 
 	std::fill(weights.begin(), weights.end(), 1.0);
 
 	if (batch == -1) {
-		return;
-	}
-
-	if (type == SelectorType::BY_PID) {
-		std::set<int> excludeSet;
-		std::copy(
-				permutation.begin() + intervalStart[batch],
-				permutation.begin() + intervalStart[batch + 1],
-				insert_iterator< std::set<int> >(excludeSet, excludeSet.begin())
-				);
+		// All rows
+	} else if (foldId.size() > 0) {
+		const uint8_t exclude = static_cast<uint8_t>(batch);
+		if (type == SelectorType::BY_PID) {
+			for (size_t k = 0; k < K; k++) {
+				weights[k] = (foldId[ids[k]] == exclude) ? 0.0 : 1.0;
+			}
+		} else { // SelectorType::BY_ROW
+			for (size_t k = 0; k < K; k++) {
+				weights[k] = (foldId[k] == exclude) ? 0.0 : 1.0;
+			}
+		}
+	} else if (type == SelectorType::BY_PID) { // Too many folds for compact ids
+		std::vector<bool> excluded(N, false);
+		std::for_each(
+			permutation.begin() + intervalStart[batch],
+			permutation.begin() + intervalStart[batch + 1],
+			[&excluded](const int excludeIndex) {
+				excluded[excludeIndex] = true;
+		});
 
 		for (size_t k = 0; k < K; k++) {
-			if (excludeSet.find(ids.at(k)) != excludeSet.end()) { // found
+			if (excluded[ids[k]]) {
 				weights[k] = 0.0;
-			} else {
-				weights[k] = 1.0; // TODO Is this necessary?
 			}
 		}
 	} else { // SelectorType::BY_ROW
-// 		std::fill(weights.begin(), weights.end(), 0.0);
-// 		std::fill(weights.begin(), weights.begin() + 100, 1.0);
 		std::for_each(
 			permutation.begin() + intervalStart[batch],
 			permutation.begin() + intervalStart[batch + 1],
@@ -103,6 +120,8 @@ void CrossValidationSelector::getWeights(int batch, std::vector<real>& weights)
 				weights[excludeIndex] = 0.0;
 		});
 	}
+
+	toHeldRows(heldWeights);
 }
 
 AbstractSelector* CrossValidationSelector::clone() const {
@@ -166,6 +185,8 @@ void CrossValidationSelector::permute() {
 			}
 		}
 	}
+
+	assignFolds();
 }
 
 } // namespace
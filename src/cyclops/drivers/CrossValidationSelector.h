@@ -9,6 +9,7 @@
 #define CROSSVALIDATION_H_
 
 #include <vector>
+#include <cstdint>
 
 #include "AbstractSelector.h"
 
@@ -38,9 +39,12 @@ public:
 	AbstractSelector* clone() const;
 
 private:
+	void assignFolds();
+
 	int fold;
 	std::vector<int> permutation;
 	std::vector<int> intervalStart;
+	std::vector<uint8_t> foldId; // Fold of each exchangeable object; empty if folds > 255
 	std::vector<real>* weightsExclude;
 };
 
@@ -0,0 +1,226 @@
+/*
+ * StreamingSummary.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ *
+ * Constant-memory summaries of a stream of scalar draws (e.g. bootstrap replicates of a
+ * single coefficient).  Summaries built on separate threads can be merged.
+ */
+
+#ifndef STREAMINGSUMMARY_H_
+#define STREAMINGSUMMARY_H_
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <cmath>
+
+namespace bsccs {
+
+/**
+ * Merging t-digest (Dunning & Ertl) for approximate quantiles.  Storage is O(compression),
+ * independent of the number of values added; tails are kept (nearly) exact.  New values wait
+ * in a short buffer of BufferLimit entries before being merged into the centroids.
+ */
+class TDigest {
+public:
+
+	static const size_t BufferLimit = 32;
+
+	TDigest(double compression = 100.0) : compression(compression), totalWeight(0.0),
+		unmergedWeight(0.0), min(std::numeric_limits<double>::infinity()),
+		max(-std::numeric_limits<double>::infinity()) { }
+
+	void add(double x, double weight = 1.0) {
+		buffer.push_back(Centroid(x, weight));
+		unmergedWeight += weight;
+		if (x < min) min = x;
+		if (x > max) max = x;
+		if (buffer.size() >= BufferLimit) {
+			compress();
+		}
+	}
+
+	void merge(const TDigest& other) {
+		buffer.insert(buffer.end(), other.centroids.begin(), other.centroids.end());
+		buffer.insert(buffer.end(), other.buffer.begin(), other.buffer.end());
+		unmergedWeight += other.totalWeight + other.unmergedWeight;
+		if (other.min < min) min = other.min;
+		if (other.max > max) max = other.max;
+		compress();
+	}
+
+	double quantile(double q) {
+		compress();
+		if (centroids.empty()) {
+			return std::numeric_limits<double>::quiet_NaN();
+		}
+		if (centroids.size() == 1) {
+			return centroids[0].mean;
+		}
+
+		const double index = q * totalWeight;
+		double center = centroids[0].weight / 2.0;
+		if (index <= center) { // Between min and first centroid
+			return min + (centroids[0].mean - min) * index / center;
+		}
+
+		for (size_t i = 1; i < centroids.size(); ++i) {
+			const double nextCenter = center + (centroids[i - 1].weight + centroids[i].weight) / 2.0;
+			if (index <= nextCenter) {
+				const double fraction = (index - center) / (nextCenter - center);
+				return centroids[i - 1].mean + fraction * (centroids[i].mean - centroids[i - 1].mean);
+			}
+			center = nextCenter;
+		}
+
+		// Between last centroid and max
+		const double tail = totalWeight - center;
+		const double fraction = (tail > 0.0) ? (index - center) / tail : 1.0;
+		return centroids.back().mean + std::min(fraction, 1.0) * (max - centroids.back().mean);
+	}
+
+	size_t getNumberOfCentroids() const { return centroids.size(); }
+
+private:
+
+	struct Centroid {
+		double mean;
+		double weight;
+
+		Centroid(double mean, double weight) : mean(mean), weight(weight) { }
+
+		bool operator<(const Centroid& rhs) const { return mean < rhs.mean; }
+	};
+
+	void compress() {
+		if (buffer.empty()) {
+			return;
+		}
+
+		std::sort(buffer.begin(), buffer.end());
+		std::vector<Centroid> sorted;
+		sorted.reserve(buffer.size() + centroids.size());
+		std::merge(buffer.begin(), buffer.end(), centroids.begin(), centroids.end(),
+			std::back_inserter(sorted));
+
+		if (buffer.capacity() > BufferLimit) { // Grown by merge()
+			std::vector<Centroid>().swap(buffer);
+		} else {
+			buffer.clear();
+		}
+
+		totalWeight += unmergedWeight;
+		unmergedWeight = 0.0;
+
+		centroids.clear();
+		Centroid current = sorted[0];
+		double weightSoFar = 0.0;
+
+		for (size_t i = 1; i < sorted.size(); ++i) {
+			const double proposed = current.weight + sorted[i].weight;
+			const double q0 = weightSoFar / totalWeight;
+			const double q2 = (weightSoFar + proposed) / totalWeight;
+			const double limit = 4.0 * totalWeight *
+				std::min(q0 * (1.0 - q0), q2 * (1.0 - q2)) / compression;
+
+			if (proposed <= limit) { // Absorb into current centroid
+				current.mean += (sorted[i].mean - current.mean) * sorted[i].weight / proposed;
+				current.weight = proposed;
+			} else {
+				weightSoFar += current.weight;
+				centroids.push_back(current);
+				current = sorted[i];
+			}
+		}
+		centroids.push_back(current);
+	}
+
+	double compression;
+	double totalWeight;
+	double unmergedWeight;
+	double min;
+	double max;
+	std::vector<Centroid> centroids;
+	std::vector<Centroid> buffer;
+};
+
+/**
+ * Running mean/variance (Welford), proportion of exact zeros and quantile sketch.  Exact zeros,
+ * common under L1 regularization, are only counted; the sketch holds the non-zero values.
+ */
+class StreamingSummary {
+public:
+
+	StreamingSummary(double compression = 100.0) : count(0), zeros(0), negatives(0), mean(0.0),
+		sumSquaredDeviations(0.0), digest(compression) { }
+
+	void add(double x) {
+		++count;
+		const double delta = x - mean;
+		mean += delta / count;
+		sumSquaredDeviations += delta * (x - mean);
+		if (x == 0.0) {
+			++zeros;
+		} else {
+			if (x < 0.0) {
+				++negatives;
+			}
+			digest.add(x);
+		}
+	}
+
+	void merge(const StreamingSummary& other) {
+		if (other.count == 0) {
+			return;
+		}
+		const long total = count + other.count;
+		const double delta = other.mean - mean;
+		mean += delta * other.count / total;
+		sumSquaredDeviations += other.sumSquaredDeviations +
+			delta * delta * static_cast<double>(count) * other.count / total;
+		count = total;
+		zeros += other.zeros;
+		negatives += other.negatives;
+		digest.merge(other.digest);
+	}
+
+	long getCount() const { return count; }
+
+	double getMean() const { return mean; }
+
+	double getVariance() const { // Population variance
+		return (count > 0) ? sumSquaredDeviations / count : 0.0;
+	}
+
+	double getProbabilityZero() const {
+		return (count > 0) ? static_cast<double>(zeros) / count : 0.0;
+	}
+
+	double getQuantile(double q) {
+		if (zeros == 0) {
+			return digest.quantile(q);
+		}
+		// Zeros sit between the negative and positive non-zero values
+		const double rank = q * count;
+		const long nonZeros = count - zeros;
+		if (nonZeros == 0 || (rank >= negatives && rank <= negatives + zeros)) {
+			return 0.0;
+		}
+		return digest.quantile(((rank < negatives) ? rank : rank - zeros) / nonZeros);
+	}
+
+private:
+	long count;
+	long zeros;
+	long negatives;
+	double mean;
+	double sumSquaredDeviations;
+	TDigest digest;
+};
+
+} // namespace
+
+#endif /* STREAMINGSUMMARY_H_ */
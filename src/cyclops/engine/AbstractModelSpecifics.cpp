@@ -104,7 +104,10 @@ AbstractModelSpecifics::AbstractModelSpecifics(const ModelData& input)
 	  hOffs(input.getTimeVectorRef()),
 // 	  hPid(const_cast<int*>(input.getPidVectorRef().data()))
 // 	  hPid(input.getPidVectorRef())
-      hPidOriginal(input.getPidVectorRef()), hPid(const_cast<int*>(hPidOriginal.data()))
+      hPidOriginal(input.getPidVectorRef()), hPid(const_cast<int*>(hPidOriginal.data())),
+      accumulationKey(-1),
+      hessianSparseCrossTerms(64 * 1024 * 1024),
+      xBetaVersion(0), crossTermVersion(0)
 	  {
 	// Do nothing
 }
@@ -113,11 +116,7 @@ AbstractModelSpecifics::~AbstractModelSpecifics() { }
 
 void AbstractModelSpecifics::makeDirty(void) {
 	hessianCrossTerms.erase(hessianCrossTerms.begin(), hessianCrossTerms.end());
-
-//	for (HessianSparseMap::iterator it = hessianSparseCrossTerms.begin();
-//			it != hessianSparseCrossTerms.end(); ++it) {
-//		delete it->second;
-//	}
+	hessianSparseCrossTerms.clear();
 }
 
 int AbstractModelSpecifics::getAlignedLength(int N) {
@@ -125,8 +124,37 @@ int AbstractModelSpecifics::getAlignedLength(int N) {
 }
 
 
+void AbstractModelSpecifics::setCachedPidForAccumulation(const real* weights) {
+
+	if (weights == nullptr || !accumulationCache || accumulationKey < 0 ||
+			static_cast<size_t>(accumulationKey) >= accumulationCache->size()) {
+		setPidForAccumulation(weights);
+		return;
+	}
+
+	// Each key is only ever written by a single task
+	AccumulationStructurePtr& cached = (*accumulationCache)[accumulationKey];
+	if (!cached) {
+		setPidForAccumulation(weights);
+
+		cached = bsccs::make_shared<AccumulationStructure>();
+		cached->pid.swap(hPidInternal);
+		cached->accReset = accReset;
+		cached->N = N;
+		cached->sparseIndices = sparseIndices;
+	} else {
+		accReset = cached->accReset;
+		N = cached->N;
+		sparseIndices = cached->sparseIndices;
+	}
+
+	currentAccumulation = cached;
+	hPid = const_cast<int*>(currentAccumulation->pid.data());
+}
+
 void AbstractModelSpecifics::setPidForAccumulation(const real* weights) {
 
+	currentAccumulation.reset();
 	hPidInternal =  hPidOriginal; // Make copy
 	hPid = hPidInternal.data(); // Point to copy
 	accReset.clear();
@@ -188,14 +216,15 @@ void AbstractModelSpecifics::setupSparseIndices(const int max) {
 	sparseIndices.clear(); // empty if full!
 
 	for (size_t j = 0; j < J; ++j) {
-		if (modelData.getFormatType(j) == DENSE || modelData.getFormatType(j) == INTERCEPT) {
+		const int alias = modelData.getStorageAlias(j);
+		if (alias != static_cast<int>(j)) { // Same rows as an earlier column
+			sparseIndices.push_back(sparseIndices[alias]);
+		} else if (modelData.getFormatType(j) == DENSE || modelData.getFormatType(j) == INTERCEPT) {
 			sparseIndices.push_back(NULL);
 		} else {
 			std::set<int> unique;
-			const size_t n = modelData.getNumberOfEntries(j);
-			const int* indicators = modelData.getCompressedColumnVector(j);
-			for (size_t j = 0; j < n; j++) { // Loop through non-zero entries only
-				const int k = indicators[j];
+			for (GenericIterator it(modelData, j); it; ++it) { // Loop through non-zero entries only
+				const int k = it.index();
 				const int i = hPid[k];  // TODO container-overflow #Generate some simulated data: #Fit the model
 				if (i < max) {
 					unique.insert(i);
@@ -14,6 +14,7 @@
 #include <cstddef>
 
 #include "Types.h"
+#include "LruCache.h"
 
 namespace bsccs {
 
@@ -32,6 +33,21 @@ enum class ModelType; // forward declaration
 // #define DEBUG_COX_MIN
 // #define DEBUG_POISSON
 
+/**
+ * Derived structures for accumulating over risk-sets / strata under a given weight mask;
+ * these only depend on which rows carry non-zero weight
+ */
+struct AccumulationStructure {
+	IntVector pid;
+	IntVector accReset;
+	size_t N;
+	std::vector<IntVectorPtr> sparseIndices;
+};
+
+typedef bsccs::shared_ptr<AccumulationStructure> AccumulationStructurePtr;
+typedef std::vector<AccumulationStructurePtr> AccumulationCache; // One slot per weights key
+typedef bsccs::shared_ptr<AccumulationCache> AccumulationCachePtr;
+
 class AbstractModelSpecifics {
 public:
 //	AbstractModelSpecifics(
@@ -69,6 +85,10 @@ public:
 	virtual void computeFisherInformation(int indexOne, int indexTwo,
 			double *oinfo, bool useWeights) = 0; // pure virtual
 
+	// Fills column-major indices.size()-by-indices.size() information matrix
+	virtual void computeFisherInformationMatrix(const std::vector<int>& indices,
+			double *oinfo, int nThreads, bool useWeights) = 0; // pure virtual
+
 	virtual void updateXBeta(real realDelta, int index, bool useWeights) = 0; // pure virtual
 
 	virtual void computeRemainingStatistics(bool useWeights) = 0; // pure virtual
@@ -100,11 +120,29 @@ public:
 	
 	RealVector& getXBetaSave() {  return hXBetaSave; }
 
+	void setAccumulationCache(AccumulationCachePtr cache) { accumulationCache = cache; }
+
+	// Weights set under the same key must share the same zero pattern
+	void setAccumulationKey(int key) { accumulationKey = key; }
+
+	// Memory budget (bytes) for per-stratum cross-terms used in Fisher information
+	void setCrossTermCacheBudget(size_t bytes) { hessianSparseCrossTerms.setBudget(bytes); }
+
+	size_t getCrossTermCacheHits() const { return hessianSparseCrossTerms.getHits(); }
+
+	size_t getCrossTermCacheMisses() const { return hessianSparseCrossTerms.getMisses(); }
+
+	size_t getCrossTermCacheBytes() const { return hessianSparseCrossTerms.getBytes(); }
+
+	void resetCrossTermCacheCounters() { hessianSparseCrossTerms.resetCounters(); }
+
 protected:
 
 	int getAlignedLength(int N);
 	
 	void setPidForAccumulation(const real *weights);
+
+	void setCachedPidForAccumulation(const real *weights);
 	
 	void setupSparseIndices(const int max);	
 
@@ -155,6 +193,10 @@ protected:
 	const std::vector<int>& hPidOriginal;
 	int* hPid;	
 	std::vector<int> hPidInternal;
+
+	AccumulationCachePtr accumulationCache;
+	AccumulationStructurePtr currentAccumulation; // Keeps cached hPid alive
+	int accumulationKey;
 	
 //	int** hXColumnRowIndicators; // J-vector
 
@@ -200,8 +242,20 @@ protected:
 	HessianMap hessianCrossTerms;
 
     typedef bsccs::shared_ptr<CompressedDataColumn> CDCPtr;
-	typedef std::map<int, CDCPtr> HessianSparseMap;
-	HessianSparseMap hessianSparseCrossTerms;
+	typedef LruCache<int, CDCPtr> HessianSparseCache;
+	HessianSparseCache hessianSparseCrossTerms;
+
+	// Cross-terms depend on xBeta; they are dropped on the first read after it changes, not on
+	// every update
+	size_t xBetaVersion;
+	size_t crossTermVersion;
+
+	void checkCrossTermVersion() {
+		if (crossTermVersion != xBetaVersion) {
+			makeDirty();
+			crossTermVersion = xBetaVersion;
+		}
+	}
 	
 	typedef std::vector<int> TimeTie;
 	std::vector<TimeTie> ties;
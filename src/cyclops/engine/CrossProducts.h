@@ -0,0 +1,175 @@
+/*
+ * CrossProducts.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: msuchard
+ */
+
+#ifndef CROSSPRODUCTS_H_
+#define CROSSPRODUCTS_H_
+
+#include <vector>
+#include <algorithm>
+
+#include <boost/iterator/counting_iterator.hpp>
+
+#include "Types.h"
+#include "Thread.h"
+
+namespace bsccs {
+
+// Compressed-sparse-column storage for a subset of columns
+struct SparseColumns {
+
+	SparseColumns() : start(1, 0) { }
+
+	void push_back(int row, real value) {
+		rows.push_back(row);
+		values.push_back(value);
+	}
+
+	void finishColumn() { start.push_back(rows.size()); }
+
+	size_t getNumberOfColumns() const { return start.size() - 1; }
+
+	size_t getNumberOfEntries(size_t j) const { return start[j + 1] - start[j]; }
+
+	const int* getRows(size_t j) const { return rows.data() + start[j]; }
+
+	const real* getValues(size_t j) const { return values.data() + start[j]; }
+
+	std::vector<size_t> start;
+	std::vector<int> rows;
+	std::vector<real> values;
+};
+
+// Columns stored elsewhere, read in place; their storage must outlive the views
+struct SparseColumnViews {
+
+	void push_back(const int* columnRows, const real* columnValues, size_t length) {
+		rows.push_back(columnRows);
+		values.push_back(columnValues);
+		lengths.push_back(length);
+	}
+
+	size_t getNumberOfColumns() const { return rows.size(); }
+
+	size_t getNumberOfEntries(size_t j) const { return lengths[j]; }
+
+	const int* getRows(size_t j) const { return rows[j]; }
+
+	const real* getValues(size_t j) const { return values[j]; }
+
+	std::vector<const int*> rows;
+	std::vector<const real*> values;
+	std::vector<size_t> lengths;
+};
+
+/**
+ * Row-major (CSR) copy of the columns, with nRows rows; columns are visited in order, so each
+ * row stays sorted by column.
+ */
+struct SparseRows {
+
+	template <typename Columns>
+	SparseRows(const Columns& byColumn, const size_t nRows) : start(nRows + 1, 0) {
+		const size_t p = byColumn.getNumberOfColumns();
+		for (size_t j = 0; j < p; ++j) {
+			const int* columnRows = byColumn.getRows(j);
+			for (size_t e = 0; e < byColumn.getNumberOfEntries(j); ++e) {
+				++start[columnRows[e] + 1];
+			}
+		}
+		for (size_t r = 0; r < nRows; ++r) {
+			start[r + 1] += start[r];
+		}
+		columns.resize(start[nRows]);
+		values.resize(start[nRows]);
+		std::vector<size_t> next(start.begin(), start.end() - 1);
+		for (size_t j = 0; j < p; ++j) {
+			const int* columnRows = byColumn.getRows(j);
+			const real* columnValues = byColumn.getValues(j);
+			for (size_t e = 0; e < byColumn.getNumberOfEntries(j); ++e) {
+				const size_t position = next[columnRows[e]]++;
+				columns[position] = static_cast<int>(j);
+				values[position] = columnValues[e];
+			}
+		}
+	}
+
+	std::vector<size_t> start;
+	std::vector<int> columns;
+	std::vector<real> values;
+};
+
+/**
+ * Adds scale * A^t diag(weights) A to the upper triangle of the column-major p-by-p matrix 'out',
+ * where A is given column by column (SparseColumns or SparseColumnViews) with nRows rows.  A
+ * row-major copy of A is built once so that each output column j is a single sparse-dense
+ * product; columns j and p - 1 - j form one task to balance the triangular work across threads.
+ * Each output entry is written by one task only.
+ */
+template <typename Columns, typename RealType>
+void addWeightedCrossProduct(const Columns& columns, const std::vector<RealType>& weights,
+		const size_t nRows, const double scale, double* out, const int nThreads) {
+
+	const size_t p = columns.getNumberOfColumns();
+	if (p == 0) {
+		return;
+	}
+
+	const SparseRows byRow(columns, nRows);
+
+	const size_t nTasks = (p + 1) / 2;
+	auto scheduler = TaskScheduler<boost::counting_iterator<size_t> >(
+		boost::make_counting_iterator(static_cast<size_t>(0)),
+		boost::make_counting_iterator(nTasks),
+		std::max(1, nThreads));
+
+	std::vector<std::vector<double> > buffers(std::max(1, nThreads), std::vector<double>());
+
+	auto oneColumn = [&](const size_t j, std::vector<double>& sum) {
+		std::fill(sum.begin(), sum.begin() + j + 1, 0.0);
+		const int* columnRows = columns.getRows(j);
+		const real* columnValues = columns.getValues(j);
+		for (size_t e = 0; e < columns.getNumberOfEntries(j); ++e) {
+			const int k = columnRows[e];
+			const double x = weights[k] * columnValues[e];
+			for (size_t r = byRow.start[k]; r < byRow.start[k + 1]; ++r) {
+				const int i = byRow.columns[r];
+				if (static_cast<size_t>(i) > j) break;
+				sum[i] += x * byRow.values[r];
+			}
+		}
+		double* column = out + j * p;
+		for (size_t i = 0; i <= j; ++i) {
+			column[i] += scale * sum[i];
+		}
+	};
+
+	auto oneTask = [&](const size_t task) {
+		std::vector<double>& sum = buffers[scheduler.getThreadIndex(task)];
+		if (sum.size() != p) {
+			sum.resize(p);
+		}
+		oneColumn(task, sum);
+		if (p - 1 - task != task) {
+			oneColumn(p - 1 - task, sum);
+		}
+	};
+
+	scheduler.execute(oneTask);
+}
+
+// Copies the upper triangle of a column-major p-by-p matrix into its lower triangle
+inline void symmetrizeFromUpper(double* out, const size_t p) {
+	for (size_t j = 0; j < p; ++j) {
+		for (size_t i = 0; i < j; ++i) {
+			out[i * p + j] = out[j * p + i];
+		}
+	}
+}
+
+} // namespace
+
+#endif /* CROSSPRODUCTS_H_ */
@@ -0,0 +1,121 @@
+/*
+ * LruCache.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: msuchard
+ */
+
+#ifndef LRUCACHE_H_
+#define LRUCACHE_H_
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <cstddef>
+
+namespace bsccs {
+
+/**
+ * Least-recently-used cache bounded by a budget in bytes.  Callers supply the size of each value
+ * on insertion; values are handed out by copy (e.g. shared_ptr), so evicting an entry never
+ * invalidates a value that is still in use.
+ */
+template <typename Key, typename Value>
+class LruCache {
+public:
+
+	LruCache(size_t budget) : budget(budget), bytes(0), hits(0), misses(0) { }
+
+	// Returns true and moves entry to front on hit
+	bool find(const Key& key, Value& value) {
+		auto it = map.find(key);
+		if (it == map.end()) {
+			++misses;
+			return false;
+		}
+		++hits;
+		entries.splice(entries.begin(), entries, it->second);
+		value = it->second->value;
+		return true;
+	}
+
+	void insert(const Key& key, const Value& value, size_t size) {
+		erase(key);
+		if (size > budget) { // Never fits
+			return;
+		}
+		while (bytes + size > budget) {
+			evictLeastRecent();
+		}
+		entries.push_front(Entry(key, value, size));
+		map[key] = entries.begin();
+		bytes += size;
+	}
+
+	void erase(const Key& key) {
+		auto it = map.find(key);
+		if (it != map.end()) {
+			bytes -= it->second->size;
+			entries.erase(it->second);
+			map.erase(it);
+		}
+	}
+
+	void clear() {
+		if (entries.empty()) { // Cheap enough to call on every change to what is cached
+			return;
+		}
+		entries.clear();
+		map.clear();
+		bytes = 0;
+	}
+
+	void setBudget(size_t newBudget) {
+		budget = newBudget;
+		while (bytes > budget) {
+			evictLeastRecent();
+		}
+	}
+
+	size_t getBudget() const { return budget; }
+
+	size_t getBytes() const { return bytes; }
+
+	size_t size() const { return map.size(); }
+
+	size_t getHits() const { return hits; }
+
+	size_t getMisses() const { return misses; }
+
+	void resetCounters() { hits = misses = 0; }
+
+private:
+
+	struct Entry {
+		Key key;
+		Value value;
+		size_t size;
+
+		Entry(const Key& key, const Value& value, size_t size) : key(key), value(value), size(size) { }
+	};
+
+	typedef std::list<Entry> EntryList;
+
+	void evictLeastRecent() {
+		const Entry& last = entries.back();
+		bytes -= last.size;
+		map.erase(last.key);
+		entries.pop_back();
+	}
+
+	size_t budget;
+	size_t bytes;
+	size_t hits;
+	size_t misses;
+	EntryList entries;
+	std::unordered_map<Key, typename EntryList::iterator> map;
+};
+
+} // namespace
+
+#endif /* LRUCACHE_H_ */
@@ -168,6 +168,11 @@ inline std::ostream& operator<<(std::ostream& stream, const OneValue& rhs) {
     return stream;
 }
 
+// Stands in for a PairProductIterator to extract per-row Fisher information weights
+struct UnitValue {
+	real value() const { return static_cast<real>(1); }
+};
+
 // struct ParallelInfo { };
 //
 // struct SerialOnly { };
@@ -191,6 +196,9 @@ protected:
 
 	void computeFisherInformation(int indexOne, int indexTwo, double *oinfo, bool useWeights);
 
+	void computeFisherInformationMatrix(const std::vector<int>& indices, double *oinfo,
+			int nThreads, bool useWeights);
+
 	void updateXBeta(real realDelta, int index, bool useWeights);
 
 	void computeRemainingStatistics(bool useWeights);
@@ -207,6 +215,8 @@ protected:
 
 	double getPredictiveLogLikelihood(real* weights);
 
+	real getHeldOutLogLikelihood(const real* weights);
+
 	void getPredictiveEstimates(real* y, real* weights);
 
 	bool allocateXjY(void);
@@ -234,12 +244,21 @@ private:
 			double *gradient,
 			double *hessian, Weights w);
 
+	template <class Encoding, class Weights>
+	void computeGradientAndHessianEncodedImpl(
+			int index,
+			double *gradient,
+			double *hessian, Weights w);
+
 	template <class IteratorType>
 	void incrementNumeratorForGradientImpl(int index);
 
 	template <class IteratorType>
 	void updateXBetaImpl(real delta, int index, bool useWeights);
 
+	template <class Encoding>
+	void updateXBetaEncodedImpl(real delta, int index, bool useWeights);
+
 	template <class OutType, class InType>
 	void incrementByGroup(OutType* values, int* groups, int k, InType inc) {
 		values[BaseModel::getGroup(groups, k)] += inc; // TODO delegate to BaseModel (different in tied-models)
@@ -252,7 +271,13 @@ private:
 	void computeFisherInformationImpl(int indexOne, int indexTwo, double *oinfo, Weights w);
 
 	template<class IteratorType>
-	SparseIterator getSubjectSpecificHessianIterator(int index);
+	CDCPtr computeSubjectSpecificHessianColumn(int index);
+
+	template<class IteratorType>
+	CDCPtr getSubjectSpecificHessianColumn(int index);
+
+	// Computes every column missing from the cache in one pass over the strata
+	std::vector<CDCPtr> getSubjectSpecificHessianColumns(const std::vector<int>& indices);
 
 	void computeXjY(bool useCrossValidation);
 
@@ -267,6 +292,7 @@ private:
 //	std::vector<real> nY;
 	std::vector<int> hNtoK;
 
+
 	struct WeightedOperation {
 		const static bool isWeighted = true;
 	} weighted;
@@ -1457,8 +1483,9 @@ public:
 		return std::exp(xBeta);
 	}
 
+	// ni is the row's weight, as in glm(weights =)
 	real logLikeDenominatorContrib(WeightType ni, real denom) {
-		return std::log(denom);
+		return ni * std::log(denom);
 	}
 
 	real logPredLikeContrib(real y, real weight, real xBeta, real denominator) {
@@ -1874,8 +1901,9 @@ public:
 		return std::exp(xBeta);
 	}
 
-	real logLikeDenominatorContrib(int ni, real denom) {
-		return denom;
+	// ni is the row's weight, as in glm(weights =)
+	real logLikeDenominatorContrib(WeightType ni, real denom) {
+		return ni * denom;
 	}
 
 	real logPredLikeContrib(real y, real weight, real xBeta, real denominator) {
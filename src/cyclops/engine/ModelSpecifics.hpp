@@ -23,12 +23,15 @@
 #include "Recursions.hpp"
 #include "ParallelLoops.h"
 #include "Ranges.h"
+#include "CrossProducts.h"
 
 #ifdef CYCLOPS_DEBUG_TIMING
 	#include "Timing.h"
 	namespace bsccs {
 		const std::string DenseIterator::name = "Den";
 		const std::string IndicatorIterator::name = "Ind";
+		template <> const std::string CompressedIndicatorIterator::name = "Cmp";
+		const std::string BitmapIndicatorIterator::name = "Bmp";
 		const std::string SparseIterator::name = "Spa";
 		const std::string InterceptIterator::name = "Icp";
 	}
@@ -243,27 +246,29 @@ namespace helper {
         };
     }
 
-    auto getRangeX(const CompressedDataMatrix& mat, const int index, IndicatorTag) ->
+    auto getRangeX(const IntView& rows, IndicatorTag) ->
 //            aux::zipper_range<
 						boost::iterator_range<
  						boost::zip_iterator<
  						boost::tuple<
-	            decltype(begin(mat.getCompressedColumnVector(index)))
+	            decltype(rows.begin())
 	          >
 	          >
             > {
 
-        auto i = begin(mat.getCompressedColumnVector(index));
-		const size_t K = mat.getNumberOfEntries(index);
-
         return {
             boost::make_zip_iterator(
-                boost::make_tuple(i)),
+                boost::make_tuple(rows.begin())),
             boost::make_zip_iterator(
-                boost::make_tuple(i + K))
+                boost::make_tuple(rows.end()))
         };
     }
 
+    auto getRangeX(const CompressedDataMatrix& mat, const int index, IndicatorTag) ->
+            decltype(getRangeX(mat.getCompressedColumnVectorSTL(index), IndicatorTag())) {
+        return getRangeX(mat.getCompressedColumnVectorSTL(index), IndicatorTag());
+    }
+
 } // namespace helper
 
 
@@ -351,7 +356,7 @@ void ModelSpecifics<BaseModel,WeightType>::setWeights(real* inWeights, bool useC
 	}
 
 	if (initializeAccumulationVectors()) {
-		setPidForAccumulation(inWeights);
+		setCachedPidForAccumulation(inWeights);
 	}
 
 	// Set N weights (these are the same for independent data models
@@ -374,6 +379,11 @@ void ModelSpecifics<BaseModel,WeightType>::setWeights(real* inWeights, bool useC
 template<class BaseModel, typename WeightType>
 void ModelSpecifics<BaseModel, WeightType>::computeXjY(bool useCrossValidation) {
 	for (size_t j = 0; j < J; ++j) {
+		const int alias = modelData.getStorageAlias(j);
+		if (alias != static_cast<int>(j)) { // Same contents as an earlier column
+			hXjY[j] = hXjY[alias];
+			continue;
+		}
 		hXjY[j] = 0;
 
 		GenericIterator it(modelData, j);
@@ -406,6 +416,11 @@ void ModelSpecifics<BaseModel, WeightType>::computeXjY(bool useCrossValidation)
 template<class BaseModel, typename WeightType>
 void ModelSpecifics<BaseModel, WeightType>::computeXjX(bool useCrossValidation) {
 	for (size_t j = 0; j < J; ++j) {
+		const int alias = modelData.getStorageAlias(j);
+		if (alias != static_cast<int>(j)) { // Same contents as an earlier column
+			hXjX[j] = hXjX[alias];
+			continue;
+		}
 		hXjX[j] = 0;
 		GenericIterator it(modelData, j);
 
@@ -452,14 +467,17 @@ void ModelSpecifics<BaseModel,WeightType>::computeFixedTermsInLogLikelihood(bool
 	if(BaseModel::likelihoodHasFixedTerms) {
 		logLikelihoodFixedTerm = 0.0;
 	    bool hasOffs = hOffs.size() > 0;
+	    // Rows merged by ModelData::compressRows() keep their fixed terms through these times
+	    const RealVector& fixedOffs = modelData.getFixedTermTimeVectorRef();
+	    const real* offsets = (fixedOffs.size() == K) ? fixedOffs.data() : (hasOffs ? hOffs.data() : nullptr);
 		if(useCrossValidation) {
 			for(size_t i = 0; i < K; i++) {
-			    auto offs = hasOffs ? hOffs[i] : 0.0;
+			    auto offs = offsets ? offsets[i] : 0.0;
 				logLikelihoodFixedTerm += BaseModel::logLikeFixedTermsContrib(hY[i], offs, offs) * hKWeight[i];
 			}
 		} else {
 			for(size_t i = 0; i < K; i++) {
-			    auto offs = hasOffs ? hOffs[i] : 0.0;
+			    auto offs = offsets ? offsets[i] : 0.0;
 				logLikelihoodFixedTerm += BaseModel::logLikeFixedTermsContrib(hY[i], offs, offs); // TODO SEGV in Poisson model
 			}
 		}
@@ -562,24 +580,70 @@ double ModelSpecifics<BaseModel,WeightType>::getLogLikelihood(bool useCrossValid
 }
 
 template <class BaseModel,typename WeightType>
-double ModelSpecifics<BaseModel,WeightType>::getPredictiveLogLikelihood(real* weights) {
+real ModelSpecifics<BaseModel,WeightType>::getHeldOutLogLikelihood(const real* weights) {
 
-    std::vector<real> saveKWeight;
-	if(BaseModel::cumulativeGradientAndHessian)	{
+	// Single pass over held-out rows, mirroring the risk-set construction in
+	// setPidForAccumulation(); training statistics are left untouched
+	real logLikelihood = static_cast<real>(0);
+	real accDenom = static_cast<real>(0);
 
- 		saveKWeight = hKWeight; // make copy
+	real groupDenom = BaseModel::getDenomNullValue();
+	real groupNumer = static_cast<real>(0); // sum of y * w * xBeta in tied group
+	real groupEvents = static_cast<real>(0); // sum of y * w in tied group
 
-// 		std::vector<int> savedPid = hPidInternal; // make copy
-// 		std::vector<int> saveAccReset = accReset; // make copy
-		setPidForAccumulation(weights);
-		computeRemainingStatistics(true); // compute accDenomPid
+	bool first = true;
+	int lastPid = 0;
+	real lastTime = static_cast<real>(0);
+	real lastEvent = static_cast<real>(0);
 
-    }
+	for (size_t k = 0; k < K; ++k) {
+		if (weights[k] == 0.0) {
+			continue;
+		}
+
+		const int nextPid = hPidOriginal[k];
+		const bool newStratum = first || nextPid != lastPid;
+		const bool tied = !newStratum && lastEvent == 1.0 && lastTime == hOffs[k] && lastEvent == hY[k];
+
+		if (!first && !tied) { // Close previous risk-set
+			accDenom += groupDenom;
+			logLikelihood += groupNumer - groupEvents * std::log(accDenom);
+			groupDenom = BaseModel::getDenomNullValue();
+			groupNumer = static_cast<real>(0);
+			groupEvents = static_cast<real>(0);
+		}
+		if (newStratum) {
+			accDenom = static_cast<real>(0);
+		}
+
+		groupDenom += BaseModel::getOffsExpXBeta(hOffs.data(), hXBeta[k], hY[k], k);
+		groupNumer += hY[k] * weights[k] * hXBeta[k];
+		groupEvents += hY[k] * weights[k];
+
+		first = false;
+		lastPid = nextPid;
+		lastTime = hOffs[k];
+		lastEvent = hY[k];
+	}
+
+	if (!first) {
+		accDenom += groupDenom;
+		logLikelihood += groupNumer - groupEvents * std::log(accDenom);
+	}
+
+	return logLikelihood;
+}
+
+template <class BaseModel,typename WeightType>
+double ModelSpecifics<BaseModel,WeightType>::getPredictiveLogLikelihood(real* weights) {
+
+	if (BaseModel::cumulativeGradientAndHessian) {
+		return static_cast<double>(getHeldOutLogLikelihood(weights));
+	}
 
 	// Compile-time switch for models with / with-out PID (hasIndependentRows)
 	auto range = helper::getRangeAllPredictiveLikelihood(K, hY, hXBeta,
-		(BaseModel::cumulativeGradientAndHessian) ? accDenomPid : denomPid,
-		weights, hPid, std::integral_constant<bool, BaseModel::hasIndependentRows>());
+		denomPid, weights, hPid, std::integral_constant<bool, BaseModel::hasIndependentRows>());
 
 	auto kernel = TestPredLikeKernel<BaseModel,real>();
 
@@ -589,14 +653,6 @@ double ModelSpecifics<BaseModel,WeightType>::getPredictiveLogLikelihood(real* we
 			SerialOnly()
 		);
 
-	if (BaseModel::cumulativeGradientAndHessian) {
-
-// 		hPidInternal = savedPid; // make copy; TODO swap
-// 		accReset = saveAccReset; // make copy; TODO swap
-		setPidForAccumulation(&saveKWeight[0]);
-		computeRemainingStatistics(true);
-	}
-
 	return static_cast<double>(logLikelihood);
 }   // END OF DIFF
 
@@ -646,7 +702,16 @@ void ModelSpecifics<BaseModel,WeightType>::computeGradientAndHessian(int index,
 	if (useWeights) {
 		switch (modelData.getFormatType(index)) {
 			case INDICATOR :
-				computeGradientAndHessianImpl<IndicatorIterator>(index, ogradient, ohessian, weighted);
+				switch (modelData.getColumn(index).getIndexEncoding()) {
+					case VARINT_INDICES :
+						computeGradientAndHessianEncodedImpl<CompressedIndices>(index, ogradient, ohessian, weighted);
+						break;
+					case BITMAP_INDICES :
+						computeGradientAndHessianEncodedImpl<IndicatorBitmap>(index, ogradient, ohessian, weighted);
+						break;
+					default :
+						computeGradientAndHessianImpl<IndicatorIterator>(index, ogradient, ohessian, weighted);
+				}
 				break;
 			case SPARSE :
 				computeGradientAndHessianImpl<SparseIterator>(index, ogradient, ohessian, weighted);
@@ -661,7 +726,16 @@ void ModelSpecifics<BaseModel,WeightType>::computeGradientAndHessian(int index,
 	} else {
 		switch (modelData.getFormatType(index)) {
 			case INDICATOR :
-				computeGradientAndHessianImpl<IndicatorIterator>(index, ogradient, ohessian, unweighted);
+				switch (modelData.getColumn(index).getIndexEncoding()) {
+					case VARINT_INDICES :
+						computeGradientAndHessianEncodedImpl<CompressedIndices>(index, ogradient, ohessian, unweighted);
+						break;
+					case BITMAP_INDICES :
+						computeGradientAndHessianEncodedImpl<IndicatorBitmap>(index, ogradient, ohessian, unweighted);
+						break;
+					default :
+						computeGradientAndHessianImpl<IndicatorIterator>(index, ogradient, ohessian, unweighted);
+				}
 				break;
 			case SPARSE :
 				computeGradientAndHessianImpl<SparseIterator>(index, ogradient, ohessian, unweighted);
@@ -920,6 +994,75 @@ void ModelSpecifics<BaseModel,WeightType>::computeGradientAndHessianImpl(int ind
 
  }
 
+template <class BaseModel,typename WeightType> template <class Encoding, class Weights>
+void ModelSpecifics<BaseModel,WeightType>::computeGradientAndHessianEncodedImpl(int index, double *ogradient,
+		double *ohessian, Weights w) {
+
+	if (BaseModel::cumulativeGradientAndHessian) { // Only reads sparseIndices, not the column
+		computeGradientAndHessianImpl<IndicatorIterator>(index, ogradient, ohessian, w);
+		return;
+	}
+
+	const Encoding& rows = modelData.getColumn(index).template getEncodedIndices<Encoding>();
+
+	Fraction<real> result(0,0);
+
+	if (BaseModel::hasIndependentRows) {
+
+		auto kernel = TransformAndAccumulateGradientAndHessianKernelIndependent<BaseModel,IndicatorIterator, Weights, real, int>();
+		rows.forEachRow([&](const int k) {
+			result = kernel(result, boost::make_tuple(offsExpXBeta[k], hXBeta[k], hY[k],
+				denomPid[k], hNWeight[k]));
+		});
+
+	} else {
+
+		// Rows come in stratum order, so each stratum is closed when the next one starts
+		auto rangeGradient = helper::dependent::getRangeGradient(sparseIndices[index].get(), N,
+				denomPid, hNWeight,
+				IndicatorTag());
+
+		auto innerKernel = TestNumeratorKernel<BaseModel,IndicatorIterator,real>();
+		auto outerKernel = TestGradientKernel<BaseModel,IndicatorIterator,Weights,real>();
+
+		auto outer = rangeGradient.begin();
+		const std::pair<real,real> reset{0,0};
+		std::pair<real,real> stratum = reset;
+		int lastKey = 0;
+		bool open = false;
+
+		rows.forEachRow([&](const int k) {
+			const int key = hPid[k];
+			if (open && key != lastKey) {
+				result = outerKernel(result, stratum, *outer);
+				stratum = reset;
+				++outer;
+			}
+			stratum = innerKernel(stratum, boost::make_tuple(offsExpXBeta[k]));
+			lastKey = key;
+			open = true;
+		});
+
+		if (open) {
+			result = outerKernel(result, stratum, *outer);
+		}
+	}
+
+	real gradient = result.real();
+	real hessian = result.imag();
+
+	if (BaseModel::precomputeGradient) { // Compile-time switch
+		gradient -= hXjY[index];
+	}
+
+	if (BaseModel::precomputeHessian) { // Compile-time switch
+		hessian += static_cast<real>(2.0) * hXjX[index];
+	}
+
+	*ogradient = static_cast<double>(gradient);
+	*ohessian = static_cast<double>(hessian);
+}
+
 template <class BaseModel,typename WeightType>
 void ModelSpecifics<BaseModel,WeightType>::computeFisherInformation(int indexOne, int indexTwo,
 		double *oinfo, bool useWeights) {
@@ -946,6 +1089,66 @@ void ModelSpecifics<BaseModel,WeightType>::computeFisherInformation(int indexOne
 	}
 }
 
+template <class BaseModel,typename WeightType>
+void ModelSpecifics<BaseModel,WeightType>::computeFisherInformationMatrix(const std::vector<int>& indices,
+		double *oinfo, int nThreads, bool useWeights) {
+
+	if (useWeights) {
+		throw new std::logic_error("Weights are not yet implemented in Fisher Information calculations");
+	}
+
+	const size_t p = indices.size();
+	std::fill(oinfo, oinfo + p * p, 0.0);
+
+	// Information = X^t W X - C^t D^{-2} C, where W holds per-row weights and C the per-stratum
+	// gradient numerators of each column
+	std::vector<real> rowWeights(K);
+	for (size_t k = 0; k < K; ++k) {
+		real information = static_cast<real>(0);
+		BaseModel::incrementFisherInformation(UnitValue(),
+				weighted, // Signature-only, for iterator-type specialization
+				&information,
+				offsExpXBeta[k],
+				0.0, 0.0,
+				denomPid[BaseModel::getGroup(hPid, k)],
+				hKWeight[k], 1.0, hXBeta[k], hY[k]);
+		rowWeights[k] = information;
+	}
+
+	SparseColumns columns;
+	for (auto index : indices) {
+		for (GenericIterator it(modelData, index); it; ++it) {
+			if (it.value() != static_cast<real>(0)) {
+				columns.push_back(it.index(), it.value());
+			}
+		}
+		columns.finishColumn();
+	}
+
+	addWeightedCrossProduct(columns, rowWeights, K, 1.0, oinfo, nThreads);
+
+	if (BaseModel::hasStrataCrossTerms) {
+
+		// Cross-terms are read in place, from the cache or as just computed
+		const std::vector<CDCPtr> crossColumns = getSubjectSpecificHessianColumns(indices);
+		SparseColumnViews crossTerms;
+		for (const auto& column : crossColumns) {
+			const auto rows = static_cast<const CompressedDataColumn&>(*column).getColumnsVector();
+			const auto values = static_cast<const CompressedDataColumn&>(*column).getDataVector();
+			crossTerms.push_back(rows.data(), values.data(), rows.size());
+		}
+
+		std::vector<real> crossWeights(N);
+		for (size_t n = 0; n < N; ++n) {
+			crossWeights[n] = 1.0 / (denomPid[n] * denomPid[n]);
+		}
+
+		addWeightedCrossProduct(crossTerms, crossWeights, N, -1.0, oinfo, nThreads);
+	}
+
+	symmetrizeFromUpper(oinfo, p);
+}
+
 template <class BaseModel, typename WeightType> template <typename IteratorTypeOne, class Weights>
 void ModelSpecifics<BaseModel,WeightType>::dispatchFisherInformation(int indexOne, int indexTwo, double *oinfo, Weights w) {
 	switch (modelData.getFormatType(indexTwo)) {
@@ -967,37 +1170,98 @@ void ModelSpecifics<BaseModel,WeightType>::dispatchFisherInformation(int indexOn
 
 
 template<class BaseModel, typename WeightType> template<class IteratorType>
-SparseIterator ModelSpecifics<BaseModel, WeightType>::getSubjectSpecificHessianIterator(int index) {
-
-	if (hessianSparseCrossTerms.find(index) == hessianSparseCrossTerms.end()) {
-		// Make new
-//		std::vector<int>* indices = new std::vector<int>();
-        auto indices = make_shared<std::vector<int> >();
-//		std::vector<real>* values = new std::vector<real>();
-        auto values = make_shared<std::vector<real> >();
-//		CompressedDataColumn* column = new CompressedDataColumn(indices, values,
-//				SPARSE);
-    	CDCPtr column = bsccs::make_shared<CompressedDataColumn>(indices, values, SPARSE);
-		hessianSparseCrossTerms.insert(std::make_pair(index,
-// 		    CompressedDataColumn(indices, values, SPARSE)));
-		    column));
-
-		IteratorType itCross(modelData, index);
-		for (; itCross;) {
-			real value = 0.0;
-			int currentPid = hPid[itCross.index()];  // TODO Need to fix for stratified Cox
-			do {
-				const int k = itCross.index();
-				value += BaseModel::gradientNumeratorContrib(itCross.value(),
-						offsExpXBeta[k], hXBeta[k], hY[k]);
-				++itCross;
-			} while (itCross && currentPid == hPid[itCross.index()]); // TODO Need to fix for stratified Cox
-			indices->push_back(currentPid);
-			values->push_back(value);
+AbstractModelSpecifics::CDCPtr ModelSpecifics<BaseModel, WeightType>::computeSubjectSpecificHessianColumn(int index) {
+
+	auto indices = make_shared<std::vector<int> >();
+	auto values = make_shared<std::vector<real> >();
+	CDCPtr column = bsccs::make_shared<CompressedDataColumn>(indices, values, SPARSE);
+
+	IteratorType itCross(modelData, index);
+	for (; itCross;) {
+		real value = 0.0;
+		int currentPid = hPid[itCross.index()];  // TODO Need to fix for stratified Cox
+		do {
+			const int k = itCross.index();
+			value += BaseModel::gradientNumeratorContrib(itCross.value(),
+					offsExpXBeta[k], hXBeta[k], hY[k]);
+			++itCross;
+		} while (itCross && currentPid == hPid[itCross.index()]); // TODO Need to fix for stratified Cox
+		indices->push_back(currentPid);
+		values->push_back(value);
+	}
+	return column;
+}
+
+template<class BaseModel, typename WeightType> template<class IteratorType>
+AbstractModelSpecifics::CDCPtr ModelSpecifics<BaseModel, WeightType>::getSubjectSpecificHessianColumn(int index) {
+
+	checkCrossTermVersion();
+	CDCPtr column;
+	if (!hessianSparseCrossTerms.find(index, column)) {
+		column = computeSubjectSpecificHessianColumn<IteratorType>(index);
+		hessianSparseCrossTerms.insert(index, column,
+				column->getNumberOfEntries() * (sizeof(int) + sizeof(real)));
+	}
+	return column; // Remains valid even if later evicted
+}
+
+template<class BaseModel, typename WeightType>
+std::vector<AbstractModelSpecifics::CDCPtr> ModelSpecifics<BaseModel, WeightType>::getSubjectSpecificHessianColumns(
+		const std::vector<int>& indices) {
+
+	checkCrossTermVersion();
+	std::vector<CDCPtr> crossColumns(indices.size());
+	std::vector<size_t> missed;
+	for (size_t j = 0; j < indices.size(); ++j) {
+		if (!hessianSparseCrossTerms.find(indices[j], crossColumns[j])) {
+			missed.push_back(j);
+		}
+	}
+	if (missed.empty()) {
+		return crossColumns;
+	}
+
+	// Missed columns by row, so one pass over the rows, in stratum order, sums them all
+	const SparseRows byRow = [&]() {
+		SparseColumns byColumn;
+		for (auto j : missed) {
+			for (GenericIterator it(modelData, indices[j]); it; ++it) {
+				byColumn.push_back(it.index(), it.value());
+			}
+			byColumn.finishColumn();
+		}
+		return SparseRows(byColumn, K);
+	}();
+
+	std::vector<IndexVectorPtr> strata(missed.size());
+	std::vector<bsccs::shared_ptr<std::vector<real> > > sums(missed.size());
+	for (size_t m = 0; m < missed.size(); ++m) {
+		strata[m] = bsccs::make_shared<std::vector<int> >();
+		sums[m] = bsccs::make_shared<std::vector<real> >();
+		crossColumns[missed[m]] = bsccs::make_shared<CompressedDataColumn>(strata[m], sums[m], SPARSE);
+	}
+
+	for (size_t k = 0; k < K; ++k) {
+		const int n = hPid[k]; // TODO Need to fix for stratified Cox
+		for (size_t e = byRow.start[k]; e < byRow.start[k + 1]; ++e) {
+			const int m = byRow.columns[e];
+			const real value = BaseModel::gradientNumeratorContrib(byRow.values[e],
+					offsExpXBeta[k], hXBeta[k], hY[k]);
+			if (strata[m]->empty() || strata[m]->back() != n) {
+				strata[m]->push_back(n);
+				sums[m]->push_back(value);
+			} else {
+				sums[m]->back() += value;
+			}
 		}
 	}
-	return SparseIterator(*hessianSparseCrossTerms[index]);
 
+	// The cache keeps what its budget allows; the caller holds every requested column until used
+	for (size_t m = 0; m < missed.size(); ++m) {
+		hessianSparseCrossTerms.insert(indices[missed[m]], crossColumns[missed[m]],
+				strata[m]->size() * (sizeof(int) + sizeof(real)));
+	}
+	return crossColumns;
 }
 
 template <class BaseModel, typename WeightType> template <class IteratorTypeOne, class IteratorTypeTwo, class Weights>
@@ -1026,6 +1290,7 @@ void ModelSpecifics<BaseModel,WeightType>::computeFisherInformationImpl(int inde
 		// Check if index is pre-computed
 //#define USE_DENSE
 #ifdef USE_DENSE
+		checkCrossTermVersion();
 		if (hessianCrossTerms.find(indexOne) == hessianCrossTerms.end()) {
 			// Make new
 			std::vector<real> crossOneTerms(N);
@@ -1064,8 +1329,10 @@ void ModelSpecifics<BaseModel,WeightType>::computeFisherInformationImpl(int inde
 //		std::cerr << cross << std::endl;
 		information -= cross;
 #else
-		SparseIterator sparseCrossOneTerms = getSubjectSpecificHessianIterator<IteratorTypeOne>(indexOne);
-		SparseIterator sparseCrossTwoTerms = getSubjectSpecificHessianIterator<IteratorTypeTwo>(indexTwo);
+		CDCPtr crossOne = getSubjectSpecificHessianColumn<IteratorTypeOne>(indexOne);
+		CDCPtr crossTwo = getSubjectSpecificHessianColumn<IteratorTypeTwo>(indexTwo);
+		SparseIterator sparseCrossOneTerms(*crossOne);
+		SparseIterator sparseCrossTwoTerms(*crossTwo);
 		PairProductIterator<SparseIterator,SparseIterator> itSparseCross(sparseCrossOneTerms, sparseCrossTwoTerms);
 
 		real sparseCross = 0.0;
@@ -1114,7 +1381,16 @@ void ModelSpecifics<BaseModel,WeightType>::computeNumeratorForGradient(int index
 				for (; it; ++it) { // Only affected entries
 					numerPid[it.index()] = static_cast<real>(0.0);
 				}
-				incrementNumeratorForGradientImpl<IndicatorIterator>(index);
+				switch (modelData.getColumn(index).getIndexEncoding()) {
+					case VARINT_INDICES :
+						incrementNumeratorForGradientImpl<CompressedIndicatorIterator>(index);
+						break;
+					case BITMAP_INDICES :
+						incrementNumeratorForGradientImpl<BitmapIndicatorIterator>(index);
+						break;
+					default :
+						incrementNumeratorForGradientImpl<IndicatorIterator>(index);
+				}
 				}
 				break;
 			case SPARSE : {
@@ -1275,10 +1551,21 @@ void ModelSpecifics<BaseModel,WeightType>::updateXBeta(real realDelta, int index
 #endif
 #endif
 
+	++xBetaVersion; // Cached cross-terms are dropped when next read
+
 	// Run-time dispatch to implementation depending on covariate FormatType
 	switch(modelData.getFormatType(index)) {
 		case INDICATOR :
-			updateXBetaImpl<IndicatorIterator>(realDelta, index, useWeights);
+			switch (modelData.getColumn(index).getIndexEncoding()) {
+				case VARINT_INDICES :
+					updateXBetaEncodedImpl<CompressedIndices>(realDelta, index, useWeights);
+					break;
+				case BITMAP_INDICES :
+					updateXBetaEncodedImpl<IndicatorBitmap>(realDelta, index, useWeights);
+					break;
+				default :
+					updateXBetaImpl<IndicatorIterator>(realDelta, index, useWeights);
+			}
 			break;
 		case SPARSE :
 			updateXBetaImpl<SparseIterator>(realDelta, index, useWeights);
@@ -1304,6 +1591,26 @@ void ModelSpecifics<BaseModel,WeightType>::updateXBeta(real realDelta, int index
 
 }
 
+template <class BaseModel,typename WeightType> template <class Encoding>
+void ModelSpecifics<BaseModel,WeightType>::updateXBetaEncodedImpl(real realDelta, int index, bool useWeights) {
+
+	const Encoding& rows = modelData.getColumn(index).template getEncodedIndices<Encoding>();
+
+	auto kernel = UpdateXBetaKernel<BaseModel,IndicatorIterator,real,int>(
+					realDelta, begin(offsExpXBeta), begin(hXBeta),
+					begin(hY),
+					begin(hPid),
+					begin(denomPid),
+					begin(hOffs)
+					);
+
+	rows.forEachRow([&](const int k) {
+		kernel(boost::make_tuple(k));
+	});
+
+	computeAccumlatedDenominator(useWeights);
+}
+
 template <class BaseModel,typename WeightType> template <class IteratorType>
 inline void ModelSpecifics<BaseModel,WeightType>::updateXBetaImpl(real realDelta, int index, bool useWeights) {
 
@@ -1435,6 +1742,8 @@ void ModelSpecifics<BaseModel,WeightType>::computeRemainingStatistics(bool useWe
 	auto start = bsccs::chrono::steady_clock::now();
 #endif
 
+	++xBetaVersion; // Cached cross-terms are dropped when next read
+
 
 	if (BaseModel::likelihoodHasDenominator) {
 		fillVector(denomPid.data(), N, BaseModel::getDenomNullValue());
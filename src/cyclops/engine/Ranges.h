@@ -228,7 +228,7 @@ namespace helper {
 namespace independent {
 
 //    template <class ExpXBetaType, class XBetaType, class YType, class DenominatorType, class WeightType>
-    auto getRangeX(const CompressedDataMatrix& mat, const int index,
+    auto getRangeX(const IntView& rows,
 //    			ExpXBetaType& expXBeta, XBetaType& xBeta, YType& y, DenominatorType& denominator, WeightType& weight,
   					RealVector& expXBeta, RealVector& xBeta, const RealVector& y,
   					RealVector& denominator,
@@ -240,23 +240,23 @@ namespace independent {
  					boost::tuple<
  					    decltype(boost::make_permutation_iterator(
  					        std::begin(expXBeta),
- 					        std::begin(mat.getCompressedColumnVectorSTL(index)))
+ 					        std::begin(rows))
  					    ),
  					    decltype(boost::make_permutation_iterator(
  					        std::begin(xBeta),
- 					        std::begin(mat.getCompressedColumnVectorSTL(index)))
+ 					        std::begin(rows))
  					    ),
  					    decltype(boost::make_permutation_iterator(
  					        std::begin(y),
- 					        std::begin(mat.getCompressedColumnVectorSTL(index)))
+ 					        std::begin(rows))
  					    ),
  					    decltype(boost::make_permutation_iterator(
  					        std::begin(denominator),
- 					        std::begin(mat.getCompressedColumnVectorSTL(index)))
+ 					        std::begin(rows))
  					    ),
  					    decltype(boost::make_permutation_iterator(
  					        std::begin(weight),
- 					        std::begin(mat.getCompressedColumnVectorSTL(index)))
+ 					        std::begin(rows))
  					    )
  					>
  				>
@@ -264,43 +264,43 @@ namespace independent {
 
  		auto x0 = boost::make_permutation_iterator(
  					        std::begin(expXBeta),
- 					        std::begin(mat.getCompressedColumnVectorSTL(index)));
+ 					        std::begin(rows));
 
         auto x1 = boost::make_permutation_iterator(
  					        std::begin(xBeta),
- 					        std::begin(mat.getCompressedColumnVectorSTL(index)));
+ 					        std::begin(rows));
 
         auto x2 = boost::make_permutation_iterator(
  					        std::begin(y),
- 					        std::begin(mat.getCompressedColumnVectorSTL(index)));
+ 					        std::begin(rows));
 
         auto x3 = boost::make_permutation_iterator(
  					        std::begin(denominator),
- 					        std::begin(mat.getCompressedColumnVectorSTL(index)));
+ 					        std::begin(rows));
 
         auto x4 = boost::make_permutation_iterator(
  					        std::begin(weight),
- 					        std::begin(mat.getCompressedColumnVectorSTL(index)));
+ 					        std::begin(rows));
 
 		auto y0 = boost::make_permutation_iterator(
 					        std::begin(expXBeta),
-					        std::end(mat.getCompressedColumnVectorSTL(index)));
+					        std::end(rows));
 
     	auto y1 = boost::make_permutation_iterator(
 					        std::begin(xBeta),
-					        std::end(mat.getCompressedColumnVectorSTL(index)));
+					        std::end(rows));
 
     	auto y2 = boost::make_permutation_iterator(
 					        std::begin(y),
-					        std::end(mat.getCompressedColumnVectorSTL(index)));
+					        std::end(rows));
 
     	auto y3 = boost::make_permutation_iterator(
 					        std::begin(denominator),
-					        std::end(mat.getCompressedColumnVectorSTL(index)));
+					        std::end(rows));
 
     	auto y4 = boost::make_permutation_iterator(
 					        std::begin(weight),
-					        std::end(mat.getCompressedColumnVectorSTL(index)));
+					        std::end(rows));
 
  		return {
             boost::make_zip_iterator(
@@ -314,6 +314,17 @@ namespace independent {
         };
  	}
 
+    auto getRangeX(const CompressedDataMatrix& mat, const int index,
+  					RealVector& expXBeta, RealVector& xBeta, const RealVector& y,
+  					RealVector& denominator,
+  					RealVector& weight,
+  					IndicatorIterator::tag tag) ->
+            decltype(getRangeX(mat.getCompressedColumnVectorSTL(index),
+                expXBeta, xBeta, y, denominator, weight, tag)) {
+        return getRangeX(mat.getCompressedColumnVectorSTL(index),
+                expXBeta, xBeta, y, denominator, weight, tag);
+    }
+
 //    template <class ExpXBetaType, class XBetaType, class YType, class DenominatorType, class WeightType>
     auto getRangeX(const CompressedDataMatrix& mat, const int index,
 //    			ExpXBetaType& expXBeta, XBetaType& xBeta, YType& y, DenominatorType& denominator, WeightType& weight,
@@ -727,27 +738,34 @@ namespace dependent {
     }
 
 //    template <class KeyType, class IteratorType> // For indicator
-    auto getRangeKey(const CompressedDataMatrix& mat, const int index,
-    		//KeyType& pid, IteratorType
+    auto getRangeKey(const IntView& rows,
     		int* pid,
     		IndicatorIterator::tag
     		) ->
             boost::iterator_range<
                 decltype(boost::make_permutation_iterator(
                     begin(pid),
-                    std::begin(mat.getCompressedColumnVectorSTL(index))))
+                    std::begin(rows)))
             > {
-//        const size_t K = mat.getNumberOfRows();
         return {
     	    boost::make_permutation_iterator(
 			    begin(pid),
-				std::begin(mat.getCompressedColumnVectorSTL(index))),
+				std::begin(rows)),
     	    boost::make_permutation_iterator(
 			    begin(pid),
-				std::end(mat.getCompressedColumnVectorSTL(index)))
+				std::end(rows))
         };
     }
 
+    auto getRangeKey(const CompressedDataMatrix& mat, const int index,
+    		//KeyType& pid, IteratorType
+    		int* pid,
+    		IndicatorIterator::tag tag
+    		) ->
+            decltype(getRangeKey(mat.getCompressedColumnVectorSTL(index), pid, tag)) {
+        return getRangeKey(mat.getCompressedColumnVectorSTL(index), pid, tag);
+    }
+
 //    template <class KeyType> // For dense
     auto getRangeKey(const CompressedDataMatrix& mat, const int index,
     		//KeyType& pid,
@@ -839,8 +857,7 @@ namespace dependent {
     }
 
 //    template <class ExpXBeta> // For indicator
-    auto getRangeX(const CompressedDataMatrix& mat, const int index,
-                //ExpXBeta&
+    auto getRangeX(const IntView& rows,
                 RealVector&
                 expXBeta, IndicatorIterator::tag) ->
             boost::iterator_range<
@@ -848,7 +865,7 @@ namespace dependent {
                     boost::tuple<
                 	    decltype(boost::make_permutation_iterator(
 			                std::begin(expXBeta),
-            				std::begin(mat.getCompressedColumnVectorSTL(index))))
+            				std::begin(rows)))
                     >
                 >
             > {
@@ -857,17 +874,25 @@ namespace dependent {
                 boost::make_tuple(
                     boost::make_permutation_iterator(
                         std::begin(expXBeta),
-                        std::begin(mat.getCompressedColumnVectorSTL(index)))
+                        std::begin(rows))
             )),
             boost::make_zip_iterator(
                 boost::make_tuple(
                     boost::make_permutation_iterator(
                         std::begin(expXBeta),
-                        std::end(mat.getCompressedColumnVectorSTL(index)))
+                        std::end(rows))
             ))
         };
     }
 
+    auto getRangeX(const CompressedDataMatrix& mat, const int index,
+                //ExpXBeta&
+                RealVector&
+                expXBeta, IndicatorIterator::tag tag) ->
+            decltype(getRangeX(mat.getCompressedColumnVectorSTL(index), expXBeta, tag)) {
+        return getRangeX(mat.getCompressedColumnVectorSTL(index), expXBeta, tag);
+    }
+
 //    template <class ExpXBeta> // For intercept
     auto getRangeX(const CompressedDataMatrix& mat, const int index,
                 //ExpXBeta&
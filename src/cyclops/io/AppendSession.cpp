@@ -0,0 +1,220 @@
+/*
+ * AppendSession.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: msuchard
+ */
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <cstdint>
+
+#include "io/AppendSession.h"
+
+namespace bsccs {
+
+IdView InputColumn::viewIds(std::vector<IdType>& buffer) const {
+	switch (type) {
+		case INT64 :
+			return IdView(static_cast<const IdType*>(data), length);
+		case INT32 : {
+			const int32_t* ids = static_cast<const int32_t*>(data);
+			buffer.assign(ids, ids + length);
+			break;
+		}
+		case REAL64 : {
+			const double* ids = static_cast<const double*>(data);
+			buffer.resize(length);
+			std::transform(ids, ids + length, buffer.begin(), [](double x) {
+				return static_cast<IdType>(x);
+			});
+			break;
+		}
+		default :
+			return IdView();
+	}
+	return IdView(buffer);
+}
+
+DoubleView InputColumn::viewReals(std::vector<double>& buffer) const {
+	switch (type) {
+		case REAL64 :
+			return DoubleView(static_cast<const double*>(data), length);
+		case INT32 : {
+			const int32_t* values = static_cast<const int32_t*>(data);
+			buffer.resize(length);
+			std::transform(values, values + length, buffer.begin(), [](int32_t x) {
+				return x == std::numeric_limits<int32_t>::min() ?
+					std::numeric_limits<double>::quiet_NaN() : static_cast<double>(x);
+			});
+			break;
+		}
+		case INT64 : {
+			const int64_t* values = static_cast<const int64_t*>(data);
+			buffer.assign(values, values + length);
+			break;
+		}
+		default :
+			return DoubleView();
+	}
+	return DoubleView(buffer);
+}
+
+void AppendSession::QueuedLogger::writeLine(const std::ostringstream& stream) {
+	std::lock_guard<mutex> lock(guard);
+	lines.push_back(stream.str());
+}
+
+void AppendSession::QueuedLogger::passOn(loggers::ProgressLogger& log) {
+	std::deque<std::string> taken;
+	{
+		std::lock_guard<mutex> lock(guard);
+		taken.swap(lines);
+	}
+	for (const auto& line : taken) {
+		std::ostringstream stream;
+		stream << line;
+		log.writeLine(stream);
+	}
+}
+
+void AppendSession::ThrowingErrorHandler::throwError(const std::ostringstream& stream) {
+	throw std::runtime_error(stream.str());
+}
+
+AppendSession::AppendSession(ModelData& data, size_t maxQueuedBatches) :
+		data(data), maxQueuedBatches(std::max<size_t>(1, maxQueuedBatches)),
+		log(data.log), error(data.error), queuedLog(bsccs::make_shared<QueuedLogger>()),
+		busy(false), closing(false), failed(false), nRows(0), worker(nullptr) {
+
+	data.log = queuedLog;
+	data.error = bsccs::make_shared<ThrowingErrorHandler>();
+	worker = new thread(run, this);
+}
+
+AppendSession::~AppendSession() {
+	finish();
+}
+
+bool AppendSession::enqueue(Batch batch) {
+	releaseRetired();
+	while (true) {
+		{
+			std::lock_guard<mutex> lock(guard);
+			if (isFull() && !failed && !closing) {
+				waitFor(changed, guard, WaitSliceMilliseconds);
+			}
+			if (failed || closing) {
+				return false;
+			}
+			if (!isFull()) {
+				pending.push_back(std::move(batch));
+				break;
+			}
+		}
+		// Still full: let the caller see progress and interrupt between slices
+		releaseRetired();
+		log->yield();
+	}
+	changed.notify_all();
+	return true;
+}
+
+bool AppendSession::finish() {
+	if (worker) {
+		{
+			std::lock_guard<mutex> lock(guard);
+			closing = true;
+		}
+		changed.notify_all();
+		worker->join();
+		delete worker;
+		worker = nullptr;
+
+		data.log = log;
+		data.error = error;
+	}
+	releaseRetired();
+
+	std::lock_guard<mutex> lock(guard);
+	return !failed;
+}
+
+std::string AppendSession::getError() {
+	std::lock_guard<mutex> lock(guard);
+	return message;
+}
+
+size_t AppendSession::getNumberOfRows() {
+	std::lock_guard<mutex> lock(guard);
+	return nRows;
+}
+
+void AppendSession::run(void* argument) {
+	static_cast<AppendSession*>(argument)->consume();
+}
+
+void AppendSession::consume() {
+	while (true) {
+		const Batch* next;
+		bool skip;
+		{
+			std::lock_guard<mutex> lock(guard);
+			while (pending.empty() && !closing) {
+				changed.wait(guard);
+			}
+			if (pending.empty()) {
+				break; // Closing and drained
+			}
+			next = &pending.front(); // Stays valid: the caller only appends
+			busy = true;
+			skip = failed;
+		}
+
+		const Batch& batch = *next;
+		size_t appended = 0;
+		std::string failure;
+		if (!skip) {
+			try {
+				std::vector<IdType> oStratumId, oRowId, cRowId, cCovariateId;
+				std::vector<double> oY, oTime, cCovariateValue;
+				appended = data.append(
+					batch.oStratumId.viewIds(oStratumId),
+					batch.oRowId.viewIds(oRowId),
+					batch.oY.viewReals(oY),
+					batch.oTime.viewReals(oTime),
+					batch.cRowId.viewIds(cRowId),
+					batch.cCovariateId.viewIds(cCovariateId),
+					batch.cCovariateValue.viewReals(cCovariateValue));
+			} catch (std::exception& e) {
+				failure = e.what();
+			}
+		}
+
+		{
+			std::lock_guard<mutex> lock(guard);
+			nRows += appended;
+			if (!failure.empty() && !failed) {
+				failed = true;
+				message = failure;
+			}
+			retired.push_back(std::move(pending.front())); // Released by the caller
+			pending.pop_front();
+			busy = false;
+		}
+		changed.notify_all();
+	}
+}
+
+void AppendSession::releaseRetired() {
+	std::vector<Batch> released;
+	{
+		std::lock_guard<mutex> lock(guard);
+		released.swap(retired);
+	}
+	released.clear();
+	queuedLog->passOn(*log);
+}
+
+} // namespace
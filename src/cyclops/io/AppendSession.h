@@ -0,0 +1,143 @@
+/*
+ * AppendSession.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: msuchard
+ */
+
+#ifndef APPENDSESSION_H_
+#define APPENDSESSION_H_
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstddef>
+
+#include "ModelData.h"
+#include "Thread.h"
+#include "io/ProgressLogger.h"
+
+namespace bsccs {
+
+// Input vector of ids or values in its source type, e.g. an R integer, integer64 or numeric vector
+struct InputColumn {
+
+	enum Type {
+		EMPTY, INT32, INT64, REAL64
+	};
+
+	InputColumn() : type(EMPTY), data(nullptr), length(0) { }
+
+	InputColumn(Type type, const void* data, size_t length) :
+		type(type), data(data), length(length) { }
+
+	// In place for INT64, else converted into buffer
+	IdView viewIds(std::vector<IdType>& buffer) const;
+
+	// In place for REAL64, else converted into buffer; INT32 minimum (R's NA) becomes NaN
+	DoubleView viewReals(std::vector<double>& buffer) const;
+
+	Type type;
+	const void* data;
+	size_t length;
+};
+
+/**
+ * Appends batches to a ModelData on a background thread, so the caller can fetch the next batch
+ * (e.g. from a database) while the previous one is converted and appended.  At most
+ * maxQueuedBatches are waiting or being appended; enqueue() waits beyond that, calling the
+ * logger's yield() between short slices so the caller can be interrupted.  The session
+ * reads each batch's columns in place, so their storage is held by the batch's owner, which is
+ * only released on the caller's thread, in enqueue() or finish().  The data must not otherwise be
+ * used until finish() returns.  Log lines written while appending are passed on by enqueue() and
+ * finish(); after a failed batch later ones are dropped.
+ */
+class AppendSession {
+public:
+
+	struct Batch {
+		InputColumn oStratumId;
+		InputColumn oRowId;
+		InputColumn oY;
+		InputColumn oTime;
+		InputColumn cRowId;
+		InputColumn cCovariateId;
+		InputColumn cCovariateValue;
+		bsccs::shared_ptr<void> owner; // Keeps the columns' storage alive
+	};
+
+	static const size_t DefaultMaxQueuedBatches = 2;
+
+	AppendSession(ModelData& data, size_t maxQueuedBatches = DefaultMaxQueuedBatches);
+
+	~AppendSession();
+
+	// Returns false, without queuing, once a batch has failed
+	bool enqueue(Batch batch);
+
+	// Waits for all queued batches; returns false if one failed
+	bool finish();
+
+	std::string getError();
+
+	// Outcome rows appended so far
+	size_t getNumberOfRows();
+
+private:
+
+	// Buffers log lines from the worker for the caller's thread
+	class QueuedLogger : public loggers::ProgressLogger {
+	public:
+		void writeLine(const std::ostringstream& stream);
+		void yield() { }
+		void passOn(loggers::ProgressLogger& log);
+	private:
+		mutex guard;
+		std::deque<std::string> lines;
+	};
+
+	// Turns ModelData errors into exceptions the worker catches
+	class ThrowingErrorHandler : public loggers::ErrorHandler {
+	public:
+		void throwError(const std::ostringstream& stream);
+	};
+
+	static const int WaitSliceMilliseconds = 100;
+
+	// Caller holds guard
+	bool isFull() const { return pending.size() + (busy ? 1 : 0) >= maxQueuedBatches; }
+
+	static void run(void* argument);
+
+	void consume();
+
+	// Destroys retired batches and passes on log lines; caller's thread only
+	void releaseRetired();
+
+	// Disable copy-constructors and copy-assignment
+	AppendSession(const AppendSession&);
+	AppendSession& operator = (const AppendSession&);
+
+	ModelData& data;
+	const size_t maxQueuedBatches;
+
+	loggers::ProgressLoggerPtr log; // Restored by finish()
+	loggers::ErrorHandlerPtr error;
+	bsccs::shared_ptr<QueuedLogger> queuedLog;
+
+	std::deque<Batch> pending;
+	std::vector<Batch> retired;
+	bool busy;
+	bool closing;
+	bool failed;
+	std::string message;
+	size_t nRows;
+
+	mutex guard;
+	condition_variable changed;
+	thread* worker;
+};
+
+} // namespace
+
+#endif /* APPENDSESSION_H_ */
@@ -13,6 +13,9 @@
 #include "InputReader.h"
 #include "SparseIndexer.h"
 #include "io/ProgressLogger.h"
+#include "io/ChunkedTextParser.h"
+#include "io/MappedFile.h"
+#include "io/DecompressionPipe.h"
  
 #define MAX_ENTRIES		1000000000
 #define MISSING_STRING	"NA"
@@ -74,7 +77,8 @@ public:
 	
 	BaseInputReader(
 		loggers::ProgressLoggerPtr _logger,
-		loggers::ErrorHandlerPtr _error) : InputReader(_logger, _error), innerDelimitor(":") {
+		loggers::ErrorHandlerPtr _error) : InputReader(_logger, _error), innerDelimitor(":"),
+		chunkedParsing(true) {
 		// Do nothing	
 	}
 
@@ -84,6 +88,12 @@ public:
 
 	virtual void readFile(const char* fileName) {
 
+		const DecompressionPipe::Codec codec = DecompressionPipe::detectCodec(fileName);
+		if (codec != DecompressionPipe::PLAIN) {
+			readCompressedFile(fileName, codec);
+			return;
+		}
+
 		ifstream in(fileName);
 		if (!in) {		
 			std::ostringstream stream;
@@ -103,11 +113,19 @@ public:
 
 			static_cast<DerivedFormat*>(this)->addFixedCovariateColumns();
 
-			while (getline(in, line) && (rowInfo.currentRow < MAX_ENTRIES)) {
-				if (!line.empty()) {
-					stringstream ss(line.c_str()); // Tokenize
-					static_cast<DerivedFormat*>(this)->parseRow(ss, rowInfo);
-					rowInfo.currentRow++;
+			ChunkedTextParser::Layout layout;
+			bool parsed = false;
+			if (chunkedParsing && static_cast<DerivedFormat*>(this)->getRowLayout(layout)) {
+				parsed = readChunks(fileName, in.tellg(), layout, rowInfo);
+			}
+
+			if (!parsed) {
+				while (getline(in, line) && (rowInfo.currentRow < MAX_ENTRIES)) {
+					if (!isBlankLine(line.data(), line.data() + line.size())) {
+						stringstream ss(line.c_str()); // Tokenize
+						static_cast<DerivedFormat*>(this)->parseRow(ss, rowInfo);
+						rowInfo.currentRow++;
+					}
 				}
 			}
 			addEventEntry(rowInfo.numEvents); // Save last patient
@@ -118,7 +136,46 @@ public:
 			in.close();
 			error->throwError(stream);			
 		}
-		
+
+		in.close();
+		finishFile(fileName, rowInfo);
+	}
+
+	// Reads a gzip or zstd file while it is decompressed on another thread
+	void readCompressedFile(const char* fileName, DecompressionPipe::Codec codec) {
+
+		DecompressionPipe pipe(fileName, codec, compressedBlockSize > 0 ?
+			compressedBlockSize : DecompressionPipe::DefaultBlockSize);
+		if (!pipe.isOpen()) {
+			std::ostringstream stream;
+			stream << "Unable to open " << fileName << ": " << pipe.getError();
+			error->throwError(stream);
+			return;
+		}
+
+		RowInformation rowInfo(0,0,0, MISSING_STRING, MISSING_STRING, *modelData);
+
+		try {
+			readBlocks(pipe, fileName, rowInfo);
+			addEventEntry(rowInfo.numEvents); // Save last patient
+
+		} catch (...) {
+			std::ostringstream stream;
+			stream << "Exception while trying to read " << fileName;
+			error->throwError(stream);
+		}
+
+		if (pipe.hasFailed()) {
+			std::ostringstream stream;
+			stream << "Unable to decompress " << fileName << ": " << pipe.getError();
+			error->throwError(stream);
+		}
+
+		finishFile(fileName, rowInfo);
+	}
+
+	void finishFile(const char* fileName, RowInformation& rowInfo) {
+
 		static_cast<DerivedFormat*>(this)->upcastColumns(modelData, rowInfo);
 
 		doSort(); // Override for sort criterion or no sorting
@@ -132,12 +189,221 @@ public:
 		modelData->nPatients = rowInfo.numCases;
 		modelData->nRows = rowInfo.currentRow;
 		modelData->conditionId = rowInfo.outcomeId;
-		
-		in.close();
 	}	 
+
+	// The stream parser is the reference implementation and handles formats without a row layout
+	void setChunkedParsing(bool chunked) { chunkedParsing = chunked; }
 	
 protected:
-	void parseHeader(ifstream& in) {
+
+	/**
+	 * Describes the row format for ChunkedTextParser, once parseHeader() has run.  Formats whose
+	 * rows cannot be described return false and are read line by line through parseRow().
+	 */
+	bool getRowLayout(ChunkedTextParser::Layout& layout) {
+		return false;
+	}
+
+	// Parses the rest of fileName in parallel; false leaves modelData untouched for the stream parser
+	bool readChunks(const char* fileName, std::streamoff dataStart,
+			const ChunkedTextParser::Layout& layout, RowInformation& rowInfo) {
+
+		MappedFile file(fileName);
+		if (!file.isValid() || dataStart < 0 || static_cast<size_t>(dataStart) > file.size()) {
+			return false;
+		}
+
+		size_t failedLine = 0;
+		if (!parseChunks(file.data() + dataStart, file.data() + file.size(), layout, rowInfo,
+				failedLine)) {
+			logParseFailure(fileName, failedLine);
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Streams decompressed blocks through the parsers.  Complete lines of each block are parsed
+	 * in place; a line split across blocks is joined in a small carry-over buffer.
+	 */
+	void readBlocks(DecompressionPipe& pipe, const char* fileName, RowInformation& rowInfo) {
+
+		ChunkedTextParser::Layout layout;
+		bool chunked = false;
+		bool inHeader = true;
+		size_t line = 0;
+		string pending; // Header, or the start of a line continued in the next block
+		string first;
+
+		const char* block;
+		size_t length;
+		while (pipe.next(block, length)) {
+			const char* end = block + length;
+
+			if (inHeader) {
+				pending.append(block, length);
+				if (pending.find('\n') == string::npos) {
+					continue;
+				}
+				inHeader = false;
+				chunked = startBody(pending, layout);
+				first.swap(pending);
+				block = first.data();
+				end = block + first.size();
+			}
+
+			const char* lastNewline = end;
+			while (lastNewline > block && *(lastNewline - 1) != '\n') {
+				--lastNewline;
+			}
+			if (lastNewline == block) {
+				pending.append(block, end);
+				continue;
+			}
+			if (!pending.empty()) {
+				const char* firstNewline = static_cast<const char*>(
+					std::memchr(block, '\n', end - block)) + 1;
+				pending.append(block, firstNewline);
+				parseText(pending.data(), pending.data() + pending.size(), fileName, layout,
+					chunked, line, rowInfo);
+				block = firstNewline;
+			}
+			parseText(block, lastNewline, fileName, layout, chunked, line, rowInfo);
+			pending.assign(lastNewline, end);
+		}
+
+		if (inHeader) { // Input ends within its first line
+			chunked = startBody(pending, layout);
+		}
+		parseText(pending.data(), pending.data() + pending.size(), fileName, layout, chunked,
+			line, rowInfo);
+	}
+
+	// Parses the header at the start of text and removes it; true if rows can be parsed in chunks
+	bool startBody(string& text, ChunkedTextParser::Layout& layout) {
+		std::istringstream in(text);
+		static_cast<DerivedFormat*>(this)->parseHeader(in);
+		static_cast<DerivedFormat*>(this)->addFixedCovariateColumns();
+
+		const std::streamoff consumed = in.tellg();
+		text.erase(0, consumed < 0 ? text.size() : static_cast<size_t>(consumed));
+
+		return chunkedParsing && static_cast<DerivedFormat*>(this)->getRowLayout(layout);
+	}
+
+	// Parses complete lines [begin, end), the lines numbered from line on
+	void parseText(const char* begin, const char* end, const char* fileName,
+			const ChunkedTextParser::Layout& layout, bool& chunked, size_t& line,
+			RowInformation& rowInfo) {
+
+		if (chunked) {
+			size_t failedLine = 0;
+			const size_t nLines = std::count(begin, end, '\n') + (begin < end && end[-1] != '\n');
+			if (parseChunks(begin, end, layout, rowInfo, failedLine)) {
+				line += nLines;
+				return;
+			}
+			logParseFailure(fileName, line + failedLine);
+			chunked = false;
+		}
+
+		while (begin < end && rowInfo.currentRow < MAX_ENTRIES) {
+			const char* lineEnd = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+			if (lineEnd == nullptr) {
+				lineEnd = end;
+			}
+			if (!isBlankLine(begin, lineEnd)) {
+				stringstream ss(string(begin, lineEnd)); // Tokenize
+				static_cast<DerivedFormat*>(this)->parseRow(ss, rowInfo);
+				rowInfo.currentRow++;
+			}
+			++line;
+			begin = lineEnd + 1;
+		}
+	}
+
+	// Holds no row, like a blank line to ChunkedTextParser; e.g. "\r" in a CRLF file
+	static bool isBlankLine(const char* begin, const char* end) {
+		return std::all_of(begin, end, ChunkedTextParser::isBlank);
+	}
+
+	// Parses [begin, end) in parallel and merges the rows; false leaves modelData untouched
+	bool parseChunks(const char* begin, const char* end, const ChunkedTextParser::Layout& layout,
+			RowInformation& rowInfo, size_t& failedLine) {
+
+		const int threads = (nThreads == -1) ?
+			static_cast<int>(bsccs::thread::hardware_concurrency()) : nThreads;
+
+		std::vector<ChunkedTextParser::Chunk> chunks;
+		if (!ChunkedTextParser(layout).parse(begin, end, threads, chunks, failedLine)) {
+			return false;
+		}
+		for (const auto& chunk : chunks) {
+			mergeChunk(chunk, layout, rowInfo);
+		}
+		return true;
+	}
+
+	void logParseFailure(const char* fileName, size_t failedLine) {
+		std::ostringstream stream;
+		stream << "Unable to parse data line " << (failedLine + 1) << " of " << fileName
+			<< " in parallel; reading line by line";
+		logger->writeLine(stream);
+	}
+
+	// Applies parsed rows in file order, exactly as parseRow() would
+	void mergeChunk(const ChunkedTextParser::Chunk& chunk,
+			const ChunkedTextParser::Layout& layout, RowInformation& rowInfo) {
+		typedef ChunkedTextParser Parser;
+
+		size_t entry = 0;
+		for (size_t r = 0; r < chunk.nRows && rowInfo.currentRow < MAX_ENTRIES; ++r) {
+			for (Parser::FieldType field : layout.fields) {
+				switch (field) {
+					case Parser::CONDITION :
+						addConditionEntry(chunk.conditions[r].str(), rowInfo);
+						break;
+					case Parser::ROW_LABEL :
+						modelData->labels.push_back(chunk.labels[r].str());
+						break;
+					case Parser::STRATUM :
+						addStratumEntry(chunk.strata[r].str(), rowInfo);
+						break;
+					case Parser::STRATUM_NONE :
+						addNoStratumEntry(rowInfo);
+						break;
+					case Parser::TIME :
+						modelData->z.push_back(layout.timeAsFloat ?
+							static_cast<float>(chunk.times[r]) : chunk.times[r]);
+						break;
+					case Parser::OUTCOME :
+						addOutcomeEntry(chunk.outcomes[r], layout.bbrOutcome, rowInfo);
+						break;
+					case Parser::OFFSET :
+						modelData->offs.push_back(chunk.offsets[r]);
+						break;
+					case Parser::OFFSET_COVARIATE :
+						addOffsetCovariateEntry(chunk.offsets[r], rowInfo, layout.offsetInLogSpace);
+						break;
+					case Parser::INTERCEPT :
+						modelData->getColumn(layout.interceptColumn).add_data(rowInfo.currentRow,
+							static_cast<real>(1.0));
+						break;
+				}
+			}
+
+			for (; entry < chunk.rowEnds[r]; ++entry) {
+				if (layout.covariates == Parser::INDICATOR_COVARIATES) {
+					addIndicatorCovariateEntry(chunk.ids[entry], rowInfo);
+				} else {
+					addBBRCovariateEntry(chunk.ids[entry], chunk.values[entry], rowInfo);
+				}
+			}
+			rowInfo.currentRow++;
+		}
+	}
+
+	void parseHeader(std::istream& in) {
 		string line;
 		getline(in, line); // Read header
 	}
@@ -161,35 +427,39 @@ protected:
 				drug = atoi(rowInfo.scratch[0].c_str());
 				value = atof(rowInfo.scratch[1].c_str());
 			}
-			if (!rowInfo.indexer.hasColumn(drug)) {
-				// Add new column
-				rowInfo.indexer.addColumn(drug, INDICATOR);
-				Missing::hook1(); // Handle allocation if necessary
-			}
+			addBBRCovariateEntry(drug, value, rowInfo);
+		}
+	}
 
-			CompressedDataColumn& column = rowInfo.indexer.getColumn(drug);
-			if (value != static_cast<real>(1) && value != static_cast<real>(0)) {
-				if (column.getFormatType() == INDICATOR) {
-					std::ostringstream stream;
-					stream << "Up-casting covariate " << column.getLabel() << " to sparse!";
-					logger->writeLine(stream);
-					column.convertColumnToSparse();
-				}
+	void addBBRCovariateEntry(IdType drug, real value, RowInformation& rowInfo) {
+		if (!rowInfo.indexer.hasColumn(drug)) {
+			// Add new column
+			rowInfo.indexer.addColumn(drug, INDICATOR);
+			Missing::hook1(); // Handle allocation if necessary
+		}
+
+		CompressedDataColumn& column = rowInfo.indexer.getColumn(drug);
+		if (value != static_cast<real>(1) && value != static_cast<real>(0)) {
+			if (column.getFormatType() == INDICATOR) {
+				std::ostringstream stream;
+				stream << "Up-casting covariate " << column.getLabel() << " to sparse!";
+				logger->writeLine(stream);
+				column.convertColumnToSparse();
 			}
+		}
 
-			if (Missing::isMissing(value)) {
-				// Handle missing values
-				Missing::hook2();
-			} else {
-				// Add to storage
-				bool valid = column.add_data(rowInfo.currentRow, value);
-				if (!valid) {
-					std::ostringstream stream;
-					stream << "Warning: repeated sparse entries in data row: "
-							<< (rowInfo.currentRow + 1)
-							<< ", column: " << column.getLabel();
-					logger->writeLine(stream);
-				}
+		if (Missing::isMissing(value)) {
+			// Handle missing values
+			Missing::hook2();
+		} else {
+			// Add to storage
+			bool valid = column.add_data(rowInfo.currentRow, value);
+			if (!valid) {
+				std::ostringstream stream;
+				stream << "Warning: repeated sparse entries in data row: "
+						<< (rowInfo.currentRow + 1)
+						<< ", column: " << column.getLabel();
+				logger->writeLine(stream);
 			}
 		}
 	}		
@@ -207,6 +477,10 @@ protected:
 			RowInformation& rowInfo) {
 		string currentOutcomeId;
 		ss >> currentOutcomeId;
+		addConditionEntry(currentOutcomeId, rowInfo);
+	}
+
+	void addConditionEntry(const string& currentOutcomeId, RowInformation& rowInfo) {
 		if (rowInfo.outcomeId == MISSING_STRING) {
 			rowInfo.outcomeId = currentOutcomeId;
 		} else if (currentOutcomeId != rowInfo.outcomeId) {
@@ -217,6 +491,10 @@ protected:
 	}
 
 	void parseNoStratumEntry(stringstream& ss, RowInformation& rowInfo) {
+		addNoStratumEntry(rowInfo);
+	}
+
+	void addNoStratumEntry(RowInformation& rowInfo) {
 		addEventEntry(1);
 		modelData->pid.push_back(rowInfo.numCases);
 		rowInfo.numCases++;
@@ -231,6 +509,10 @@ protected:
 	void parseStratumEntry(stringstream& ss, RowInformation& rowInfo) {
 		string unmappedPid;
 		ss >> unmappedPid;
+		addStratumEntry(unmappedPid, rowInfo);
+	}
+
+	void addStratumEntry(const string& unmappedPid, RowInformation& rowInfo) {
 		if (unmappedPid != rowInfo.currentPid) { // New patient, ASSUMES these are sorted
 			if (rowInfo.currentPid != MISSING_STRING) { // Skip first switch
 				addEventEntry(rowInfo.numEvents);
@@ -246,8 +528,7 @@ protected:
 	void parseSingleOutcomeEntry(stringstream& ss, RowInformation& rowInfo) {
 		T thisY;
 		ss >> thisY;
-		rowInfo.numEvents += thisY;
-		modelData->y.push_back(thisY);
+		addOutcomeEntry(thisY, false, rowInfo);
 	}
 	
 	template <typename T>
@@ -261,7 +542,12 @@ protected:
 	void parseSingleBBROutcomeEntry(stringstream& ss, RowInformation& rowInfo) {
 		T thisY;
 		ss >> thisY;
-		if (thisY < static_cast<T>(0)) { // BBR uses +1 / -1, BSCCS uses 1 / 0.
+		addOutcomeEntry(thisY, true, rowInfo);
+	}
+
+	template <typename T>
+	void addOutcomeEntry(T thisY, bool bbrOutcome, RowInformation& rowInfo) {
+		if (bbrOutcome && thisY < static_cast<T>(0)) { // BBR uses +1 / -1, BSCCS uses 1 / 0.
 			thisY = static_cast<T>(0);
 		}
 		rowInfo.numEvents += thisY;
@@ -271,6 +557,10 @@ protected:
 	void parseOffsetCovariateEntry(stringstream& ss, RowInformation& rowInfo, bool inLogSpace) {
 		real thisOffset;
 		ss >> thisOffset;
+		addOffsetCovariateEntry(thisOffset, rowInfo, inLogSpace);
+	}
+
+	void addOffsetCovariateEntry(real thisOffset, RowInformation& rowInfo, bool inLogSpace) {
 		if (!inLogSpace) {
 			thisOffset = std::log(thisOffset);
 		}
@@ -286,16 +576,20 @@ protected:
 	void parseAllIndicatorCovariatesEntry(stringstream& ss, RowInformation& rowInfo) {
 		IdType drug;
 		while (ss >> drug) {
-			if (drug == 0) { // No drug
-				// Do nothing
-			} else {
-				if (!rowInfo.indexer.hasColumn(drug)) {
-					// Add new column
-					rowInfo.indexer.addColumn(drug, INDICATOR);
-				}
-				// Add to CSC storage
-				rowInfo.indexer.getColumn(drug).add_data(rowInfo.currentRow, 1.0);
+			addIndicatorCovariateEntry(drug, rowInfo);
+		}
+	}
+
+	void addIndicatorCovariateEntry(IdType drug, RowInformation& rowInfo) {
+		if (drug == 0) { // No drug
+			// Do nothing
+		} else {
+			if (!rowInfo.indexer.hasColumn(drug)) {
+				// Add new column
+				rowInfo.indexer.addColumn(drug, INDICATOR);
 			}
+			// Add to CSC storage
+			rowInfo.indexer.getColumn(drug).add_data(rowInfo.currentRow, 1.0);
 		}
 	}
 	
@@ -315,6 +609,7 @@ protected:
 
 private:
 	string innerDelimitor;
+	bool chunkedParsing;
 };
 
 } // namespace
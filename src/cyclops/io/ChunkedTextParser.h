@@ -0,0 +1,351 @@
+/*
+ * ChunkedTextParser.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: msuchard
+ */
+
+#ifndef CHUNKEDTEXTPARSER_H_
+#define CHUNKEDTEXTPARSER_H_
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+
+#include <boost/iterator/counting_iterator.hpp>
+
+#include "Types.h"
+#include "Thread.h"
+
+namespace bsccs {
+
+/**
+ * Parses whitespace-delimited row files in parallel.  The text (typically a MappedFile) is split
+ * into line-aligned chunks; each thread tokenizes its chunks and converts fields in place into a
+ * per-chunk row-major (COO) buffer, which the caller merges into columns in row order.  Fields are
+ * converted without streams, allocations or locale look-ups; reals are correctly rounded.
+ */
+class ChunkedTextParser {
+public:
+
+	// Fields of a row, in file order; STRATUM_NONE and INTERCEPT consume no text
+	enum FieldType {
+		CONDITION, ROW_LABEL, STRATUM, STRATUM_NONE, TIME, OUTCOME, OFFSET, OFFSET_COVARIATE,
+		INTERCEPT
+	};
+
+	// Trailing covariates: id:value pairs, bare ids with value 1 (BBR indicator_only) or
+	// indicator ids where 0 means none
+	enum CovariateType {
+		BBR_COVARIATES, BBR_INDICATOR_COVARIATES, INDICATOR_COVARIATES
+	};
+
+	struct Layout {
+		std::vector<FieldType> fields;
+		CovariateType covariates;
+		bool bbrOutcome;       // Negative outcomes become 0
+		bool timeAsFloat;      // Times are rounded to float
+		bool offsetInLogSpace; // Else OFFSET_COVARIATE is logged
+		int interceptColumn;
+
+		Layout() : covariates(BBR_COVARIATES), bbrOutcome(false), timeAsFloat(false),
+			offsetInLogSpace(true), interceptColumn(-1) { }
+	};
+
+	// Token within the parsed text
+	struct Field {
+		const char* data;
+		size_t length;
+
+		std::string str() const { return std::string(data, length); }
+	};
+
+	struct Chunk {
+		size_t nRows;
+		size_t nLines;
+		bool valid;
+		size_t failedLine; // Within chunk, if !valid
+
+		std::vector<Field> conditions;
+		std::vector<Field> labels;
+		std::vector<Field> strata;
+		std::vector<real> times;
+		std::vector<int> outcomes;
+		std::vector<real> offsets;
+
+		std::vector<size_t> rowEnds; // Covariates of row r end at rowEnds[r]
+		std::vector<IdType> ids;
+		std::vector<real> values;
+
+		Chunk() : nRows(0), nLines(0), valid(true), failedLine(0) { }
+	};
+
+	ChunkedTextParser(const Layout& layout) : layout(layout) { }
+
+	/**
+	 * Parses [begin, end) with nThreads into chunks, in file order.  Blank lines are skipped.
+	 * Returns false (with the 0-based failing line) if a line is malformed for the layout.
+	 */
+	bool parse(const char* begin, const char* end, int nThreads,
+			std::vector<Chunk>& chunks, size_t& failedLine) const {
+
+		nThreads = std::max(1, nThreads);
+		const std::vector<const char*> bounds = splitLines(begin, end,
+			static_cast<size_t>(nThreads) * ChunksPerThread);
+		const size_t nChunks = bounds.size() - 1;
+		chunks.clear();
+		chunks.resize(nChunks);
+		if (nChunks == 0) {
+			return true;
+		}
+
+		auto scheduler = TaskScheduler<boost::counting_iterator<size_t> >(
+			boost::make_counting_iterator(static_cast<size_t>(0)),
+			boost::make_counting_iterator(nChunks),
+			nThreads);
+
+		scheduler.execute([this, &bounds, &chunks](const size_t c) {
+			parseChunk(bounds[c], bounds[c + 1], chunks[c]);
+		});
+
+		size_t line = 0;
+		for (const auto& chunk : chunks) {
+			if (!chunk.valid) {
+				failedLine = line + chunk.failedLine;
+				return false;
+			}
+			line += chunk.nLines;
+		}
+		return true;
+	}
+
+	// Boundaries of about n chunks of [begin, end), each ending after a newline
+	static std::vector<const char*> splitLines(const char* begin, const char* end, size_t n) {
+		std::vector<const char*> bounds(1, begin);
+		const size_t length = end - begin;
+		for (size_t i = 1; i < n; ++i) {
+			const char* target = std::max(begin + length / n * i, bounds.back());
+			const char* newline = static_cast<const char*>(std::memchr(target, '\n', end - target));
+			if (newline == nullptr) {
+				break;
+			}
+			if (newline + 1 > bounds.back()) {
+				bounds.push_back(newline + 1);
+			}
+		}
+		if (bounds.back() != end) {
+			bounds.push_back(end);
+		}
+		return bounds;
+	}
+
+	static bool isBlank(char c) {
+		return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+	}
+
+	// Next whitespace-delimited token of [position, end)
+	static bool nextToken(const char*& position, const char* end, Field& token) {
+		while (position < end && isBlank(*position)) {
+			++position;
+		}
+		if (position == end) {
+			return false;
+		}
+		token.data = position;
+		while (position < end && !isBlank(*position)) {
+			++position;
+		}
+		token.length = position - token.data;
+		return true;
+	}
+
+	// Whole token must be an optionally signed decimal integer
+	template <typename IntType>
+	static bool parseInteger(const char* begin, const char* end, IntType& value) {
+		bool negative = false;
+		if (begin < end && (*begin == '+' || *begin == '-')) {
+			negative = (*begin == '-');
+			++begin;
+		}
+		if (begin == end || end - begin > MaxIntegerDigits) {
+			return false;
+		}
+		int64_t result = 0;
+		for (; begin < end; ++begin) {
+			const unsigned digit = static_cast<unsigned char>(*begin) - '0';
+			if (digit > 9) {
+				return false;
+			}
+			result = result * 10 + digit;
+		}
+		value = static_cast<IntType>(negative ? -result : result);
+		return static_cast<int64_t>(value) == (negative ? -result : result);
+	}
+
+	// Whole token must be a real number.  Up to 2^53 significant and 10^+-22 scale, the result
+	// is a single correctly rounded operation on exact doubles; otherwise strtod decides.
+	static bool parseReal(const char* begin, const char* end, double& value) {
+		const char* p = begin;
+		bool negative = false;
+		if (p < end && (*p == '+' || *p == '-')) {
+			negative = (*p == '-');
+			++p;
+		}
+		uint64_t mantissa = 0;
+		int scale = 0;
+		int nDigits = 0;
+		bool exact = true;
+		for (; p < end && isDigit(*p); ++p, ++nDigits) {
+			accumulate(mantissa, *p, scale, exact, false);
+		}
+		if (p < end && *p == '.') {
+			for (++p; p < end && isDigit(*p); ++p, ++nDigits) {
+				accumulate(mantissa, *p, scale, exact, true);
+			}
+		}
+		if (nDigits > 0 && p < end && (*p == 'e' || *p == 'E')) {
+			int exponent;
+			if (!parseInteger(p + 1, end, exponent)) {
+				return false;
+			}
+			scale += exponent;
+			p = end;
+		}
+		if (nDigits > 0 && p == end && exact && scale >= -MaxExactScale && scale <= MaxExactScale) {
+			double result = static_cast<double>(mantissa);
+			result = (scale < 0) ? result / powersOfTen(-scale) : result * powersOfTen(scale);
+			value = negative ? -result : result;
+			return true;
+		}
+		return nDigits > 0 && parseRealSlow(begin, end, value); // No "nan", "inf", "NA"
+	}
+
+private:
+
+	static const size_t ChunksPerThread = 4;
+	static const int MaxIntegerDigits = 18;
+	static const int MaxExactScale = 22;
+
+	static bool isDigit(char c) {
+		return c >= '0' && c <= '9';
+	}
+
+	static void accumulate(uint64_t& mantissa, char digit, int& scale, bool& exact, bool fraction) {
+		if (mantissa < (UINT64_C(1) << 53) / 10) {
+			mantissa = mantissa * 10 + (digit - '0');
+			if (fraction) {
+				--scale;
+			}
+		} else if (digit != '0') {
+			exact = false;
+		} else if (!fraction) {
+			++scale; // Trailing integer zero
+		}
+	}
+
+	static double powersOfTen(int n) {
+		static const double powers[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+		return powers[n];
+	}
+
+	static bool parseRealSlow(const char* begin, const char* end, double& value) {
+		char buffer[64];
+		const size_t length = end - begin;
+		if (length == 0 || length >= sizeof(buffer)) {
+			return false;
+		}
+		std::memcpy(buffer, begin, length);
+		buffer[length] = '\0';
+		char* parsed;
+		value = std::strtod(buffer, &parsed);
+		return parsed == buffer + length;
+	}
+
+	void parseChunk(const char* begin, const char* end, Chunk& chunk) const {
+		for (const char* line = begin; line < end; ++chunk.nLines) {
+			const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', end - line));
+			if (lineEnd == nullptr) {
+				lineEnd = end;
+			}
+			if (!parseLine(line, lineEnd, chunk)) {
+				chunk.valid = false;
+				chunk.failedLine = chunk.nLines;
+				return;
+			}
+			line = lineEnd + 1;
+		}
+	}
+
+	bool parseLine(const char* position, const char* end, Chunk& chunk) const {
+		Field token;
+		const char* start = position;
+		if (!nextToken(start, end, token)) {
+			return true; // Blank
+		}
+
+		for (FieldType field : layout.fields) {
+			if (field == STRATUM_NONE || field == INTERCEPT) {
+				continue;
+			}
+			if (!nextToken(position, end, token)) {
+				return false;
+			}
+			switch (field) {
+				case CONDITION : chunk.conditions.push_back(token); break;
+				case ROW_LABEL : chunk.labels.push_back(token); break;
+				case STRATUM : chunk.strata.push_back(token); break;
+				case OUTCOME : {
+					int outcome;
+					if (!parseInteger(token.data, token.data + token.length, outcome)) {
+						return false;
+					}
+					chunk.outcomes.push_back(outcome);
+					break;
+				}
+				default : {
+					double x;
+					if (!parseReal(token.data, token.data + token.length, x)) {
+						return false;
+					}
+					(field == TIME ? chunk.times : chunk.offsets).push_back(static_cast<real>(x));
+				}
+			}
+		}
+
+		while (nextToken(position, end, token)) {
+			const char* tokenEnd = token.data + token.length;
+			IdType id;
+			double x = 1.0;
+			if (layout.covariates == BBR_COVARIATES) {
+				const char* colon = static_cast<const char*>(std::memchr(token.data, ':', token.length));
+				if (colon == nullptr || !parseInteger(token.data, colon, id)) {
+					return false;
+				}
+				const char* valueEnd = static_cast<const char*>(
+					std::memchr(colon + 1, ':', tokenEnd - colon - 1));
+				if (!parseReal(colon + 1, valueEnd ? valueEnd : tokenEnd, x)) {
+					return false;
+				}
+			} else if (!parseInteger(token.data, tokenEnd, id)) {
+				return false;
+			}
+			chunk.ids.push_back(id);
+			chunk.values.push_back(static_cast<real>(x));
+		}
+		chunk.rowEnds.push_back(chunk.ids.size());
+		++chunk.nRows;
+		return true;
+	}
+
+	const Layout layout;
+};
+
+} // namespace
+
+#endif /* CHUNKEDTEXTPARSER_H_ */
@@ -0,0 +1,333 @@
+/*
+ * DecompressionPipe.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: msuchard
+ */
+
+#ifndef DECOMPRESSIONPIPE_H_
+#define DECOMPRESSIONPIPE_H_
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef USE_ZLIB
+	#include <zlib.h>
+#endif
+#ifdef USE_ZSTD
+	#include <zstd.h>
+#endif
+
+#include "Types.h"
+#include "Thread.h"
+
+namespace bsccs {
+
+/**
+ * Decompresses a gzip or zstd file on a separate thread into a ring of fixed-size blocks, so
+ * decompression overlaps whatever the consumer does with the previous blocks and nothing is
+ * written to disk.  Support for each codec is compiled in with USE_ZLIB / USE_ZSTD.
+ */
+class DecompressionPipe {
+public:
+
+	enum Codec {
+		PLAIN, GZIP, ZSTD
+	};
+
+	static const size_t DefaultBlockSize = 16 << 20;
+	static const size_t DefaultNumberOfBlocks = 4;
+
+	// From the leading magic bytes; PLAIN if unreadable
+	static Codec detectCodec(const char* fileName) {
+		unsigned char magic[4] = { 0 };
+		FILE* file = std::fopen(fileName, "rb");
+		if (!file) {
+			return PLAIN;
+		}
+		const size_t n = std::fread(magic, 1, sizeof(magic), file);
+		std::fclose(file);
+		if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+			return GZIP;
+		}
+		if (n == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+			return ZSTD;
+		}
+		return PLAIN;
+	}
+
+	DecompressionPipe(const char* fileName, Codec codec,
+			size_t blockSize = DefaultBlockSize, size_t nBlocks = DefaultNumberOfBlocks) :
+			file(std::fopen(fileName, "rb")), blocks(nBlocks, Block(blockSize)),
+			head(0), handedOut(false), finished(false), stopping(false), worker(nullptr) {
+
+		if (!file) {
+			message = "cannot open file";
+			return;
+		}
+		try {
+			decoder = makeDecoder(codec, file);
+		} catch (std::exception& e) {
+			message = e.what();
+			return;
+		}
+		worker = new thread(run, this);
+	}
+
+	~DecompressionPipe() {
+		if (worker) {
+			{
+				std::lock_guard<mutex> lock(guard);
+				stopping = true;
+			}
+			changed.notify_all();
+			worker->join();
+			delete worker;
+		}
+		if (file) {
+			std::fclose(file);
+		}
+	}
+
+	bool isOpen() const { return worker != nullptr; }
+
+	// Set once next() has returned false because decompression failed
+	bool hasFailed() {
+		std::lock_guard<mutex> lock(guard);
+		return !message.empty();
+	}
+
+	std::string getError() {
+		std::lock_guard<mutex> lock(guard);
+		return message;
+	}
+
+	/**
+	 * Next decompressed block, valid until the following call.  Returns false at the end of
+	 * the input or on failure.
+	 */
+	bool next(const char*& data, size_t& length) {
+		std::lock_guard<mutex> lock(guard);
+		if (handedOut) {
+			blocks[head].full = false;
+			head = (head + 1) % blocks.size();
+			handedOut = false;
+			changed.notify_all();
+		}
+		while (!blocks[head].full && !finished) {
+			changed.wait(guard);
+		}
+		if (!blocks[head].full) {
+			return false;
+		}
+		handedOut = true;
+		data = blocks[head].data.data();
+		length = blocks[head].length;
+		return true;
+	}
+
+private:
+
+	struct Block {
+		std::vector<char> data;
+		size_t length;
+		bool full;
+
+		Block(size_t size) : data(size), length(0), full(false) { }
+	};
+
+	// Fills as much of [out, out + capacity) as possible; 0 only at the end of the input
+	struct Decoder {
+		virtual ~Decoder() { }
+		virtual size_t read(char* out, size_t capacity) = 0;
+	};
+
+	static const size_t InputBufferSize = 1 << 20;
+
+#ifdef USE_ZLIB
+	// Also reads concatenated gzip members, as written by parallel compressors
+	struct GzipDecoder : public Decoder {
+		GzipDecoder(FILE* file) : file(file), input(InputBufferSize), inMember(false) {
+			std::memset(&stream, 0, sizeof(stream));
+			if (inflateInit2(&stream, 15 + 32) != Z_OK) { // Detect gzip or zlib header
+				throw std::runtime_error("cannot initialize zlib");
+			}
+		}
+
+		~GzipDecoder() {
+			inflateEnd(&stream);
+		}
+
+		size_t read(char* out, size_t capacity) {
+			stream.next_out = reinterpret_cast<Bytef*>(out);
+			stream.avail_out = static_cast<uInt>(capacity);
+			while (stream.avail_out > 0) {
+				if (stream.avail_in == 0) {
+					const size_t n = std::fread(input.data(), 1, input.size(), file);
+					if (n == 0) {
+						if (std::ferror(file)) {
+							throw std::runtime_error("read error");
+						}
+						if (inMember) {
+							throw std::runtime_error("unexpected end of compressed data");
+						}
+						break;
+					}
+					stream.next_in = reinterpret_cast<Bytef*>(input.data());
+					stream.avail_in = static_cast<uInt>(n);
+				}
+				inMember = true;
+				const int status = inflate(&stream, Z_NO_FLUSH);
+				if (status == Z_STREAM_END) {
+					inflateReset(&stream);
+					inMember = false;
+				} else if (status != Z_OK && status != Z_BUF_ERROR) {
+					throw std::runtime_error(stream.msg ? stream.msg : "corrupt gzip data");
+				}
+			}
+			return capacity - stream.avail_out;
+		}
+
+		FILE* file;
+		z_stream stream;
+		std::vector<char> input;
+		bool inMember;
+	};
+#endif
+
+#ifdef USE_ZSTD
+	struct ZstdDecoder : public Decoder {
+		ZstdDecoder(FILE* file) : file(file), context(ZSTD_createDStream()),
+				input(InputBufferSize), endOfFile(false), remaining(0) {
+			if (!context || ZSTD_isError(ZSTD_initDStream(context))) {
+				throw std::runtime_error("cannot initialize zstd");
+			}
+			in.src = input.data();
+			in.size = 0;
+			in.pos = 0;
+		}
+
+		~ZstdDecoder() {
+			ZSTD_freeDStream(context);
+		}
+
+		size_t read(char* buffer, size_t capacity) {
+			ZSTD_outBuffer out = { buffer, capacity, 0 };
+			while (out.pos < out.size) {
+				if (in.pos == in.size && !endOfFile) {
+					in.size = std::fread(input.data(), 1, input.size(), file);
+					in.pos = 0;
+					if (in.size == 0) {
+						if (std::ferror(file)) {
+							throw std::runtime_error("read error");
+						}
+						endOfFile = true;
+					}
+				}
+				const size_t before = out.pos;
+				const size_t status = ZSTD_decompressStream(context, &out, &in);
+				if (ZSTD_isError(status)) {
+					throw std::runtime_error(ZSTD_getErrorName(status));
+				}
+				remaining = status;
+				if (endOfFile && in.pos == in.size && out.pos == before) {
+					if (remaining != 0) {
+						throw std::runtime_error("unexpected end of compressed data");
+					}
+					break;
+				}
+			}
+			return out.pos;
+		}
+
+		FILE* file;
+		ZSTD_DStream* context;
+		std::vector<char> input;
+		ZSTD_inBuffer in;
+		bool endOfFile;
+		size_t remaining; // Non-zero inside a frame
+	};
+#endif
+
+	static bsccs::unique_ptr<Decoder> makeDecoder(Codec codec, FILE* file) {
+		switch (codec) {
+#ifdef USE_ZLIB
+			case GZIP :
+				return bsccs::unique_ptr<Decoder>(new GzipDecoder(file));
+#endif
+#ifdef USE_ZSTD
+			case ZSTD :
+				return bsccs::unique_ptr<Decoder>(new ZstdDecoder(file));
+#endif
+			default :
+				throw std::runtime_error(codec == GZIP ? "built without gzip support (USE_ZLIB)" :
+					codec == ZSTD ? "built without zstd support (USE_ZSTD)" : "not compressed");
+		}
+	}
+
+	static void run(void* argument) {
+		static_cast<DecompressionPipe*>(argument)->produce();
+	}
+
+	void produce() {
+		size_t tail = 0;
+		std::string failure;
+		try {
+			while (true) {
+				{
+					std::lock_guard<mutex> lock(guard);
+					while (blocks[tail].full && !stopping) {
+						changed.wait(guard);
+					}
+					if (stopping) {
+						break;
+					}
+				}
+				// Consumer does not touch a block until it is full
+				Block& block = blocks[tail];
+				block.length = decoder->read(block.data.data(), block.data.size());
+				if (block.length == 0) {
+					break;
+				}
+				{
+					std::lock_guard<mutex> lock(guard);
+					block.full = true;
+				}
+				changed.notify_all();
+				tail = (tail + 1) % blocks.size();
+			}
+		} catch (std::exception& e) {
+			failure = e.what();
+		}
+		{
+			std::lock_guard<mutex> lock(guard);
+			message = failure;
+			finished = true;
+		}
+		changed.notify_all();
+	}
+
+	// Disable copy-constructors and copy-assignment
+	DecompressionPipe(const DecompressionPipe&);
+	DecompressionPipe& operator = (const DecompressionPipe&);
+
+	FILE* file;
+	bsccs::unique_ptr<Decoder> decoder;
+	std::vector<Block> blocks;
+	size_t head; // Next block for the consumer
+	bool handedOut;
+	bool finished;
+	bool stopping;
+	std::string message;
+
+	mutex guard;
+	condition_variable changed;
+	thread* worker;
+};
+
+} // namespace
+
+#endif /* DECOMPRESSIONPIPE_H_ */
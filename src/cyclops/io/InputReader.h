@@ -55,6 +55,16 @@ public:
 		return modelData;
 	}
 
+	// Threads for parsing; -1 uses all available cores
+	void setThreads(int threads) {
+		nThreads = threads;
+	}
+
+	// Decompressed block size for gzip and zstd input; 0 uses the default
+	void setCompressedBlockSize(size_t size) {
+		compressedBlockSize = size;
+	}
+
 protected:
 	bool listContains(const vector<IdType>& list, IdType value);
 
@@ -106,6 +116,8 @@ protected:
 
 	ModelData* modelData;
 	bool deleteModelData;
+	int nThreads;
+	size_t compressedBlockSize;
 };
 
 } // namespace
@@ -0,0 +1,120 @@
+/*
+ * MappedFile.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: msuchard
+ */
+
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstddef>
+#include <cstdint>
+
+#include "Types.h"
+
+#if defined(_WIN32)
+	#define CYCLOPS_NO_MMAP
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace bsccs {
+
+/**
+ * Read-only memory mapping of a whole file.  Pages are shared with the page cache (and so with
+ * other processes mapping the same file) and are never modified, so they can always be dropped
+ * and re-read.  Without mmap the file is read into memory instead.
+ */
+class MappedFile {
+public:
+
+	MappedFile(const std::string& fileName) : address(nullptr), length(0) {
+#ifdef CYCLOPS_NO_MMAP
+		std::ifstream in(fileName.c_str(), std::ios::binary | std::ios::ate);
+		if (in) {
+			buffer.resize(static_cast<size_t>(in.tellg()));
+			in.seekg(0);
+			if (in.read(buffer.data(), buffer.size())) {
+				address = buffer.data();
+				length = buffer.size();
+			}
+		}
+#else
+		const int fd = ::open(fileName.c_str(), O_RDONLY);
+		if (fd >= 0) {
+			struct stat info;
+			if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+				void* mapped = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (mapped != MAP_FAILED) {
+					address = static_cast<char*>(mapped);
+					length = info.st_size;
+				}
+			}
+			::close(fd); // Mapping stays valid
+		}
+#endif
+	}
+
+	~MappedFile() {
+#ifndef CYCLOPS_NO_MMAP
+		if (address) {
+			::munmap(address, length);
+		}
+#endif
+	}
+
+	bool isValid() const { return address != nullptr; }
+
+	char* data() const { return address; } // Must not be written when mapped
+
+	size_t size() const { return length; }
+
+	bool isMapped() const {
+#ifdef CYCLOPS_NO_MMAP
+		return false;
+#else
+		return true;
+#endif
+	}
+
+	enum Advice {
+		WILL_NEED, // Start reading ahead
+		PAGE_OUT   // Release; contents are re-read from the file on the next access
+	};
+
+	// Hint for the pages overlapping [begin, begin + length); failures are harmless
+	static void advise(const void* begin, size_t length, Advice advice) {
+#ifndef CYCLOPS_NO_MMAP
+		if (length == 0) {
+			return;
+		}
+		const int flag = (advice == PAGE_OUT) ? MADV_DONTNEED : MADV_WILLNEED; // Pages are clean
+		const uintptr_t pageSize = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+		const uintptr_t first = reinterpret_cast<uintptr_t>(begin) & ~(pageSize - 1);
+		const uintptr_t last = reinterpret_cast<uintptr_t>(begin) + length;
+		::madvise(reinterpret_cast<void*>(first), last - first, flag);
+#endif
+	}
+
+private:
+	// Disable copy-constructors and copy-assignment
+	MappedFile(const MappedFile&);
+	MappedFile& operator = (const MappedFile&);
+
+	char* address;
+	size_t length;
+	std::vector<char> buffer;
+};
+
+typedef bsccs::shared_ptr<MappedFile> MappedFilePtr;
+
+} // namespace
+
+#endif /* MAPPEDFILE_H_ */
@@ -0,0 +1,447 @@
+/*
+ * ModelDataFile.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: msuchard
+ */
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include "io/ModelDataFile.h"
+
+namespace bsccs {
+
+const char ModelDataFile::Magic[8] = { 'C', 'Y', 'C', 'L', 'O', 'P', 'S', 'D' };
+
+namespace {
+
+class SectionWriter {
+public:
+	SectionWriter(std::ofstream& out) : out(out), position(0) { }
+
+	void seek(uint64_t offset) {
+		static const char zeros[64] = { 0 };
+		while (position < offset) {
+			const uint64_t n = std::min<uint64_t>(offset - position, sizeof(zeros));
+			write(zeros, n);
+		}
+	}
+
+	void write(const void* bytes, uint64_t n) {
+		out.write(static_cast<const char*>(bytes), n);
+		position += n;
+	}
+
+private:
+	std::ofstream& out;
+	uint64_t position;
+};
+
+std::string joinStrings(const std::vector<std::string>& strings) {
+	std::string joined;
+	for (const auto& string : strings) {
+		joined += string;
+		joined += '\0';
+	}
+	return joined;
+}
+
+} // namespace
+
+ModelDataFile::ModelDataFile(const std::string& fileName, loggers::ErrorHandlerPtr error) :
+		file(bsccs::make_shared<MappedFile>(fileName)), error(error) {
+
+	std::ostringstream stream;
+	if (!file->isValid()) {
+		stream << "Unable to open " << fileName;
+	} else if (file->size() < sizeof(Header) ||
+			std::memcmp(file->data(), Magic, sizeof(Magic)) != 0) {
+		stream << fileName << " is not a Cyclops data file";
+	} else {
+		std::memcpy(&header, file->data(), sizeof(Header));
+		if (header.byteOrder != ByteOrder) {
+			stream << fileName << " was written on a machine with different byte order";
+		} else if (header.version != Version) {
+			stream << fileName << " has format version " << header.version
+				<< "; expected " << Version;
+		} else if (header.realSize != sizeof(real)) {
+			stream << fileName << " was written with different floating-point precision";
+		} else if (header.fileSize != file->size()) {
+			stream << fileName << " is truncated";
+		} else {
+			const std::string problem = validate();
+			if (!problem.empty()) {
+				stream << fileName << " is corrupt: " << problem;
+			}
+		}
+	}
+	if (!stream.str().empty()) {
+		error->throwError(stream);
+		return;
+	}
+
+	coefficientNames = readStrings(header.coefficientNames, header.nCoefficientNames);
+}
+
+std::string ModelDataFile::validate() const {
+	struct Check {
+		const char* name;
+		const Section& section;
+		uint64_t elementSize;
+	};
+	const Check checks[] = {
+		{ "pid", header.pid, sizeof(int) },
+		{ "y", header.y, sizeof(real) },
+		{ "z", header.z, sizeof(real) },
+		{ "time", header.time, sizeof(real) },
+		{ "row labels", header.rowLabels, 1 },
+		{ "input rows", header.inputRows, sizeof(int) },
+		{ "input strata", header.inputPid, sizeof(int) },
+		{ "row counts", header.rowCounts, sizeof(real) },
+		{ "fixed-term times", header.fixedTermTimes, sizeof(real) },
+		{ "input labels", header.inputLabels, 1 },
+		{ "condition", header.conditionId, 1 },
+		{ "columns", header.columns, sizeof(ColumnRecord) },
+		{ "column names", header.columnNames, 1 },
+		{ "coefficient names", header.coefficientNames, 1 },
+		{ "indices", header.indices, sizeof(int) },
+		{ "values", header.values, sizeof(real) }
+	};
+	for (const auto& check : checks) {
+		if (!contains(check.section, check.elementSize)) {
+			return std::string(check.name) + " section lies outside the file";
+		}
+	}
+
+	// Per-row sections are either absent or hold one entry per row
+	const uint64_t nRows = header.nRows;
+	auto perRow = [nRows](const Section& section) {
+		return section.count == 0 || section.count == nRows;
+	};
+	if (header.y.count != nRows || !perRow(header.pid) || !perRow(header.z) ||
+			!perRow(header.time) || !perRow(header.rowCounts) || !perRow(header.fixedTermTimes)) {
+		return "outcome sections do not match the number of rows";
+	}
+	if (header.inputPid.count != 0 && header.inputPid.count != header.inputRows.count) {
+		return "input strata do not match the input rows";
+	}
+	if (header.columns.count != header.nColumns) {
+		return "column records do not match the number of columns";
+	}
+	// Every string is NUL-terminated, so takes at least one byte
+	if (header.nRowLabels > header.rowLabels.count ||
+			header.nInputLabels > header.inputLabels.count ||
+			header.nCoefficientNames > header.coefficientNames.count) {
+		return "more strings than their section can hold";
+	}
+
+	const int* pid = at<int>(header.pid);
+	for (uint64_t i = 0; i < header.pid.count; ++i) {
+		if (pid[i] < 0 || static_cast<uint64_t>(pid[i]) >= header.nPatients) {
+			return "stratum out of range";
+		}
+	}
+	const int* inputRows = at<int>(header.inputRows);
+	for (uint64_t i = 0; i < header.inputRows.count; ++i) {
+		if (inputRows[i] < 0 || static_cast<uint64_t>(inputRows[i]) >= nRows) {
+			return "input row out of range";
+		}
+	}
+
+	// Each column must hold what its format needs, with strictly increasing rows below nRows
+	const ColumnRecord* records = at<ColumnRecord>(header.columns);
+	const int* indices = at<int>(header.indices);
+	for (uint64_t j = 0; j < header.nColumns; ++j) {
+		const ColumnRecord& record = records[j];
+		if (record.format > INTERCEPT || record.encoding > BITMAP_INDICES ||
+				record.aliasOf >= static_cast<int64_t>(j) ||
+				(record.encoding != PLAIN_INDICES && record.format != INDICATOR)) {
+			return "invalid column record";
+		}
+		if (record.aliasOf >= 0) {
+			continue;
+		}
+		const bool needsIndices = (record.format == SPARSE || record.format == INDICATOR);
+		const bool needsValues = (record.format == SPARSE || record.format == DENSE);
+		if ((record.hasIndices != 0) != needsIndices || (record.hasValues != 0) != needsValues) {
+			return "column storage does not match its format";
+		}
+		if (record.nIndices > header.indices.count ||
+				record.indexStart > header.indices.count - record.nIndices ||
+				record.nValues > header.values.count ||
+				record.valueStart > header.values.count - record.nValues) {
+			return "column storage lies outside its section";
+		}
+		const int* column = indices + record.indexStart;
+		for (uint64_t k = 0; k < record.nIndices; ++k) {
+			if (column[k] < 0 || static_cast<uint64_t>(column[k]) >= nRows ||
+					(k > 0 && column[k] <= column[k - 1])) {
+				return "row index out of range or out of order";
+			}
+		}
+		if (record.format == DENSE && record.nValues != nRows) {
+			return "dense column does not match the number of rows";
+		}
+		if (record.format == SPARSE && record.nValues != record.nIndices) {
+			return "sparse column has mismatched indices and values";
+		}
+	}
+	return std::string();
+}
+
+ModelType ModelDataFile::getModelType() const {
+	return static_cast<ModelType>(header.modelType);
+}
+
+std::vector<std::string> ModelDataFile::readStrings(const Section& section, size_t count) const {
+	std::vector<std::string> strings;
+	strings.reserve(std::min<uint64_t>(count, section.count));
+	const char* begin = at<char>(section);
+	const char* end = begin + section.count;
+	while (begin < end && strings.size() < count) {
+		const size_t length = strnlen(begin, end - begin);
+		strings.push_back(std::string(begin, length));
+		begin += length + 1;
+	}
+	return strings;
+}
+
+void ModelDataFile::read(ModelData& data) const {
+
+	if (data.getNumberOfColumns() > 0 || data.getNumberOfRows() > 0) {
+		std::ostringstream stream;
+		stream << "Can only read a Cyclops data file into an empty data object";
+		data.error->throwError(stream);
+		return;
+	}
+	if (data.getModelType() != getModelType()) {
+		std::ostringstream stream;
+		stream << "Cyclops data file holds a different model type";
+		data.error->throwError(stream);
+		return;
+	}
+
+	// Outcomes are small next to the covariates, so are copied
+	data.pid.assign(at<int>(header.pid), at<int>(header.pid) + header.pid.count);
+	data.y.assign(at<real>(header.y), at<real>(header.y) + header.y.count);
+	data.z.assign(at<real>(header.z), at<real>(header.z) + header.z.count);
+	data.offs.assign(at<real>(header.time), at<real>(header.time) + header.time.count);
+	data.labels = readStrings(header.rowLabels, header.nRowLabels);
+	data.inputRows.assign(at<int>(header.inputRows), at<int>(header.inputRows) + header.inputRows.count);
+	data.inputPid.assign(at<int>(header.inputPid), at<int>(header.inputPid) + header.inputPid.count);
+	data.rowCounts.assign(at<real>(header.rowCounts), at<real>(header.rowCounts) + header.rowCounts.count);
+	data.fixedTermTimes.assign(at<real>(header.fixedTermTimes),
+		at<real>(header.fixedTermTimes) + header.fixedTermTimes.count);
+	data.inputLabels = readStrings(header.inputLabels, header.nInputLabels);
+	data.conditionId = std::string(at<char>(header.conditionId), header.conditionId.count);
+
+	data.nRows = header.nRows;
+	data.nPatients = header.nPatients;
+	data.nTypes = header.nTypes;
+	data.hasOffsetCovariate = (header.flags & HAS_OFFSET) != 0;
+	data.hasInterceptCovariate = (header.flags & HAS_INTERCEPT) != 0;
+
+	if (data.getHasInputRowLabels()) {
+		const std::vector<int>& rows = data.inputRows;
+		for (size_t i = 0; i < data.getNumberOfInputRows(); ++i) {
+			char* end;
+			const IdType rowId = std::strtoll(data.getInputRowLabel(i).c_str(), &end, 10);
+			if (*end == '\0') {
+				data.rowIdIndex.push_back(rowId, rows.empty() ? i : rows[i]);
+			}
+		}
+	}
+
+	// Columns become views into the mapping
+	auto arena = bsccs::make_shared<ColumnArena>();
+	arena->backing = file;
+	int* indices = reinterpret_cast<int*>(file->data() + header.indices.offset);
+	real* values = reinterpret_cast<real*>(file->data() + header.values.offset);
+
+	const ColumnRecord* records = at<ColumnRecord>(header.columns);
+	const std::vector<std::string> names = readStrings(header.columnNames, header.nColumns);
+
+	for (size_t j = 0; j < header.nColumns; ++j) {
+		const ColumnRecord& record = records[j];
+		data.push_back(IntVectorPtr(), RealVectorPtr(), static_cast<FormatType>(record.format));
+		CompressedDataColumn& column = data.getColumn(j);
+		column.add_label(static_cast<IdType>(record.label));
+		if (j < names.size()) {
+			column.add_label(names[j]);
+		}
+
+		if (record.aliasOf >= 0) {
+			column.shareStorage(data.getColumn(record.aliasOf));
+		} else {
+			column.attach(arena,
+				record.hasIndices ? indices + record.indexStart : nullptr, record.nIndices,
+				record.hasValues ? values + record.valueStart : nullptr, record.nValues);
+			if (record.encoding != PLAIN_INDICES) {
+				column.encodeIndices(static_cast<IndexEncoding>(record.encoding));
+			}
+		}
+	}
+
+	data.touchedX = true;
+	data.touchedY = true;
+	data.setIsFinalized(true);
+}
+
+void ModelDataFile::write(const ModelData& data, const std::string& fileName,
+		const std::vector<std::string>& coefficientNames) {
+
+	if (!data.getIsFinalized()) {
+		std::ostringstream stream;
+		stream << "Only finalized data can be saved";
+		data.error->throwError(stream);
+		return;
+	}
+
+	const size_t nColumns = data.getNumberOfColumns();
+	const std::vector<int> aliases = data.findStorageAliases();
+
+	std::vector<ColumnRecord> records(nColumns);
+	std::vector<std::string> names(nColumns);
+	uint64_t nIndices = 0;
+	uint64_t nValues = 0;
+
+	for (size_t j = 0; j < nColumns; ++j) {
+		const CompressedDataColumn& column = data.getColumn(j);
+		const FormatType format = column.getFormatType();
+		ColumnRecord& record = records[j];
+		std::memset(&record, 0, sizeof(ColumnRecord));
+
+		record.label = column.getNumericalLabel();
+		record.format = format;
+		record.encoding = column.getIndexEncoding();
+		record.aliasOf = (aliases[j] != static_cast<int>(j)) ? aliases[j] : -1;
+		names[j] = column.getLabel();
+
+		if (record.aliasOf < 0) {
+			record.hasIndices = (format == SPARSE || format == INDICATOR);
+			record.hasValues = (format == SPARSE || format == DENSE);
+			record.indexStart = nIndices;
+			record.nIndices = record.hasIndices ? column.getNumberOfEntries() : 0;
+			record.valueStart = nValues;
+			record.nValues = record.hasValues ? column.getDataVectorLength() : 0;
+			nIndices += record.nIndices;
+			nValues += record.nValues;
+		}
+	}
+
+	const std::string rowLabels = joinStrings(data.labels);
+	const std::string inputLabels = joinStrings(data.inputLabels);
+	const std::string columnNames = joinStrings(names);
+	const std::string coefficients = joinStrings(coefficientNames);
+
+	Header header;
+	std::memset(&header, 0, sizeof(Header));
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.byteOrder = ByteOrder;
+	header.realSize = sizeof(real);
+	header.modelType = static_cast<uint64_t>(data.getModelType());
+	header.flags = (data.getHasOffsetCovariate() ? HAS_OFFSET : 0) |
+		(data.getHasInterceptCovariate() ? HAS_INTERCEPT : 0);
+	header.nRows = data.getNumberOfRows();
+	header.nColumns = nColumns;
+	header.nPatients = data.getNumberOfPatients();
+	header.nTypes = data.nTypes;
+	header.nRowLabels = data.labels.size();
+	header.nInputLabels = data.inputLabels.size();
+	header.nCoefficientNames = coefficientNames.size();
+
+	// Lay out sections in order, each 64-byte aligned
+	uint64_t offset = sizeof(Header);
+	auto place = [&offset](Section& section, uint64_t count, uint64_t size) {
+		offset = align(offset);
+		section.offset = offset;
+		section.count = count;
+		offset += count * size;
+	};
+	place(header.pid, data.pid.size(), sizeof(int));
+	place(header.y, data.y.size(), sizeof(real));
+	place(header.z, data.z.size(), sizeof(real));
+	place(header.time, data.offs.size(), sizeof(real));
+	place(header.rowLabels, rowLabels.size(), 1);
+	place(header.inputRows, data.inputRows.size(), sizeof(int));
+	place(header.inputPid, data.inputPid.size(), sizeof(int));
+	place(header.rowCounts, data.rowCounts.size(), sizeof(real));
+	place(header.fixedTermTimes, data.fixedTermTimes.size(), sizeof(real));
+	place(header.inputLabels, inputLabels.size(), 1);
+	place(header.conditionId, data.conditionId.size(), 1);
+	place(header.columns, nColumns, sizeof(ColumnRecord));
+	place(header.columnNames, columnNames.size(), 1);
+	place(header.coefficientNames, coefficients.size(), 1);
+	place(header.indices, nIndices, sizeof(int));
+	place(header.values, nValues, sizeof(real));
+	header.fileSize = offset;
+
+	std::ofstream out(fileName.c_str(), std::ios::binary | std::ios::trunc);
+	if (!out) {
+		std::ostringstream stream;
+		stream << "Unable to open " << fileName << " for writing";
+		data.error->throwError(stream);
+		return;
+	}
+
+	SectionWriter writer(out);
+	writer.write(&header, sizeof(Header));
+	auto put = [&writer](const Section& section, const void* bytes, uint64_t size) {
+		writer.seek(section.offset);
+		writer.write(bytes, section.count * size);
+	};
+	put(header.pid, data.pid.data(), sizeof(int));
+	put(header.y, data.y.data(), sizeof(real));
+	put(header.z, data.z.data(), sizeof(real));
+	put(header.time, data.offs.data(), sizeof(real));
+	put(header.rowLabels, rowLabels.data(), 1);
+	put(header.inputRows, data.inputRows.data(), sizeof(int));
+	put(header.inputPid, data.inputPid.data(), sizeof(int));
+	put(header.rowCounts, data.rowCounts.data(), sizeof(real));
+	put(header.fixedTermTimes, data.fixedTermTimes.data(), sizeof(real));
+	put(header.inputLabels, inputLabels.data(), 1);
+	put(header.conditionId, data.conditionId.data(), 1);
+	put(header.columns, records.data(), sizeof(ColumnRecord));
+	put(header.columnNames, columnNames.data(), 1);
+	put(header.coefficientNames, coefficients.data(), 1);
+
+	writer.seek(header.indices.offset);
+	for (size_t j = 0; j < nColumns; ++j) {
+		const CompressedDataColumn& column = data.getColumn(j);
+		if (records[j].aliasOf < 0 && records[j].hasIndices) {
+			if (column.getIndexEncoding() != PLAIN_INDICES) { // Written decoded, one block at a time
+				std::vector<int> block(EncodedColumn::MaxBlockSize);
+				for (size_t b = 0; b < column.getNumberOfIndexBlocks(); ++b) {
+					const size_t n = column.decodeIndexBlock(b, block.data());
+					writer.write(block.data(), n * sizeof(int));
+				}
+			} else {
+				const IntView view = column.getColumnsView();
+				writer.write(view.data(), view.size() * sizeof(int));
+			}
+		}
+	}
+
+	writer.seek(header.values.offset);
+	for (size_t j = 0; j < nColumns; ++j) {
+		if (records[j].aliasOf < 0 && records[j].hasValues) {
+			const RealView view = data.getColumn(j).getDataView();
+			writer.write(view.data(), view.size() * sizeof(real));
+		}
+	}
+	writer.seek(header.fileSize);
+
+	out.close();
+	if (!out) {
+		std::ostringstream stream;
+		stream << "Error writing " << fileName;
+		data.error->throwError(stream);
+	}
+}
+
+} // namespace
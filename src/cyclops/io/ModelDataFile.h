@@ -0,0 +1,142 @@
+/*
+ * ModelDataFile.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: msuchard
+ */
+
+#ifndef MODELDATAFILE_H_
+#define MODELDATAFILE_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "ModelData.h"
+#include "io/MappedFile.h"
+#include "io/ProgressLogger.h"
+
+namespace bsccs {
+
+/**
+ * Versioned binary container for a finalized ModelData.  The file holds a fixed header, the
+ * outcome vectors (pid, y, z, time), row labels, the caller's rows (see ModelData::sortRows and
+ * ModelData::compressRows) with their strata, counts and labels, one record
+ * per column (format, index encoding, labels, alias) and two 64-byte aligned sections with all
+ * column indices and values, in the layout of a packed ColumnArena.  Reading maps the file and points the columns straight into
+ * the mapping, so loading costs no copies of column data and processes that open the same file
+ * share its pages.
+ */
+class ModelDataFile {
+public:
+
+	static const uint64_t Version = 4;
+
+	// Maps and validates fileName
+	ModelDataFile(const std::string& fileName, loggers::ErrorHandlerPtr error);
+
+	ModelType getModelType() const;
+
+	const std::vector<std::string>& getCoefficientNames() const {
+		return coefficientNames;
+	}
+
+	// Fills an empty ModelData, which becomes finalized
+	void read(ModelData& data) const;
+
+	// Writes a finalized ModelData; coefficientNames are stored alongside for the caller
+	static void write(const ModelData& data, const std::string& fileName,
+			const std::vector<std::string>& coefficientNames = std::vector<std::string>());
+
+private:
+
+	struct Section {
+		uint64_t offset;
+		uint64_t count; // Elements, or bytes for strings
+	};
+
+	struct Header {
+		char magic[8];
+		uint64_t version;
+		uint64_t byteOrder;
+		uint64_t realSize;
+		uint64_t modelType;
+		uint64_t flags;
+		uint64_t nRows;
+		uint64_t nColumns;
+		uint64_t nPatients;
+		uint64_t nTypes;
+		uint64_t nRowLabels;
+		uint64_t nInputLabels;
+		uint64_t nCoefficientNames;
+		Section pid;
+		Section y;
+		Section z;
+		Section time;
+		Section rowLabels;
+		Section inputRows;
+		Section inputPid;
+		Section rowCounts;
+		Section fixedTermTimes;
+		Section inputLabels;
+		Section conditionId;
+		Section columns;
+		Section columnNames;
+		Section coefficientNames;
+		Section indices;
+		Section values;
+		uint64_t fileSize;
+	};
+
+	struct ColumnRecord {
+		int64_t label;
+		uint64_t format;
+		uint64_t encoding;
+		int64_t aliasOf; // Earlier column whose storage is shared, or -1
+		uint64_t indexStart;
+		uint64_t nIndices;
+		uint64_t valueStart;
+		uint64_t nValues;
+		uint64_t hasIndices;
+		uint64_t hasValues;
+	};
+
+	enum Flags {
+		HAS_OFFSET = 1,
+		HAS_INTERCEPT = 2
+	};
+
+	static const char Magic[8];
+	static const uint64_t ByteOrder = 0x0102030405060708ULL;
+	static const uint64_t Alignment = 64;
+
+	static uint64_t align(uint64_t offset) {
+		return (offset + Alignment - 1) / Alignment * Alignment;
+	}
+
+	// Whether section is aligned and lies inside the file; safe against overflowing counts
+	bool contains(const Section& section, uint64_t elementSize) const {
+		const uint64_t size = file->size();
+		return section.offset % Alignment == 0 && section.offset <= size &&
+			section.count <= (size - section.offset) / elementSize;
+	}
+
+	// Checks section counts and row indices against the header; returns an empty string if valid
+	std::string validate() const;
+
+	template <typename T>
+	const T* at(const Section& section) const {
+		return reinterpret_cast<const T*>(file->data() + section.offset);
+	}
+
+	std::vector<std::string> readStrings(const Section& section, size_t count) const;
+
+	MappedFilePtr file;
+	loggers::ErrorHandlerPtr error;
+	Header header;
+	std::vector<std::string> coefficientNames;
+};
+
+} // namespace
+
+#endif /* MODELDATAFILE_H_ */
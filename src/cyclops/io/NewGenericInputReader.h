@@ -122,7 +122,32 @@ public:
 		parseAllBBRCovariatesEntry(ss, rowInfo, indicatorOnly);
 	}
 
-	void parseHeader(ifstream& in) {
+	bool getRowLayout(ChunkedTextParser::Layout& layout) {
+		typedef ChunkedTextParser Parser;
+		if (includeRowLabel) {
+			layout.fields.push_back(Parser::ROW_LABEL);
+		}
+		layout.fields.push_back(includeStratumLabel ? Parser::STRATUM : Parser::STRATUM_NONE);
+		if (includeCensoredData) {
+			layout.fields.push_back(Parser::TIME);
+		}
+		layout.fields.push_back(Parser::OUTCOME);
+		if (includeSCCSOffset) {
+			layout.fields.push_back(Parser::OFFSET);
+		} else if (includeOffset) {
+			layout.fields.push_back(Parser::OFFSET_COVARIATE);
+			layout.offsetInLogSpace = offsetInLogSpace;
+		}
+		if (includeIntercept) {
+			layout.fields.push_back(Parser::INTERCEPT);
+			layout.interceptColumn = columnIntercept;
+		}
+		layout.covariates = indicatorOnly ? Parser::BBR_INDICATOR_COVARIATES : Parser::BBR_COVARIATES;
+		layout.bbrOutcome = useBBROutcome;
+		return true;
+	}
+
+	void parseHeader(std::istream& in) {
 		int firstChar = in.peek();
 		if (firstChar == '#') { // There is a header
 			string line;
@@ -8,8 +8,6 @@
 #ifndef SPARSEINDEXER_H_
 #define SPARSEINDEXER_H_
 
-#include <map>
-
 //#include "../CompressedDataMatrix.h"
 class CompressedDataMatrix; // forward reference
 class CompressedDataColumn; // forward reference
@@ -22,14 +20,13 @@ public:
 	virtual ~SparseIndexer() {}
 	
 
+	// Lookups use the id index maintained by CompressedDataMatrix
 	CompressedDataColumn& getColumn(const IdType& covariate) {
-		return dataMatrix.getColumn(sparseMap[covariate]);
+		return dataMatrix.getColumn(getIndex(covariate));
 	}
 	
 	void addColumn(const IdType& covariate, FormatType type) {
 		const int index = dataMatrix.getNumberOfColumns();
-		sparseMap.insert(std::make_pair(covariate, index));
-		
 		dataMatrix.push_back(type);
 		
 		// Add numerical labels
@@ -37,17 +34,16 @@ public:
 	}
 	
 	bool hasColumn(IdType covariate) const {
-		return sparseMap.count(covariate) != 0;
+		return dataMatrix.getColumnIndexByName(covariate) >= 0;
 	}	
 
 	int getIndex(IdType covariate){
-		return sparseMap[covariate];
+		return dataMatrix.getColumnIndexByName(covariate);
 	}
 		
 private:
 	CompressedDataMatrix& dataMatrix;
 //	int nCovariates;
-	std::map<IdType, int> sparseMap;	
 };
 
 } // namespace
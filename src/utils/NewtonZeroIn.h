@@ -0,0 +1,132 @@
+/*
+ * NewtonZeroIn.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: msuchard
+ */
+
+#ifndef NEWTONZEROIN_H_
+#define NEWTONZEROIN_H_
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace bsccs {
+
+/**
+ * Safeguarded Newton root-finder for a function that is positive at x0 and decreases to a
+ * sign change in a given direction.  Obj must provide
+ *   double objective(double x);
+ *   bool getDerivative(double& derivative); // at last evaluated point, false if unavailable
+ * Newton steps are used while they stay inside the current bracket; otherwise falls back to
+ * the secant (regula falsi) step between bracketing points, or to expansion while no sign
+ * change has been found.  A root is only accepted once |objective| < tol or a sign change
+ * has been bracketed to within tol; small unbracketed steps are never taken as convergence.
+ */
+template <typename Obj>
+class NewtonZeroIn {
+public:
+
+	NewtonZeroIn(Obj& _obj, double _tol = 1E-3, int _maxIt = 100, int _maxExpansions = 20,
+		double _min_displacement = 0.01) :
+		obj(_obj), tol(_tol), maxIt(_maxIt), maxExpansions(_maxExpansions),
+		min_displacement(_min_displacement) {
+		// Do nothing
+	}
+
+	virtual ~NewtonZeroIn() {
+		// Do nothing
+	}
+
+	// Assumes that objective() > 0 at x0; 'step' is the initial guess for the distance to the root
+	double getRoot(double x0, double obj0, double direction, double step) {
+
+		const double nan = std::numeric_limits<double>::quiet_NaN();
+
+		if (!(step > 0.0) || std::isinf(step)) {
+			step = 0.1 * std::max(std::abs(x0), min_displacement);
+		}
+
+		double inside = x0;
+		double fInside = obj0;
+		double outside = nan;
+		double fOutside = nan;
+		bool bracketed = false;
+		int expansions = 0;
+		int lastSide = 0; // Consecutive secant steps on same side trigger bisection
+
+		double x = x0 + direction * step;
+
+		for (int it = 0; it < maxIt; ++it) {
+
+			const double fx = obj.objective(x);
+			if (std::isnan(fx)) {
+				return nan;
+			}
+			if (std::abs(fx) < tol) {
+				return x;
+			}
+
+			int side;
+			if (fx > 0.0) {
+				inside = x;
+				fInside = fx;
+				side = 1;
+			} else {
+				outside = x;
+				fOutside = fx;
+				bracketed = true;
+				side = -1;
+			}
+
+			double derivative;
+			double proposal = nan;
+			if (obj.getDerivative(derivative) && derivative != 0.0) {
+				proposal = x - fx / derivative;
+			}
+
+			if (bracketed) {
+				const double lo = std::min(inside, outside);
+				const double hi = std::max(inside, outside);
+				if (!(proposal > lo && proposal < hi)) {
+					proposal = (lastSide == side) ?
+						0.5 * (inside + outside) : // Bisection
+						inside - fInside * (outside - inside) / (fOutside - fInside);
+				}
+				lastSide = side;
+				if (hi - lo < tol) {
+					return proposal;
+				}
+			} else {
+				if (!(direction * (proposal - inside) > 0.0)) { // Newton is not helping
+					proposal = nan;
+				}
+				const double maxStep = 2.0 * std::max(std::abs(inside - x0), step);
+				if (std::isnan(proposal) || std::abs(proposal - inside) > maxStep) {
+					if (++expansions > maxExpansions) {
+						return nan;
+					}
+					proposal = inside + direction * maxStep;
+				} else if (std::abs(proposal - inside) < tol) {
+					proposal = inside + direction * tol; // Step far enough to bracket the root
+				}
+			}
+			x = proposal;
+		}
+		return nan;
+	}
+
+	double getTolerance() { return tol; }
+
+private:
+	Obj& obj;
+	double tol;
+	int maxIt;
+	int maxExpansions;
+	double min_displacement;
+};
+
+} // namespace
+
+#endif /* NEWTONZEROIN_H_ */
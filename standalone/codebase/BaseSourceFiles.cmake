@@ -0,0 +1,33 @@
+# Sources shared by the standalone CCD and CCD-DP targets; expects
+# RCCD_SOURCE_DIR and CCD_SOURCE_DIR to be set by the including file.
+
+set(BASE_SOURCE_FILES	
+    ${RCCD_SOURCE_DIR}/cyclops/CcdInterface.cpp	
+	${RCCD_SOURCE_DIR}/cyclops/CyclicCoordinateDescent.cpp	
+	${RCCD_SOURCE_DIR}/cyclops/CompressedDataMatrix.cpp
+	${RCCD_SOURCE_DIR}/cyclops/ModelData.cpp
+	${RCCD_SOURCE_DIR}/cyclops/io/AppendSession.cpp
+	${RCCD_SOURCE_DIR}/cyclops/io/InputReader.cpp
+	${RCCD_SOURCE_DIR}/cyclops/io/ModelDataFile.cpp
+	 ${CCD_SOURCE_DIR}/CCD/io/HierarchyReader.cpp
+	 ${CCD_SOURCE_DIR}/CCD/io/SCCSInputReader.cpp
+	 ${CCD_SOURCE_DIR}/CCD/io/CLRInputReader.cpp
+	 ${CCD_SOURCE_DIR}/CCD/io/RTestInputReader.cpp
+	 ${CCD_SOURCE_DIR}/CCD/io/CoxInputReader.cpp
+	 ${CCD_SOURCE_DIR}/CCD/io/CCTestInputReader.cpp
+	 ${CCD_SOURCE_DIR}/CCD/CmdLineCcdInterface.cpp
+	${RCCD_SOURCE_DIR}/cyclops/engine/AbstractModelSpecifics.cpp
+	${RCCD_SOURCE_DIR}/cyclops/drivers/AbstractDriver.cpp
+	${RCCD_SOURCE_DIR}/cyclops/drivers/AbstractSelector.cpp
+	${RCCD_SOURCE_DIR}/cyclops/drivers/AbstractCrossValidationDriver.cpp
+	${RCCD_SOURCE_DIR}/cyclops/drivers/ProportionSelector.cpp
+	${RCCD_SOURCE_DIR}/cyclops/drivers/CrossValidationSelector.cpp
+    ${RCCD_SOURCE_DIR}/cyclops/drivers/GridSearchCrossValidationDriver.cpp
+    ${RCCD_SOURCE_DIR}/cyclops/drivers/HierarchyGridSearchCrossValidationDriver.cpp
+	${RCCD_SOURCE_DIR}/cyclops/drivers/AutoSearchCrossValidationDriver.cpp
+	${RCCD_SOURCE_DIR}/cyclops/drivers/HierarchyAutoSearchCrossValidationDriver.cpp
+	${RCCD_SOURCE_DIR}/cyclops/drivers/BootstrapSelector.cpp
+	${RCCD_SOURCE_DIR}/cyclops/drivers/BootstrapDriver.cpp
+	${RCCD_SOURCE_DIR}/utils/HParSearch.cpp
+	${RCCD_SOURCE_DIR}/tinythread/tinythread.cpp
+	)
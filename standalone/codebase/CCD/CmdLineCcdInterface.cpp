@@ -382,6 +382,7 @@ void CmdLineCcdInterface::initializeModelImpl(
 		exit(-1);
 	}
 
+	reader->setThreads(arguments.threads);
 	reader->readFile(arguments.inFileName.c_str()); // TODO Check for error
 	// delete reader;
 	*modelData = reader->getModelData();
@@ -27,7 +27,13 @@ public:
 		parseAllBBRCovariatesEntry(ss, rowInfo,false);
 	}
 
-	void parseHeader(ifstream& in) {
+	bool getRowLayout(ChunkedTextParser::Layout& layout) {
+		layout.fields = { ChunkedTextParser::OUTCOME, ChunkedTextParser::STRATUM };
+		layout.bbrOutcome = true;
+		return true;
+	}
+
+	void parseHeader(std::istream& in) {
 		// Do nothing
 	}
 	
@@ -29,8 +29,15 @@ public:
 		parseSingleOutcomeEntry<int>(ss, rowInfo);	
 		parseAllBBRCovariatesEntry(ss, rowInfo, false);
 	}
+
+	bool getRowLayout(ChunkedTextParser::Layout& layout) {
+		layout.fields = { ChunkedTextParser::STRATUM_NONE, ChunkedTextParser::TIME,
+			ChunkedTextParser::OUTCOME };
+		layout.timeAsFloat = true;
+		return true;
+	}
 	
-	void parseHeader(ifstream& in) {
+	void parseHeader(std::istream& in) {
 		// Do nothing
 	}
 
@@ -22,6 +22,13 @@ public:
 		parseAllIndicatorCovariatesEntry(ss, rowInfo);
 	}
 
+	bool getRowLayout(ChunkedTextParser::Layout& layout) {
+		layout.fields = { ChunkedTextParser::CONDITION, ChunkedTextParser::STRATUM,
+			ChunkedTextParser::OUTCOME, ChunkedTextParser::OFFSET };
+		layout.covariates = ChunkedTextParser::INDICATOR_COVARIATES;
+		return true;
+	}
+
 protected:
 
 };
@@ -0,0 +1,19 @@
+# Optional compressed input (io/DecompressionPipe.h); sets COMPRESSION_LIBRARIES for the
+# library target of the including file.
+
+set(COMPRESSION_LIBRARIES)
+
+find_package(ZLIB)
+if(ZLIB_FOUND)
+	add_definitions(-DUSE_ZLIB)
+	include_directories(${ZLIB_INCLUDE_DIRS})
+	list(APPEND COMPRESSION_LIBRARIES ${ZLIB_LIBRARIES})
+endif(ZLIB_FOUND)
+
+find_path(ZSTD_INCLUDE_DIR zstd.h)
+find_library(ZSTD_LIBRARY zstd)
+if(ZSTD_INCLUDE_DIR AND ZSTD_LIBRARY)
+	add_definitions(-DUSE_ZSTD)
+	include_directories(${ZSTD_INCLUDE_DIR})
+	list(APPEND COMPRESSION_LIBRARIES ${ZSTD_LIBRARY})
+endif(ZSTD_INCLUDE_DIR AND ZSTD_LIBRARY)